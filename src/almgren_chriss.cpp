@@ -0,0 +1,254 @@
+#include "almgren_chriss.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+
+// sinh(a) / sinh(b) for 0 <= a <= b, without overflow for large b
+double sinh_ratio(double a, double b) {
+    return (std::exp(a - b) - std::exp(-a - b)) / (1.0 - std::exp(-2.0 * b));
+}
+
+} // namespace
+
+AlmgrenChrissSchedule solve_almgren_chriss(const AlmgrenChrissParams& params) {
+    if (params.slices <= 0 || !(params.horizon > 0.0)) {
+        throw std::invalid_argument("Almgren-Chriss: horizon and slices must be positive");
+    }
+    if (params.risk_aversion < 0.0 || params.volatility < 0.0) {
+        throw std::invalid_argument("Almgren-Chriss: risk aversion and volatility must be non-negative");
+    }
+
+    const int n = params.slices;
+    const double tau = params.horizon / n;
+    const double eta_tilde = params.eta - 0.5 * params.gamma * tau;
+    if (!(eta_tilde > 0.0)) {
+        throw std::invalid_argument("Almgren-Chriss: eta - gamma*tau/2 must be positive");
+    }
+
+    AlmgrenChrissSchedule schedule;
+    const double kappa_tilde_sq = params.risk_aversion * params.volatility * params.volatility / eta_tilde;
+    schedule.kappa = kappa_tilde_sq > 0.0 ? std::acosh(1.0 + 0.5 * kappa_tilde_sq * tau * tau) / tau : 0.0;
+
+    const double X = params.quantity;
+    const double kT = schedule.kappa * params.horizon;
+    schedule.holdings.resize(n + 1);
+    schedule.trades.resize(n);
+    for (int j = 0; j <= n; ++j) {
+        const double remaining = static_cast<double>(n - j) / n;   // (T - t_j) / T
+        // Below ~1e-8 the sinh ratio loses precision and equals the TWAP line anyway
+        schedule.holdings[j] = kT < 1e-8 ? X * remaining : X * sinh_ratio(kT * remaining, kT);
+    }
+    schedule.holdings[n] = 0.0;
+
+    double sum_abs_trades = 0.0, sum_sq_trades = 0.0, sum_sq_holdings = 0.0;
+    for (int j = 0; j < n; ++j) {
+        const double trade = schedule.holdings[j] - schedule.holdings[j + 1];
+        schedule.trades[j] = trade;
+        sum_abs_trades += std::abs(trade);
+        sum_sq_trades += trade * trade;
+        sum_sq_holdings += schedule.holdings[j + 1] * schedule.holdings[j + 1];
+    }
+
+    schedule.expected_cost = 0.5 * params.gamma * X * X + params.epsilon * sum_abs_trades
+                           + eta_tilde / tau * sum_sq_trades;
+    schedule.variance = params.volatility * params.volatility * tau * sum_sq_holdings;
+    return schedule;
+}
+
+std::vector<FrontierPoint> efficient_frontier(const AlmgrenChrissParams& params,
+                                              const double* risk_aversions, size_t count) {
+    std::vector<FrontierPoint> frontier;
+    frontier.reserve(count);
+    AlmgrenChrissParams point = params;
+    for (size_t i = 0; i < count; ++i) {
+        point.risk_aversion = risk_aversions[i];
+        const AlmgrenChrissSchedule schedule = solve_almgren_chriss(point);
+        frontier.push_back(FrontierPoint{risk_aversions[i], schedule.expected_cost, schedule.variance});
+    }
+    return frontier;
+}
+
+template <typename Value>
+AlmgrenChrissCache::Table<Value>::Table(size_t capacity) {
+    size_t sets = 1;
+    while (sets * kWays < capacity) {
+        sets <<= 1;
+    }
+    slots = std::vector<Slot<Value>>(sets * kWays);
+    victims.reset(new std::atomic<uint32_t>[sets]);
+    for (size_t i = 0; i < sets; ++i) {
+        victims[i].store(0, std::memory_order_relaxed);
+    }
+    set_mask = sets - 1;
+}
+
+AlmgrenChrissCache::AlmgrenChrissCache(size_t capacity, size_t trajectory_capacity)
+    : costs_(capacity), trajectories_(trajectory_capacity), hits_(0), misses_(0) {}
+
+bool AlmgrenChrissCache::Key::operator==(const Key& other) const {
+    return volatility == other.volatility && horizon == other.horizon && risk_aversion == other.risk_aversion
+        && gamma == other.gamma && eta == other.eta && slices == other.slices;
+}
+
+AlmgrenChrissCache::Key AlmgrenChrissCache::make_key(const AlmgrenChrissParams& params) {
+    return Key{quantize(params.volatility), quantize(params.horizon), quantize(params.risk_aversion),
+               quantize(params.gamma), quantize(params.eta), params.slices};
+}
+
+size_t AlmgrenChrissCache::hash(const Key& key) {
+    uint64_t h = 1469598103934665603ull;
+    for (int64_t v : {key.volatility, key.horizon, key.risk_aversion, key.gamma, key.eta,
+                      static_cast<int64_t>(key.slices)}) {
+        h = (h ^ static_cast<uint64_t>(v)) * 1099511628211ull;
+    }
+    return static_cast<size_t>(h ^ (h >> 32));
+}
+
+// 0.1% relative bins on a log scale; zero (and anything non-positive) gets its own bin
+int64_t AlmgrenChrissCache::quantize(double value) {
+    if (!(value > 0.0)) {
+        return std::numeric_limits<int64_t>::min();
+    }
+    return std::llround(std::log(value) * 1000.0);
+}
+
+double AlmgrenChrissCache::dequantize(int64_t bin) {
+    if (bin == std::numeric_limits<int64_t>::min()) {
+        return 0.0;
+    }
+    return std::exp(static_cast<double>(bin) / 1000.0);
+}
+
+AlmgrenChrissParams AlmgrenChrissCache::bin_centre(const AlmgrenChrissParams& params, const Key& key) {
+    AlmgrenChrissParams unit = params;
+    unit.quantity = 1.0;
+    unit.epsilon = 0.0;
+    unit.volatility = dequantize(key.volatility);
+    unit.horizon = dequantize(key.horizon);
+    unit.risk_aversion = dequantize(key.risk_aversion);
+    unit.gamma = dequantize(key.gamma);
+    unit.eta = dequantize(key.eta);
+    return unit;
+}
+
+template <typename Value>
+bool AlmgrenChrissCache::Table<Value>::find(const Key& key, size_t hash, Value& out) const {
+    const size_t set = hash & set_mask;
+    for (size_t way = 0; way < kWays; ++way) {
+        const Slot<Value>& slot = slots[set * kWays + way];
+        const uint64_t before = slot.seq.load(std::memory_order_acquire);
+        if (before & 1) {
+            continue;   // being overwritten; at worst a miss
+        }
+        if (!(slot.key == key)) {
+            continue;
+        }
+        const Value value = slot.value;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.seq.load(std::memory_order_relaxed) == before) {
+            out = value;
+            return true;
+        }
+    }
+    return false;
+}
+
+template <typename Value>
+void AlmgrenChrissCache::Table<Value>::insert(const Key& key, size_t hash, const Value& value) {
+    const size_t set = hash & set_mask;
+    // An empty way if there is one, otherwise evict the set's next victim
+    size_t way = kWays;
+    for (size_t w = 0; w < kWays && way == kWays; ++w) {
+        const Slot<Value>& slot = slots[set * kWays + w];
+        if ((slot.seq.load(std::memory_order_acquire) & 1) == 0 && slot.key.slices == 0) {
+            way = w;
+        }
+    }
+    if (way == kWays) {
+        way = victims[set].fetch_add(1, std::memory_order_relaxed) % kWays;
+    }
+
+    Slot<Value>& slot = slots[set * kWays + way];
+    uint64_t seq = slot.seq.load(std::memory_order_relaxed);
+    if ((seq & 1) || !slot.seq.compare_exchange_strong(seq, seq + 1, std::memory_order_acquire)) {
+        return;   // another miss is writing this slot; drop ours
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    const bool was_empty = slot.key.slices == 0;
+    slot.key = key;
+    slot.value = value;
+    slot.seq.store(seq + 2, std::memory_order_release);
+    if (was_empty) {
+        size.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+AlmgrenChrissUnitCost AlmgrenChrissCache::unit_cost_of(const AlmgrenChrissSchedule& unit) {
+    AlmgrenChrissUnitCost cost;
+    cost.kappa = unit.kappa;
+    cost.expected_cost = unit.expected_cost;
+    cost.variance = unit.variance;
+    return cost;
+}
+
+AlmgrenChrissSchedule AlmgrenChrissCache::scale(const AlmgrenChrissUnitCost& cost, const double* holdings,
+                                                int slices, const AlmgrenChrissParams& params) {
+    const double X = params.quantity;
+    AlmgrenChrissSchedule scaled;
+    scaled.kappa = cost.kappa;
+    scaled.expected_cost = cost.expected_cost * X * X + params.epsilon * std::abs(X);
+    scaled.variance = cost.variance * X * X;
+    scaled.holdings.resize(slices + 1);
+    scaled.trades.resize(slices);
+    for (int j = 0; j <= slices; ++j) {
+        scaled.holdings[j] = holdings[j] * X;
+    }
+    for (int j = 0; j < slices; ++j) {
+        scaled.trades[j] = (holdings[j] - holdings[j + 1]) * X;
+    }
+    return scaled;
+}
+
+AlmgrenChrissUnitCost AlmgrenChrissCache::unit_cost(const AlmgrenChrissParams& params) {
+    const Key key = make_key(params);
+    const size_t h = hash(key);
+    AlmgrenChrissUnitCost cost;
+    if (costs_.find(key, h, cost)) {
+        hits_.fetch_add(1, std::memory_order_relaxed);
+        return cost;
+    }
+
+    cost = unit_cost_of(solve_almgren_chriss(bin_centre(params, key)));
+    misses_.fetch_add(1, std::memory_order_relaxed);
+    costs_.insert(key, h, cost);
+    return cost;
+}
+
+double AlmgrenChrissCache::expected_cost(const AlmgrenChrissParams& params) {
+    const double X = params.quantity;
+    return unit_cost(params).expected_cost * X * X + params.epsilon * std::abs(X);
+}
+
+AlmgrenChrissSchedule AlmgrenChrissCache::schedule(const AlmgrenChrissParams& params) {
+    const Key key = make_key(params);
+    const size_t h = hash(key);
+    const bool cacheable = params.slices <= kMaxCachedSlices;
+    UnitTrajectory unit;
+    if (cacheable && trajectories_.find(key, h, unit)) {
+        hits_.fetch_add(1, std::memory_order_relaxed);
+        return scale(unit.cost, unit.holdings, params.slices, params);
+    }
+
+    const AlmgrenChrissSchedule solved = solve_almgren_chriss(bin_centre(params, key));
+    misses_.fetch_add(1, std::memory_order_relaxed);
+    unit.cost = unit_cost_of(solved);
+    costs_.insert(key, h, unit.cost);
+    if (cacheable) {
+        std::copy(solved.holdings.begin(), solved.holdings.end(), unit.holdings);
+        trajectories_.insert(key, h, unit);
+    }
+    return scale(unit.cost, solved.holdings.data(), params.slices, params);
+}
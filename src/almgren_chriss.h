@@ -0,0 +1,149 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Almgren-Chriss optimal execution (discrete-time, linear impact).
+//
+// Liquidating X units over horizon T in N slices of length tau = T/N with
+// permanent impact gamma, temporary impact eta and volatility sigma, the
+// mean-variance optimal holdings are
+//     x_j = X * sinh(kappa * (T - t_j)) / sinh(kappa * T)
+// where cosh(kappa * tau) = 1 + (lambda * sigma^2 / eta~) * tau^2 / 2 and
+// eta~ = eta - gamma * tau / 2. lambda = 0 gives the straight-line (TWAP)
+// schedule. Expected cost and variance follow the paper's E[x] and V[x].
+
+struct AlmgrenChrissParams {
+    double quantity = 1.0;        // X
+    double volatility = 0.0;      // sigma, per unit time
+    double horizon = 1.0;         // T
+    int slices = 10;              // N
+    double risk_aversion = 0.0;   // lambda
+    double gamma = 0.0;           // permanent impact coefficient
+    double eta = 0.0;             // temporary impact coefficient
+    double epsilon = 0.0;         // fixed cost per unit traded (half spread + fees)
+};
+
+struct AlmgrenChrissSchedule {
+    double kappa = 0.0;
+    double expected_cost = 0.0;   // E[implementation shortfall]
+    double variance = 0.0;        // Var[implementation shortfall]
+    std::vector<double> holdings; // x_0 .. x_N (x_0 = X, x_N = 0)
+    std::vector<double> trades;   // n_1 .. n_N, n_j = x_{j-1} - x_j
+};
+
+struct FrontierPoint {
+    double risk_aversion;
+    double expected_cost;
+    double variance;
+};
+
+// Throws std::invalid_argument for a non-positive horizon or slice count,
+// negative risk aversion or volatility, or eta~ <= 0 (tau too coarse for gamma)
+AlmgrenChrissSchedule solve_almgren_chriss(const AlmgrenChrissParams& params);
+
+// (E, V) of the optimal schedule for each risk aversion
+std::vector<FrontierPoint> efficient_frontier(const AlmgrenChrissParams& params,
+                                              const double* risk_aversions, size_t count);
+
+// Unit-quantity expected cost and variance of an optimal schedule
+struct AlmgrenChrissUnitCost {
+    double kappa = 0.0;
+    double expected_cost = 0.0;   // E for X = 1, epsilon = 0
+    double variance = 0.0;        // V for X = 1
+};
+
+// Schedules cached by quantized parameters.
+//
+// The optimal trajectory is linear in X, and E and V scale with X^2, so the
+// cache stores unit-quantity results keyed by volatility, horizon, slices,
+// risk aversion, gamma and eta, and scales on the way out (the linear
+// epsilon term is added after scaling). The order size is never quantized;
+// the other parameters are binned to 0.1% relative and solved at the bin
+// centre, so every caller in a bin gets the same answer.
+//
+// Two tables share the key: unit costs for the batch and per-order impact
+// paths, and unit trajectories (up to kMaxCachedSlices) for schedule(). Each
+// is a fixed 4-way set-associative array of seqlocked slots. Lookups take no
+// lock and touch no reference count, so the UI thread and sweep workers read
+// concurrently. A miss solves outside the tables and overwrites one slot of
+// its set; a slot being written reads as a miss, and a second writer racing
+// for it skips the insert.
+class AlmgrenChrissCache {
+public:
+    static constexpr int kMaxCachedSlices = 64;
+
+    // Each rounded up to a power-of-two number of 4-slot sets
+    explicit AlmgrenChrissCache(size_t capacity = 4096, size_t trajectory_capacity = 256);
+
+    AlmgrenChrissCache(const AlmgrenChrissCache&) = delete;
+    AlmgrenChrissCache& operator=(const AlmgrenChrissCache&) = delete;
+
+    // Unit-quantity costs for the parameters (quantity and epsilon ignored)
+    AlmgrenChrissUnitCost unit_cost(const AlmgrenChrissParams& params);
+
+    // Expected cost for params.quantity without materializing the trajectory
+    double expected_cost(const AlmgrenChrissParams& params);
+    // Full trajectory at the bin centre, scaled to params.quantity. Solved
+    // only on a miss; more than kMaxCachedSlices slices are never cached.
+    AlmgrenChrissSchedule schedule(const AlmgrenChrissParams& params);
+
+    // Unit-cost table occupancy
+    size_t size() const { return costs_.size.load(std::memory_order_relaxed); }
+    size_t capacity() const { return costs_.slots.size(); }
+    size_t trajectory_size() const { return trajectories_.size.load(std::memory_order_relaxed); }
+    // Lookups answered without a solve, and solves
+    uint64_t hits() const { return hits_.load(std::memory_order_relaxed); }
+    uint64_t misses() const { return misses_.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr size_t kWays = 4;
+
+    struct Key {
+        int64_t volatility, horizon, risk_aversion, gamma, eta;
+        int slices;   // 0 marks an empty slot
+        bool operator==(const Key& other) const;
+    };
+
+    // Holdings x_0 .. x_N of the unit-quantity schedule
+    struct UnitTrajectory {
+        AlmgrenChrissUnitCost cost;
+        double holdings[kMaxCachedSlices + 1];
+    };
+
+    template <typename Value>
+    struct Slot {
+        std::atomic<uint64_t> seq{0};   // odd while the slot is being written
+        Key key{0, 0, 0, 0, 0, 0};
+        Value value;
+    };
+
+    template <typename Value>
+    struct Table {
+        std::vector<Slot<Value>> slots;
+        std::unique_ptr<std::atomic<uint32_t>[]> victims;   // per-set round-robin eviction cursor
+        size_t set_mask = 0;
+        std::atomic<size_t> size{0};
+
+        explicit Table(size_t capacity);
+        bool find(const Key& key, size_t hash, Value& out) const;
+        void insert(const Key& key, size_t hash, const Value& value);
+    };
+
+    static Key make_key(const AlmgrenChrissParams& params);
+    static size_t hash(const Key& key);
+    static int64_t quantize(double value);
+    static double dequantize(int64_t bin);
+    static AlmgrenChrissParams bin_centre(const AlmgrenChrissParams& params, const Key& key);
+    static AlmgrenChrissUnitCost unit_cost_of(const AlmgrenChrissSchedule& unit);
+    static AlmgrenChrissSchedule scale(const AlmgrenChrissUnitCost& cost, const double* holdings, int slices,
+                                       const AlmgrenChrissParams& params);
+
+    Table<AlmgrenChrissUnitCost> costs_;
+    Table<UnitTrajectory> trajectories_;
+    std::atomic<uint64_t> hits_;
+    std::atomic<uint64_t> misses_;
+};
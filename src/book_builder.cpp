@@ -0,0 +1,127 @@
+#include "book_builder.h"
+#include "logger.h"
+#include "latency_histogram.h"
+#include <algorithm>
+#include <chrono>
+
+BookBuilder::BookBuilder(Handler handler, size_t ring_capacity, size_t slot_bytes)
+    : handler_(std::move(handler)), ring_capacity_(ring_capacity), slot_bytes_(slot_bytes), running_(false) {}
+
+BookBuilder::~BookBuilder() {
+    stop();
+}
+
+FeedRing& BookBuilder::add_input() {
+    inputs_.push_back(std::make_unique<FeedRing>(ring_capacity_));
+    FeedRing& ring = *inputs_.back();
+    if (!running_.load(std::memory_order_relaxed)) {
+        ring.close();
+    }
+    for (size_t i = 0; i < ring.capacity(); ++i) {
+        ring.slot(i).payload.reserve(slot_bytes_);
+    }
+    return ring;
+}
+
+void BookBuilder::start() {
+    if (running_.exchange(true)) {
+        return;
+    }
+    for (auto& ring : inputs_) {
+        ring->open();
+    }
+    worker_ = std::thread([this]() { run(); });
+}
+
+void BookBuilder::stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+    for (auto& ring : inputs_) {
+        ring->close();
+    }
+}
+
+bool BookBuilder::push(FeedRing& ring, SymbolId symbol, const char* data, size_t size, int64_t recv_ts_ns,
+                       int64_t recv_wall_ns) {
+    FeedMessage* slot;
+    while ((slot = ring.claim()) == nullptr) {
+        if (ring.closed()) {
+            ring.drop();
+            return false;
+        }
+        std::this_thread::yield();
+    }
+    slot->symbol = symbol;
+    slot->recv_ts_ns = recv_ts_ns;
+    slot->recv_wall_ns = recv_wall_ns;
+    slot->payload.assign(data, size);
+    ring.publish();
+    return true;
+}
+
+FeedQueueStats BookBuilder::stats() const {
+    FeedQueueStats stats;
+    for (const auto& ring : inputs_) {
+        stats.depth += ring->size();
+        stats.high_water_mark = std::max(stats.high_water_mark, ring->high_water_mark());
+        stats.full_events += ring->full_events();
+        stats.full_spins += ring->full_claims();
+        stats.dropped += ring->dropped();
+    }
+    return stats;
+}
+
+size_t BookBuilder::drain(FeedRing& ring, size_t budget) {
+    size_t processed = 0;
+    FeedMessage* message;
+    while (processed < budget && (message = ring.front()) != nullptr) {
+        if (message->recv_ts_ns > 0) {
+            LatencyMonitor::instance().record(LatencyStage::Queue, LatencyMonitor::now_ns() - message->recv_ts_ns);
+        }
+        try {
+            handler_(*message);
+        } catch (const std::exception& e) {
+            LOG_ERROR("[BookBuilder] Error applying message: {}", e.what());
+        }
+        ring.pop();
+        ++processed;
+    }
+    return processed;
+}
+
+void BookBuilder::run() {
+    // Small per-ring budget keeps one busy producer from starving the others
+    const size_t budget = 64;
+    unsigned idle_passes = 0;
+
+    while (running_.load(std::memory_order_relaxed)) {
+        size_t processed = 0;
+        for (auto& ring : inputs_) {
+            processed += drain(*ring, budget);
+        }
+
+        if (processed > 0) {
+            idle_passes = 0;
+            continue;
+        }
+        if (idle_handler_) {
+            idle_handler_();
+        }
+        if (++idle_passes < 1000) {
+            std::this_thread::yield();
+        } else {
+            // Quiet feed: back off so an idle builder does not burn a core
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    }
+
+    // Drain whatever was published before stop()
+    for (auto& ring : inputs_) {
+        while (drain(*ring, budget) > 0) {
+        }
+    }
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "spsc_ring.h"
+#include "symbol_id.h"
+
+// One raw feed payload in flight between a network thread and a book builder
+struct FeedMessage {
+    SymbolId symbol = 0;
+    int64_t recv_ts_ns = 0;   // steady_clock, stamped by the network thread
+    int64_t recv_wall_ns = 0; // wall clock at the same read, compared with the exchange timestamp
+    std::string payload;      // reused buffer; grows to the largest message seen
+};
+
+using FeedRing = SpscRing<FeedMessage>;
+
+struct FeedQueueStats {
+    size_t depth = 0;
+    size_t high_water_mark = 0;   // peak depth of any one ring
+    uint64_t full_events = 0;     // pushes that found their ring full
+    uint64_t full_spins = 0;      // retries spent waiting on full rings
+    uint64_t dropped = 0;         // pushes dropped because the builder had stopped
+};
+
+// Dedicated book-builder thread fed by lock-free SPSC rings.
+//
+// Each producer (network I/O thread) gets its own ring from add_input(), so
+// the socket handler only copies bytes into a pre-allocated slot; parsing and
+// book updates run on the builder thread. When a ring is full the producer
+// yields until the builder catches up (see FeedQueueStats::full_events); if
+// the builder has stopped, the message is dropped and counted instead.
+class BookBuilder {
+public:
+    using Handler = std::function<void(const FeedMessage&)>;
+    using IdleHandler = std::function<void()>;
+
+    static constexpr size_t kDefaultRingCapacity = 256;
+    static constexpr size_t kDefaultSlotBytes = 4096;
+
+    explicit BookBuilder(Handler handler, size_t ring_capacity = kDefaultRingCapacity,
+                         size_t slot_bytes = kDefaultSlotBytes);
+    ~BookBuilder();
+
+    // Register a producer; call before start()
+    FeedRing& add_input();
+    // Called on the builder thread whenever a pass finds every ring empty
+    // (e.g. to serve OrderBook depth requests); call before start()
+    void set_idle_handler(IdleHandler handler) { idle_handler_ = std::move(handler); }
+
+    void start();
+    void stop();   // drains queued messages before returning
+
+    // Producer helper: copy a payload into the ring, yielding while it is
+    // full. False if the ring stayed full after the builder stopped.
+    static bool push(FeedRing& ring, SymbolId symbol, const char* data, size_t size, int64_t recv_ts_ns,
+                     int64_t recv_wall_ns = 0);
+
+    FeedQueueStats stats() const;
+
+private:
+    Handler handler_;
+    IdleHandler idle_handler_;
+    size_t ring_capacity_;
+    size_t slot_bytes_;
+    std::vector<std::unique_ptr<FeedRing>> inputs_;
+    std::thread worker_;
+    std::atomic<bool> running_;
+
+    void run();
+    size_t drain(FeedRing& ring, size_t budget);
+};
@@ -0,0 +1,117 @@
+#include "book_registry.h"
+#include "l2_parser.h"
+#include "latency_histogram.h"
+#include "logger.h"
+#include <algorithm>
+#include <functional>
+#include <thread>
+
+BookRegistry::BookRegistry(size_t num_shards) : running_(false) {
+    if (num_shards == 0) {
+        num_shards = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (size_t i = 0; i < num_shards; ++i) {
+        shards_.push_back(std::make_unique<BookBuilder>([this](const FeedMessage& message) {
+            apply(message);
+        }));
+        shards_.back()->set_idle_handler([this, i]() { serve_depth(i); });
+    }
+}
+
+BookRegistry::~BookRegistry() {
+    stop();
+}
+
+SymbolId BookRegistry::add_symbol(const std::string& symbol, double tick_size) {
+    auto it = ids_.find(symbol);
+    if (it != ids_.end()) {
+        return it->second;
+    }
+
+    const SymbolId id = static_cast<SymbolId>(books_.size());
+    books_.push_back(std::make_unique<OrderBook>(tick_size));
+    volatility_.push_back(std::make_unique<VolatilityEstimator>());
+    feed_latency_.push_back(std::make_unique<FeedLatencyTracker>());
+    names_.push_back(symbol);
+    shard_of_.push_back(std::hash<std::string>()(symbol) % shards_.size());
+    ids_.emplace(symbol, id);
+    return id;
+}
+
+SymbolId BookRegistry::find(const std::string& symbol) const {
+    auto it = ids_.find(symbol);
+    return it == ids_.end() ? kInvalidSymbol : it->second;
+}
+
+size_t BookRegistry::register_producer() {
+    std::vector<FeedRing*> rings;
+    for (auto& shard : shards_) {
+        rings.push_back(&shard->add_input());
+    }
+    producers_.push_back(std::move(rings));
+    return producers_.size() - 1;
+}
+
+void BookRegistry::start() {
+    if (running_.exchange(true)) {
+        return;
+    }
+    for (auto& shard : shards_) {
+        shard->start();
+    }
+}
+
+void BookRegistry::stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+    for (auto& shard : shards_) {
+        shard->stop();
+    }
+    // No shard is left to serve depth requests; publish the final books
+    for (auto& book : books_) {
+        book->flush_depth();
+    }
+}
+
+void BookRegistry::submit(size_t producer, SymbolId id, const char* data, size_t size, int64_t recv_ts_ns,
+                          int64_t recv_wall_ns) {
+    BookBuilder::push(*producers_[producer][shard_of_[id]], id, data, size, recv_ts_ns, recv_wall_ns);
+}
+
+void BookRegistry::report_feed_latency() const {
+    for (SymbolId id = 0; id < books_.size(); ++id) {
+        const FeedLatencySummary s = feed_latency_[id]->summary();
+        if (s.receive_to_apply.count == 0 && s.exchange_to_receive.count == 0) {
+            continue;
+        }
+        LOG_INFO("[Latency] {} exchange->receive p50={}us p99={}us recent={}us offset={}ms", names_[id],
+                 s.exchange_to_receive.p50_ns / 1000.0, s.exchange_to_receive.p99_ns / 1000.0,
+                 s.recent_exchange_ns / 1000.0, s.clock_offset_ns / 1e6);
+        LOG_INFO("[Latency] {} receive->applied p50={}us p99={}us max={}us", names_[id],
+                 s.receive_to_apply.p50_ns / 1000.0, s.receive_to_apply.p99_ns / 1000.0,
+                 s.receive_to_apply.max_ns / 1000.0);
+    }
+}
+
+void BookRegistry::serve_depth(size_t shard) {
+    for (SymbolId id = 0; id < books_.size(); ++id) {
+        if (shard_of_[id] == shard) {
+            books_[id]->serve_depth();
+        }
+    }
+}
+
+void BookRegistry::apply(const FeedMessage& message) {
+    // Runs on the owning shard's builder thread: the only writer for this book
+    OrderBook& book = *books_[message.symbol];
+    const int64_t exchange_ts_ns = apply_l2_payload(book, message.payload);
+    feed_latency_[message.symbol]->record(exchange_ts_ns, message.recv_wall_ns, message.recv_ts_ns,
+                                          LatencyMonitor::now_ns());
+
+    OrderLevel best_bid, best_ask;
+    if (book.read_top(best_bid, best_ask)) {
+        const int64_t ts_ns = message.recv_ts_ns > 0 ? message.recv_ts_ns : LatencyMonitor::now_ns();
+        volatility_[message.symbol]->on_top_of_book(ts_ns, best_bid, best_ask);
+    }
+}
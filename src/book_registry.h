@@ -0,0 +1,73 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "orderbook.h"
+#include "book_builder.h"
+#include "feed_latency.h"
+#include "volatility_estimator.h"
+
+// Owns one OrderBook per instrument and shards them across worker threads.
+//
+// Each symbol is pinned to a shard by hash, and only that shard's book
+// builder applies payloads to its books, so every book has exactly one
+// writer. Symbols are interned to dense ids at registration; lookups by id
+// are a vector index. Network threads register as producers and get a
+// private SPSC ring into every shard. Register symbols and producers before
+// start().
+class BookRegistry {
+public:
+    static constexpr SymbolId kInvalidSymbol = UINT32_MAX;
+
+    explicit BookRegistry(size_t num_shards = 0);   // 0 = one shard per hardware thread
+    ~BookRegistry();
+
+    SymbolId add_symbol(const std::string& symbol, double tick_size);
+    SymbolId find(const std::string& symbol) const;
+
+    size_t size() const { return books_.size(); }
+    const std::string& symbol_name(SymbolId id) const { return names_[id]; }
+    OrderBook& book(SymbolId id) { return *books_[id]; }
+    const OrderBook& book(SymbolId id) const { return *books_[id]; }
+    // Realized volatility of the symbol's touch price, updated by its shard after every applied payload
+    const VolatilityEstimator& volatility(SymbolId id) const { return *volatility_[id]; }
+    // Exchange -> receive and receive -> applied latency of the symbol's feed, recorded by its shard
+    const FeedLatencyTracker& feed_latency(SymbolId id) const { return *feed_latency_[id]; }
+    // Log every symbol's feed latency summary
+    void report_feed_latency() const;
+
+    size_t shard_count() const { return shards_.size(); }
+    size_t shard_of(SymbolId id) const { return shard_of_[id]; }
+
+    // One producer id per network thread that will call submit()
+    size_t register_producer();
+
+    void start();
+    void stop();   // drains queued payloads and leaves every book's depth copy current
+
+    // Copy a raw feed payload into the owning shard's ring (producer thread only).
+    // recv_ts_ns is steady clock, recv_wall_ns wall clock, both taken at the socket read.
+    void submit(size_t producer, SymbolId id, const char* data, size_t size, int64_t recv_ts_ns = 0,
+                int64_t recv_wall_ns = 0);
+
+    FeedQueueStats queue_stats(size_t shard) const { return shards_[shard]->stats(); }
+
+private:
+    std::vector<std::unique_ptr<OrderBook>> books_;   // indexed by SymbolId
+    std::vector<std::unique_ptr<VolatilityEstimator>> volatility_;
+    std::vector<std::unique_ptr<FeedLatencyTracker>> feed_latency_;
+    std::vector<std::string> names_;
+    std::vector<size_t> shard_of_;
+    std::unordered_map<std::string, SymbolId> ids_;
+    std::vector<std::unique_ptr<BookBuilder>> shards_;
+    std::vector<std::vector<FeedRing*>> producers_;   // [producer][shard]
+    std::atomic<bool> running_;
+
+    void apply(const FeedMessage& message);
+    // Idle pass of a shard's builder: serve depth requests for its books
+    void serve_depth(size_t shard);
+};
@@ -0,0 +1,89 @@
+#include "coefficient_store.h"
+#include "model_coefficients.h"
+#include <thread>
+
+ModelCoefficients ModelCoefficients::defaults() {
+    ModelCoefficients c;
+    c.slippage_intercept = model_coefficients::kSlippageIntercept;
+    c.slippage_quantity = model_coefficients::kSlippageQuantity;
+    c.slippage_volatility = model_coefficients::kSlippageVolatility;
+    c.impact_gamma = model_coefficients::kImpactGamma;
+    c.impact_eta = model_coefficients::kImpactEta;
+    c.impact_horizon = model_coefficients::kImpactHorizon;
+    c.impact_risk_aversion = model_coefficients::kImpactRiskAversion;
+    c.impact_slices = model_coefficients::kImpactSlices;
+    c.maker_taker_intercept = model_coefficients::kMakerTakerIntercept;
+    c.maker_taker_quantity = model_coefficients::kMakerTakerQuantity;
+    c.maker_taker_volatility = model_coefficients::kMakerTakerVolatility;
+    return c;
+}
+
+CoefficientStore::CoefficientStore(size_t symbols)
+    : symbol_count_(symbols), slots_(new Slot[symbols]) {
+    for (size_t i = 0; i < symbols; ++i) {
+        publish(static_cast<SymbolId>(i), ModelCoefficients::defaults());
+    }
+}
+
+uint64_t CoefficientStore::publish(SymbolId symbol, const ModelCoefficients& coefficients) {
+    if (symbol >= symbol_count_) {
+        return 0;
+    }
+    std::lock_guard<std::mutex> lock(writer_mutex_);
+    Slot& slot = slots_[symbol];
+    const uint64_t version = slot.version.load(std::memory_order_relaxed) + 1;
+    Block& block = slot.blocks[slot.next];
+    slot.next = (slot.next + 1) % kBlocksPerSymbol;
+
+    const uint64_t seq = block.seq.load(std::memory_order_relaxed);
+    block.seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    block.data = coefficients;
+    block.data.version = version;
+
+    block.seq.store(seq + 2, std::memory_order_release);
+    slot.current.store(&block, std::memory_order_release);
+    slot.version.store(version, std::memory_order_release);
+    return version;
+}
+
+void CoefficientStore::read(SymbolId symbol, ModelCoefficients& out) const {
+    if (symbol >= symbol_count_) {
+        out = ModelCoefficients::defaults();
+        return;
+    }
+    const Slot& slot = slots_[symbol];
+    while (true) {
+        const Block* block = slot.current.load(std::memory_order_acquire);
+        const uint64_t before = block->seq.load(std::memory_order_acquire);
+        if (before & 1) {
+            // Only possible after the ring wrapped onto this block; the pointer has moved on
+            std::this_thread::yield();
+            continue;
+        }
+        out = block->data;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (block->seq.load(std::memory_order_relaxed) == before) {
+            return;
+        }
+    }
+}
+
+ModelCoefficients CoefficientStore::read(SymbolId symbol) const {
+    ModelCoefficients out;
+    read(symbol, out);
+    return out;
+}
+
+uint64_t CoefficientStore::version(SymbolId symbol) const {
+    if (symbol >= symbol_count_) {
+        return 0;
+    }
+    return slots_[symbol].version.load(std::memory_order_acquire);
+}
+
+const CoefficientStore& CoefficientStore::builtin() {
+    static const CoefficientStore store(1);
+    return store;
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include "symbol_id.h"
+
+// One immutable set of model coefficients. Filled in by calibration and
+// published as a whole, so readers never see slippage from one calibration
+// mixed with impact from another.
+struct alignas(64) ModelCoefficients {
+    uint64_t version = 0;   // set by CoefficientStore::publish
+
+    double slippage_intercept;
+    double slippage_quantity;
+    double slippage_volatility;
+
+    double impact_gamma;
+    double impact_eta;
+    double impact_horizon;
+    double impact_risk_aversion;
+    int impact_slices;
+
+    double maker_taker_intercept;
+    double maker_taker_quantity;
+    double maker_taker_volatility;
+
+    // The built-in (uncalibrated) coefficients from model_coefficients.h
+    static ModelCoefficients defaults();
+};
+
+// Versioned per-symbol coefficient store with lock-free, allocation-free reads.
+//
+// Each symbol owns a small ring of pre-allocated, cache-line-aligned blocks
+// and an atomic pointer to the current one. publish() fills the next block in
+// the ring and swaps the pointer, so it never writes the block readers are
+// using. A reader loads the pointer and copies the block under its sequence
+// number; it only retries if it stalled for several publishes and the ring
+// wrapped onto the block it was copying. Writers are serialized by a mutex;
+// readers never take it. Size is fixed at construction.
+class CoefficientStore {
+public:
+    static constexpr size_t kBlocksPerSymbol = 4;
+
+    explicit CoefficientStore(size_t symbols = 1);
+
+    CoefficientStore(const CoefficientStore&) = delete;
+    CoefficientStore& operator=(const CoefficientStore&) = delete;
+
+    size_t size() const { return symbol_count_; }
+
+    // Publish a new model for the symbol; returns its version (starts at 1)
+    uint64_t publish(SymbolId symbol, const ModelCoefficients& coefficients);
+
+    // Copy the current coefficients; unknown symbols read as defaults()
+    void read(SymbolId symbol, ModelCoefficients& out) const;
+    ModelCoefficients read(SymbolId symbol) const;
+
+    uint64_t version(SymbolId symbol) const;
+
+    // Process-wide store with one symbol holding defaults(), for Models
+    // instances that have not been given a store
+    static const CoefficientStore& builtin();
+
+private:
+    struct alignas(64) Block {
+        std::atomic<uint64_t> seq{0};   // odd while the block is being written
+        ModelCoefficients data;
+    };
+
+    struct Slot {
+        Block blocks[kBlocksPerSymbol];
+        alignas(64) std::atomic<Block*> current{nullptr};
+        std::atomic<uint64_t> version{0};
+        size_t next = 0;               // writer only
+    };
+
+    size_t symbol_count_;
+    std::unique_ptr<Slot[]> slots_;
+    std::mutex writer_mutex_;
+};
@@ -0,0 +1,430 @@
+#include "connection_manager.h"
+#include "feed_capture.h"
+#include "l2_parser.h"
+#include "latency_histogram.h"
+#include "logger.h"
+#include <websocketpp/config/asio_no_tls_client.hpp>
+#include <websocketpp/config/asio_client.hpp>
+#include <websocketpp/client.hpp>
+#include <websocketpp/extensions/permessage_deflate/enabled.hpp>
+#include <websocketpp/uri.hpp>
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <thread>
+#include <type_traits>
+
+// permessage-deflate (RFC 7692) through websocketpp's extension, which
+// keeps one inflate context per connection for the life of the connection
+template <typename Base>
+struct deflate_config : Base {
+    struct permessage_deflate_config {
+        typedef typename Base::request_type request_type;
+    };
+    typedef websocketpp::extensions::permessage_deflate::enabled<permessage_deflate_config> permessage_deflate_type;
+};
+
+using ws_client = websocketpp::client<websocketpp::config::asio_client>;
+using wss_client = websocketpp::client<websocketpp::config::asio_tls_client>;
+using ws_deflate_client = websocketpp::client<deflate_config<websocketpp::config::asio_client>>;
+using wss_deflate_client = websocketpp::client<deflate_config<websocketpp::config::asio_tls_client>>;
+using websocketpp::connection_hdl;
+
+namespace {
+
+template <typename Endpoint>
+void init_endpoint(Endpoint& endpoint, boost::asio::io_context& io) {
+    endpoint.clear_access_channels(websocketpp::log::alevel::all);
+    endpoint.clear_error_channels(websocketpp::log::elevel::all);
+    endpoint.init_asio(&io);
+}
+
+// Calls f with the endpoint that serves this connection's scheme and compression
+template <typename Context, typename Connection, typename F>
+void with_endpoint(Context& context, const Connection& c, F&& f) {
+    if (c.secure) {
+        c.deflate ? f(context.secure_deflate_endpoint) : f(context.secure_endpoint);
+    } else {
+        c.deflate ? f(context.deflate_endpoint) : f(context.endpoint);
+    }
+}
+
+} // namespace
+
+// One io thread: its io_context, the ws:// and wss:// endpoints bound to it, and its registry producer
+struct ConnectionManager::Context {
+    boost::asio::io_context io;
+    boost::asio::executor_work_guard<boost::asio::io_context::executor_type> work;
+    ws_client endpoint;
+    wss_client secure_endpoint;
+    ws_deflate_client deflate_endpoint;
+    wss_deflate_client secure_deflate_endpoint;
+    std::shared_ptr<boost::asio::ssl::context> tls_context;
+    size_t producer;
+    std::thread thread;
+
+    Context(size_t producer_id, const TlsConfig& tls)
+        : work(boost::asio::make_work_guard(io)), tls_context(make_tls_client_context(tls)), producer(producer_id) {
+        init_endpoint(endpoint, io);
+        init_endpoint(secure_endpoint, io);
+        init_endpoint(deflate_endpoint, io);
+        init_endpoint(secure_deflate_endpoint, io);
+        secure_endpoint.set_tls_init_handler([this](connection_hdl) { return tls_context; });
+        secure_deflate_endpoint.set_tls_init_handler([this](connection_hdl) { return tls_context; });
+    }
+};
+
+// Everything except the atomics is touched only on the owning context's thread
+struct ConnectionManager::Connection {
+    FeedSubscription subscription;
+    Context* context;
+    ReconnectBackoff backoff;
+    boost::asio::steady_timer retry_timer;
+    connection_hdl hdl;
+    bool secure;
+    bool deflate;                            // offers permessage-deflate
+    std::unique_ptr<FeedInflater> inflater;  // raw deflate framing only
+    std::string host;
+    TlsSessionSlot tls_session;
+    bool open = false;
+    bool awaiting_snapshot = true;
+    int64_t connect_start_ns = 0;
+    int64_t opened_ns = 0;
+    int64_t dropped_ns = 0;   // set while recovering from a drop
+    FeedRecorder recorder;
+
+    std::atomic<ConnectionState> state{ConnectionState::Idle};
+    std::atomic<uint64_t> connects{0};
+    std::atomic<uint64_t> failures{0};
+    std::atomic<uint64_t> drops{0};
+    std::atomic<uint64_t> messages{0};
+    std::atomic<uint64_t> held_back{0};
+    std::atomic<int64_t> last_retry_delay_ms{0};
+    std::atomic<uint64_t> tls_handshakes{0};
+    std::atomic<uint64_t> tls_resumed{0};
+    std::atomic<int64_t> last_handshake_ns{0};
+    std::atomic<int64_t> last_reconnect_ns{0};
+    std::atomic<bool> permessage_deflate{false};
+    std::atomic<uint64_t> compressed_bytes{0};
+    std::atomic<uint64_t> payload_bytes{0};
+    std::atomic<uint64_t> inflate_errors{0};
+
+    Connection(const FeedSubscription& sub, Context& ctx, const BackoffConfig& backoff_config)
+        : subscription(sub), context(&ctx), backoff(backoff_config), retry_timer(ctx.io),
+          secure(sub.uri.compare(0, 6, "wss://") == 0),
+          deflate(sub.compression == FeedCompression::PerMessageDeflate) {
+        if (sub.compression == FeedCompression::RawDeflate) {
+            inflater = std::make_unique<FeedInflater>();
+        }
+        websocketpp::uri parsed(sub.uri);
+        if (parsed.get_valid()) {
+            host = parsed.get_host();
+        }
+    }
+};
+
+const char* connection_state_name(ConnectionState state) {
+    switch (state) {
+        case ConnectionState::Idle: return "idle";
+        case ConnectionState::Connecting: return "connecting";
+        case ConnectionState::Open: return "open";
+        case ConnectionState::Backoff: return "backoff";
+        case ConnectionState::Stopped: return "stopped";
+    }
+    return "unknown";
+}
+
+ConnectionManager::ConnectionManager(BookRegistry& registry, const ConnectionManagerConfig& config)
+    : registry_(registry), config_(config), running_(false) {
+    const size_t threads = std::max<size_t>(config_.io_threads, 1);
+    for (size_t i = 0; i < threads; ++i) {
+        contexts_.push_back(std::make_unique<Context>(registry_.register_producer(), config_.tls));
+    }
+}
+
+ConnectionManager::~ConnectionManager() {
+    stop();
+}
+
+size_t ConnectionManager::add_subscription(const FeedSubscription& subscription) {
+    Context& context = *contexts_[connections_.size() % contexts_.size()];
+    connections_.push_back(std::make_unique<Connection>(subscription, context, config_.backoff));
+    return connections_.size() - 1;
+}
+
+bool ConnectionManager::enable_capture(size_t subscription, const std::string& path) {
+    return subscription < connections_.size() && connections_[subscription]->recorder.open(path);
+}
+
+void ConnectionManager::start() {
+    if (running_.exchange(true)) {
+        return;
+    }
+    for (auto& connection : connections_) {
+        Connection* c = connection.get();
+        boost::asio::post(c->context->io, [this, c]() { connect(*c); });
+    }
+    for (auto& context : contexts_) {
+        Context* ctx = context.get();
+        ctx->thread = std::thread([ctx]() {
+            // A throwing handler must not take the other subscriptions down with it
+            while (true) {
+                try {
+                    ctx->io.run();
+                    return;
+                } catch (const std::exception& e) {
+                    LOG_ERROR("[Feed] io thread handler failed: {}", e.what());
+                }
+            }
+        });
+    }
+}
+
+void ConnectionManager::stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+    // Close on each connection's own thread, then let the io_contexts run dry
+    for (auto& connection : connections_) {
+        Connection* c = connection.get();
+        boost::asio::post(c->context->io, [this, c]() { close(*c); });
+    }
+    for (auto& context : contexts_) {
+        Context* ctx = context.get();
+        boost::asio::post(ctx->io, [ctx]() { ctx->work.reset(); });
+    }
+    for (auto& context : contexts_) {
+        if (context->thread.joinable()) {
+            context->thread.join();
+        }
+    }
+}
+
+ConnectionStats ConnectionManager::stats(size_t subscription) const {
+    ConnectionStats stats;
+    if (subscription >= connections_.size()) {
+        return stats;
+    }
+    const Connection& c = *connections_[subscription];
+    stats.state = c.state.load(std::memory_order_relaxed);
+    stats.connects = c.connects.load(std::memory_order_relaxed);
+    stats.failures = c.failures.load(std::memory_order_relaxed);
+    stats.drops = c.drops.load(std::memory_order_relaxed);
+    stats.messages = c.messages.load(std::memory_order_relaxed);
+    stats.held_back = c.held_back.load(std::memory_order_relaxed);
+    stats.last_retry_delay_ms = c.last_retry_delay_ms.load(std::memory_order_relaxed);
+    stats.tls_handshakes = c.tls_handshakes.load(std::memory_order_relaxed);
+    stats.tls_resumed = c.tls_resumed.load(std::memory_order_relaxed);
+    stats.last_handshake_ns = c.last_handshake_ns.load(std::memory_order_relaxed);
+    stats.last_reconnect_ns = c.last_reconnect_ns.load(std::memory_order_relaxed);
+    stats.permessage_deflate = c.permessage_deflate.load(std::memory_order_relaxed);
+    stats.compressed_bytes = c.compressed_bytes.load(std::memory_order_relaxed);
+    stats.payload_bytes = c.payload_bytes.load(std::memory_order_relaxed);
+    stats.inflate_errors = c.inflate_errors.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void ConnectionManager::connect(Connection& c) {
+    if (!running_) {
+        return;
+    }
+    c.state = ConnectionState::Connecting;
+    c.connect_start_ns = LatencyMonitor::now_ns();
+    with_endpoint(*c.context, c, [this, &c](auto& endpoint) { connect_with(endpoint, c); });
+}
+
+template <typename Endpoint>
+void ConnectionManager::connect_with(Endpoint& endpoint, Connection& c) {
+    constexpr bool kSecure = std::is_same<Endpoint, wss_client>::value
+                             || std::is_same<Endpoint, wss_deflate_client>::value;
+    constexpr bool kDeflate = std::is_same<Endpoint, ws_deflate_client>::value
+                              || std::is_same<Endpoint, wss_deflate_client>::value;
+    websocketpp::lib::error_code ec;
+    typename Endpoint::connection_ptr con = endpoint.get_connection(c.subscription.uri, ec);
+    if (ec) {
+        // A bad URI will not get better by retrying
+        LOG_ERROR("[Feed] Cannot connect to {}: {}", c.subscription.uri, ec.message());
+        c.state = ConnectionState::Stopped;
+        return;
+    }
+    Connection* target = &c;
+    Endpoint* owner = &endpoint;
+
+    // TCP is up, no handshake bytes read yet
+    con->set_tcp_pre_init_handler([this, owner](connection_hdl hdl) {
+        websocketpp::lib::error_code hdl_ec;
+        typename Endpoint::connection_ptr connected = owner->get_con_from_hdl(hdl, hdl_ec);
+        if (!hdl_ec) {
+            apply_socket_tuning(connected->get_raw_socket(), config_.socket);
+        }
+    });
+    if constexpr (kSecure) {
+        con->set_socket_init_handler([this, target](connection_hdl, auto& socket) {
+            if (!prepare_tls_session(socket.native_handle(), target->host, &target->tls_session, config_.tls)) {
+                LOG_WARN("[Feed] Cannot set TLS host {} for {}", target->host, target->subscription.uri);
+            }
+        });
+    }
+    con->set_open_handler([this, target, owner](connection_hdl hdl) {
+        bool resumed = false;
+        bool deflate = false;
+        websocketpp::lib::error_code hdl_ec;
+        typename Endpoint::connection_ptr opened = owner->get_con_from_hdl(hdl, hdl_ec);
+        if constexpr (kSecure) {
+            resumed = !hdl_ec && tls_session_resumed(opened->get_socket().native_handle());
+        }
+        if constexpr (kDeflate) {
+            deflate = !hdl_ec && opened->get_response_header("Sec-WebSocket-Extensions").find("permessage-deflate")
+                                     != std::string::npos;
+        }
+        on_open(*target, resumed, deflate);
+    });
+    con->set_fail_handler([this, target](connection_hdl) { on_closed(*target, false); });
+    con->set_close_handler([this, target](connection_hdl) { on_closed(*target, true); });
+    con->set_message_handler([this, target](connection_hdl, typename Endpoint::message_ptr msg) {
+        on_message(*target, msg->get_payload(), msg->get_opcode() == websocketpp::frame::opcode::binary);
+    });
+    c.hdl = con->get_handle();
+    endpoint.connect(con);
+}
+
+void ConnectionManager::schedule_reconnect(Connection& c) {
+    const int64_t delay_ms = c.backoff.next_delay_ms();
+    c.last_retry_delay_ms.store(delay_ms, std::memory_order_relaxed);
+    c.state = ConnectionState::Backoff;
+    LOG_INFO("[Feed] Reconnecting to {} in {} ms (attempt {})", c.subscription.uri, delay_ms, c.backoff.attempts());
+    c.retry_timer.expires_after(std::chrono::milliseconds(delay_ms));
+    Connection* target = &c;
+    c.retry_timer.async_wait([this, target](const boost::system::error_code& ec) {
+        if (!ec) {
+            connect(*target);
+        }
+    });
+}
+
+void ConnectionManager::on_open(Connection& c, bool tls_resumed, bool permessage_deflate) {
+    c.open = true;
+    c.awaiting_snapshot = true;
+    c.opened_ns = LatencyMonitor::now_ns();
+    c.connects.fetch_add(1, std::memory_order_relaxed);
+    c.state = ConnectionState::Open;
+
+    const int64_t handshake_ns = c.opened_ns - c.connect_start_ns;
+    c.last_handshake_ns.store(handshake_ns, std::memory_order_relaxed);
+    LatencyMonitor::instance().record(LatencyStage::Handshake, handshake_ns);
+    if (c.dropped_ns != 0) {
+        const int64_t reconnect_ns = c.opened_ns - c.dropped_ns;
+        c.last_reconnect_ns.store(reconnect_ns, std::memory_order_relaxed);
+        LatencyMonitor::instance().record(LatencyStage::Reconnect, reconnect_ns);
+        c.dropped_ns = 0;
+    }
+    if (c.secure) {
+        c.tls_handshakes.fetch_add(1, std::memory_order_relaxed);
+        c.tls_resumed.fetch_add(tls_resumed ? 1 : 0, std::memory_order_relaxed);
+    }
+    c.permessage_deflate.store(permessage_deflate, std::memory_order_relaxed);
+    if (c.inflater) {
+        c.inflater->reset();
+    }
+
+    if (!running_) {
+        close(c);
+        return;
+    }
+    LOG_INFO("[Feed] Connected: {} in {} us{}{}", c.subscription.uri, handshake_ns / 1000.0,
+             tls_resumed ? " (TLS session resumed)" : "", permessage_deflate ? " (permessage-deflate)" : "");
+    if (c.deflate && !permessage_deflate) {
+        LOG_INFO("[Feed] {} declined permessage-deflate", c.subscription.uri);
+    }
+
+    if (!c.subscription.subscribe_message.empty()) {
+        websocketpp::lib::error_code ec;
+        with_endpoint(*c.context, c, [&c, &ec](auto& endpoint) {
+            endpoint.send(c.hdl, c.subscription.subscribe_message, websocketpp::frame::opcode::text, ec);
+        });
+        if (ec) {
+            LOG_WARN("[Feed] Subscribe to {} failed: {}", c.subscription.uri, ec.message());
+        }
+    }
+}
+
+void ConnectionManager::on_closed(Connection& c, bool was_open) {
+    c.open = false;
+    if (was_open) {
+        c.drops.fetch_add(1, std::memory_order_relaxed);
+        c.dropped_ns = LatencyMonitor::now_ns();
+        // Only a connection that stayed up earns a fast retry; a flapping one keeps backing off
+        if (LatencyMonitor::now_ns() - c.opened_ns >= config_.stable_after_ms * 1000000) {
+            c.backoff.reset();
+        }
+        LOG_WARN("[Feed] Connection closed: {}", c.subscription.uri);
+    } else {
+        c.failures.fetch_add(1, std::memory_order_relaxed);
+        LOG_WARN("[Feed] Connection failed: {}", c.subscription.uri);
+    }
+    if (!running_) {
+        c.state = ConnectionState::Stopped;
+        return;
+    }
+    schedule_reconnect(c);
+}
+
+void ConnectionManager::on_message(Connection& c, const std::string& frame, bool binary) {
+    // First code to see the frame after websocketpp's read; the wall stamp is
+    // compared with the exchange timestamp, the steady one with later stages
+    const int64_t recv_ts_ns = LatencyMonitor::now_ns();
+    const int64_t recv_wall_ns = LatencyMonitor::wall_ns();
+    c.messages.fetch_add(1, std::memory_order_relaxed);
+
+    const char* data = frame.data();
+    size_t size = frame.size();
+    if (binary && c.inflater) {
+        c.compressed_bytes.fetch_add(size, std::memory_order_relaxed);
+        if (!c.inflater->inflate(data, size)) {
+            // The lost message may have been a delta: resync from the next snapshot
+            c.inflate_errors.fetch_add(1, std::memory_order_relaxed);
+            c.awaiting_snapshot = true;
+            LOG_WARN("[Feed] Cannot inflate a {} byte message from {}", size, c.subscription.uri);
+            return;
+        }
+        data = c.inflater->data();
+        size = c.inflater->size();
+    }
+    c.payload_bytes.fetch_add(size, std::memory_order_relaxed);
+    if (c.recorder.is_open()) {
+        c.recorder.append(data, size);
+    }
+
+    // After a reconnect the book has missed updates: apply nothing but a snapshot until one arrives
+    const L2PayloadKind kind = classify_l2_payload(data, size);
+    if (kind == L2PayloadKind::Other) {
+        LOG_DEBUG("[Feed] Non-book message from {}: {}", c.subscription.uri, std::string(data, size));
+        return;
+    }
+    if (kind == L2PayloadKind::Update && c.awaiting_snapshot) {
+        c.held_back.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    c.awaiting_snapshot = false;
+
+    registry_.submit(c.context->producer, c.subscription.symbol, data, size, recv_ts_ns, recv_wall_ns);
+    LatencyMonitor::instance().record(LatencyStage::Receive, LatencyMonitor::now_ns() - recv_ts_ns);
+}
+
+void ConnectionManager::close(Connection& c) {
+    c.retry_timer.cancel();
+    c.state = ConnectionState::Stopped;
+    if (c.open) {
+        websocketpp::lib::error_code ec;
+        with_endpoint(*c.context, c, [&c, &ec](auto& endpoint) {
+            endpoint.close(c.hdl, websocketpp::close::status::going_away, "", ec);
+        });
+        if (ec) {
+            LOG_WARN("[Feed] Error closing {}: {}", c.subscription.uri, ec.message());
+        }
+    }
+}
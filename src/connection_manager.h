@@ -0,0 +1,112 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "book_registry.h"
+#include "feed_compression.h"
+#include "reconnect_backoff.h"
+#include "tls_transport.h"
+
+// One feed subscription: a WebSocket endpoint whose payloads go to `symbol`
+struct FeedSubscription {
+    std::string uri;
+    SymbolId symbol = BookRegistry::kInvalidSymbol;
+    // Sent after every (re)connect, e.g. an OKX {"op":"subscribe",...}
+    // request; empty for feeds addressed by URL alone
+    std::string subscribe_message;
+    // PerMessageDeflate offers the extension; the server may still decline it
+    FeedCompression compression = FeedCompression::None;
+};
+
+struct ConnectionManagerConfig {
+    size_t io_threads = 1;              // one io_context per thread
+    BackoffConfig backoff;
+    int64_t stable_after_ms = 10000;    // uptime after which a drop restarts the backoff
+    SocketTuning socket;                // applied to ws:// and wss:// sockets alike
+    TlsConfig tls;                      // wss:// only
+};
+
+enum class ConnectionState { Idle, Connecting, Open, Backoff, Stopped };
+
+const char* connection_state_name(ConnectionState state);
+
+struct ConnectionStats {
+    ConnectionState state = ConnectionState::Idle;
+    uint64_t connects = 0;             // successful opens
+    uint64_t failures = 0;             // attempts that never opened
+    uint64_t drops = 0;                // open connections that closed
+    uint64_t messages = 0;
+    uint64_t held_back = 0;            // deltas dropped while waiting for a snapshot
+    int64_t last_retry_delay_ms = 0;
+    uint64_t tls_handshakes = 0;       // wss:// opens
+    uint64_t tls_resumed = 0;          // of which resumed the previous session
+    int64_t last_handshake_ns = 0;     // connect() to open
+    int64_t last_reconnect_ns = 0;     // drop to the next open, backoff included
+    bool permessage_deflate = false;   // negotiated on the last open
+    uint64_t compressed_bytes = 0;     // raw deflate frames as received
+    uint64_t payload_bytes = 0;        // payloads handed on, after inflating
+    uint64_t inflate_errors = 0;       // raw deflate frames that did not inflate
+};
+
+// Multiplexes many feed subscriptions over a few io_contexts.
+//
+// Each io thread runs its own io_context with plain and TLS WebSocket
+// endpoints, with and without permessage-deflate; the URI scheme and the
+// subscription's compression pick one. Subscriptions are dealt round-robin
+// to the threads. Every handler for a
+// subscription therefore runs on one thread, so the state needs no locks.
+// Each io thread is also a single registry producer.
+//
+// A closed or failed connection is retried from an asio timer with
+// exponential backoff and jitter, so the event loop never sleeps and
+// other subscriptions keep flowing. On every open the subscribe message is
+// sent again. Deltas are held back until the next snapshot, so a book that
+// missed updates during the outage is rebuilt before it moves again.
+// A wss:// reconnect offers the subscription's last TLS session, so the
+// server can resume it instead of running a full handshake. Handshake and
+// reconnect times go to the latency monitor.
+// Raw deflate frames are inflated on the io thread into the connection's
+// reused buffer, so the rest of the pipeline only ever sees JSON.
+// Construct and add subscriptions before registry.start().
+class ConnectionManager {
+public:
+    ConnectionManager(BookRegistry& registry, const ConnectionManagerConfig& config = ConnectionManagerConfig());
+    ~ConnectionManager();
+
+    ConnectionManager(const ConnectionManager&) = delete;
+    ConnectionManager& operator=(const ConnectionManager&) = delete;
+
+    // Before start(); returns the subscription index
+    size_t add_subscription(const FeedSubscription& subscription);
+    // Append the subscription's raw payloads to a binary capture (see feed_capture.h)
+    bool enable_capture(size_t subscription, const std::string& path);
+
+    void start();
+    void stop();   // closes every connection and joins the io threads
+
+    size_t size() const { return connections_.size(); }
+    ConnectionStats stats(size_t subscription) const;
+
+private:
+    struct Context;
+    struct Connection;
+
+    BookRegistry& registry_;
+    ConnectionManagerConfig config_;
+    std::vector<std::unique_ptr<Context>> contexts_;
+    std::vector<std::unique_ptr<Connection>> connections_;
+    std::atomic<bool> running_;
+
+    void connect(Connection& connection);
+    template <typename Endpoint>
+    void connect_with(Endpoint& endpoint, Connection& connection);
+    void schedule_reconnect(Connection& connection);
+    void on_open(Connection& connection, bool tls_resumed, bool permessage_deflate);
+    void on_closed(Connection& connection, bool was_open);
+    void on_message(Connection& connection, const std::string& payload, bool binary);
+    void close(Connection& connection);
+};
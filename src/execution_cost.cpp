@@ -0,0 +1,105 @@
+#include "execution_cost.h"
+#include <algorithm>
+
+ExecutionCostEngine::ExecutionCostEngine() : mid_(0.0), version_(0), loaded_(false) {}
+
+void ExecutionCostEngine::Side::load(const OrderLevel* levels, size_t n) {
+    // Find the first level that differs from what is loaded; prefixes before it are still valid
+    size_t first = 0;
+    const size_t common = std::min(count, n);
+    while (first < common && price[first] == levels[first].price && quantity[first] == levels[first].quantity) {
+        ++first;
+    }
+
+    double cq = first > 0 ? cum_quantity[first - 1] : 0.0;
+    double cn = first > 0 ? cum_notional[first - 1] : 0.0;
+    for (size_t i = first; i < n; ++i) {
+        price[i] = levels[i].price;
+        quantity[i] = levels[i].quantity;
+        cq += levels[i].quantity;
+        cn += levels[i].price * levels[i].quantity;
+        cum_quantity[i] = cq;
+        cum_notional[i] = cn;
+    }
+    count = n;
+}
+
+size_t ExecutionCostEngine::Side::find_level(double notional) const {
+    // First level whose cumulative notional covers the order; count if the book is too thin
+    return static_cast<size_t>(std::lower_bound(cum_notional, cum_notional + count, notional) - cum_notional);
+}
+
+bool ExecutionCostEngine::update(const BookSnapshot& snapshot) {
+    if (loaded_ && snapshot.version == version_) {
+        return false;
+    }
+    asks_.load(snapshot.asks, snapshot.ask_count);
+    bids_.load(snapshot.bids, snapshot.bid_count);
+    mid_ = (asks_.count > 0 && bids_.count > 0) ? 0.5 * (asks_.price[0] + bids_.price[0]) : 0.0;
+    version_ = snapshot.version;
+    loaded_ = true;
+    return true;
+}
+
+double ExecutionCostEngine::depth_notional(OrderSide s) const {
+    const Side& sd = side(s);
+    return sd.count > 0 ? sd.cum_notional[sd.count - 1] : 0.0;
+}
+
+void ExecutionCostEngine::fill(OrderSide s, size_t level, double notional, double& vwap, double& slippage) const {
+    const Side& sd = side(s);
+    if (sd.count == 0 || mid_ <= 0.0 || notional <= 0.0) {
+        vwap = sd.count > 0 ? sd.price[0] : 0.0;
+        slippage = 0.0;
+        return;
+    }
+
+    double quantity;
+    if (level >= sd.count) {
+        // Not enough depth: the whole visible side is consumed
+        notional = sd.cum_notional[sd.count - 1];
+        quantity = sd.cum_quantity[sd.count - 1];
+    } else {
+        // Full levels before `level`, then a partial fill of `level`
+        const double before_notional = level > 0 ? sd.cum_notional[level - 1] : 0.0;
+        const double before_quantity = level > 0 ? sd.cum_quantity[level - 1] : 0.0;
+        quantity = before_quantity + (notional - before_notional) / sd.price[level];
+    }
+
+    vwap = notional / quantity;
+    slippage = (s == OrderSide::Buy ? vwap - mid_ : mid_ - vwap) / mid_;
+}
+
+ExecutionEstimate ExecutionCostEngine::estimate(OrderSide s, double notional) const {
+    const Side& sd = side(s);
+    ExecutionEstimate result;
+    const size_t level = sd.find_level(notional);
+
+    fill(s, level, notional, result.vwap, result.slippage);
+    result.fully_filled = level < sd.count;
+    result.levels_consumed = std::min(level + 1, sd.count);
+    if (sd.count > 0) {
+        result.filled_notional = result.fully_filled ? notional : sd.cum_notional[sd.count - 1];
+        result.filled_quantity = result.vwap > 0.0 ? result.filled_notional / result.vwap : 0.0;
+    }
+    return result;
+}
+
+void ExecutionCostEngine::estimate_batch(OrderSide s, const double* notionals, size_t count,
+                                         double* vwap_out, double* slippage_out) const {
+    const Side& sd = side(s);
+    const bool ascending = std::is_sorted(notionals, notionals + count);
+
+    size_t level = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (ascending) {
+            // Merge walk: the level index only ever moves forward
+            while (level < sd.count && sd.cum_notional[level] < notionals[i]) {
+                ++level;
+            }
+        } else {
+            level = sd.find_level(notionals[i]);
+        }
+        fill(s, level, notionals[i], vwap_out[i], slippage_out[i]);
+    }
+}
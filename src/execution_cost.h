@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "orderbook.h"
+
+enum class OrderSide { Buy, Sell };   // buys walk the asks, sells walk the bids
+
+struct ExecutionEstimate {
+    double filled_notional = 0.0;
+    double filled_quantity = 0.0;
+    double vwap = 0.0;
+    double slippage = 0.0;        // fraction of mid paid beyond mid (>= 0 on a sane book)
+    size_t levels_consumed = 0;
+    bool fully_filled = false;
+};
+
+// Execution-cost engine driven by the live order book.
+//
+// Keeps cumulative quantity / notional prefix arrays for both sides of one
+// book snapshot. update() recomputes the prefixes only from the first level
+// that changed since the previous version, and estimate() is a binary search
+// over cumulative notional plus one interpolation into the last level.
+class ExecutionCostEngine {
+public:
+    ExecutionCostEngine();
+
+    // Returns false when the snapshot version was already loaded
+    bool update(const BookSnapshot& snapshot);
+
+    uint64_t version() const { return version_; }
+    double mid() const { return mid_; }
+    double depth_notional(OrderSide side) const;
+
+    // Cost of a market order for `notional` (quote currency) against the book
+    ExecutionEstimate estimate(OrderSide side, double notional) const;
+
+    // Evaluate many order sizes against the same snapshot. Ascending inputs
+    // are handled with a single merge walk; otherwise each is a binary search.
+    void estimate_batch(OrderSide side, const double* notionals, size_t count,
+                        double* vwap_out, double* slippage_out) const;
+
+private:
+    struct Side {
+        size_t count = 0;
+        double price[BookSnapshot::kMaxDepth];
+        double quantity[BookSnapshot::kMaxDepth];
+        double cum_quantity[BookSnapshot::kMaxDepth];
+        double cum_notional[BookSnapshot::kMaxDepth];
+
+        void load(const OrderLevel* levels, size_t n);
+        size_t find_level(double notional) const;
+    };
+
+    Side asks_;
+    Side bids_;
+    double mid_;
+    uint64_t version_;
+    bool loaded_;
+
+    const Side& side(OrderSide s) const { return s == OrderSide::Buy ? asks_ : bids_; }
+    void fill(OrderSide s, size_t level, double notional, double& vwap, double& slippage) const;
+};
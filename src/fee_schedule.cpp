@@ -0,0 +1,94 @@
+#include "fee_schedule.h"
+
+static_assert(VenueFeeModel<venues::Okx>::table.taker[2] == 0.0005, "OKX tier 2 taker rate");
+static_assert(VenueFeeModel<venues::Okx>::table.taker[0] == 0.001 && VenueFeeModel<venues::Okx>::table.taker[7] == 0.001,
+              "tiers outside the schedule are charged tier 1");
+static_assert(FeeTable::slot(-1) == 0 && FeeTable::slot(kMaxFeeTiers + 1) == 0, "out-of-range tiers clamp to slot 0");
+
+FeeScheduleRegistry::FeeScheduleRegistry(size_t symbols) : tables_(symbols), venue_of_(symbols, 0) {
+    add_venue<venues::Okx>();
+    add_venue<venues::Binance>();
+    add_venue<venues::Bybit>();
+    for (FeeTable& table : tables_) {
+        table = venues_.front().table;
+    }
+}
+
+void FeeScheduleRegistry::add_venue(const std::string& name, const FeeTable& table) {
+    for (size_t v = 0; v < venues_.size(); ++v) {
+        if (venues_[v].name != name) {
+            continue;
+        }
+        venues_[v].table = table;
+        // Symbols on the replaced venue pick up the new schedule
+        for (size_t s = 0; s < tables_.size(); ++s) {
+            if (venue_of_[s] == v) {
+                tables_[s] = table;
+            }
+        }
+        return;
+    }
+    venues_.push_back({name, table});
+}
+
+bool FeeScheduleRegistry::has_venue(const std::string& name) const {
+    for (const Venue& venue : venues_) {
+        if (venue.name == name) {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector<std::string> FeeScheduleRegistry::venue_names() const {
+    std::vector<std::string> names;
+    for (const Venue& venue : venues_) {
+        names.push_back(venue.name);
+    }
+    return names;
+}
+
+bool FeeScheduleRegistry::assign(SymbolId symbol, const std::string& venue) {
+    if (symbol >= tables_.size()) {
+        return false;
+    }
+    for (size_t v = 0; v < venues_.size(); ++v) {
+        if (venues_[v].name == venue) {
+            venue_of_[symbol] = v;
+            tables_[symbol] = venues_[v].table;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool FeeScheduleRegistry::override_rates(SymbolId symbol, int tier, double maker, double taker) {
+    if (symbol >= tables_.size()) {
+        return false;
+    }
+    FeeTable& table = tables_[symbol];
+    if (tier < 1 || static_cast<size_t>(tier) > table.tiers) {
+        return false;
+    }
+    table.maker[tier] = maker;
+    table.taker[tier] = taker;
+    if (tier == 1) {
+        // Keep the fallback slots in step with tier 1
+        table.maker[0] = maker;
+        table.taker[0] = taker;
+        for (size_t i = table.tiers + 1; i <= kMaxFeeTiers; ++i) {
+            table.maker[i] = maker;
+            table.taker[i] = taker;
+        }
+    }
+    return true;
+}
+
+const std::string& FeeScheduleRegistry::venue(SymbolId symbol) const {
+    return venues_[symbol < venue_of_.size() ? venue_of_[symbol] : 0].name;
+}
+
+const FeeScheduleRegistry& FeeScheduleRegistry::builtin() {
+    static const FeeScheduleRegistry registry(1);
+    return registry;
+}
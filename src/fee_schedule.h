@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "symbol_id.h"
+
+constexpr size_t kMaxFeeTiers = 10;
+
+// A venue's published fee schedule: maker and taker rates per VIP tier
+// (tier 1 first). A negative maker rate is a rebate.
+struct VenueFeeSchedule {
+    const char* name;
+    size_t tiers;
+    double maker[kMaxFeeTiers];
+    double taker[kMaxFeeTiers];
+};
+
+// Resolved rates indexed directly by tier. Slot 0 and the slots past the
+// venue's last tier hold the tier 1 rates, so any tier outside [1, tiers] is
+// charged tier 1 and a lookup is one clamped index and one load.
+struct FeeTable {
+    double maker[kMaxFeeTiers + 1];
+    double taker[kMaxFeeTiers + 1];
+    size_t tiers;
+
+    static constexpr size_t slot(int tier) {
+        return static_cast<unsigned>(tier) <= kMaxFeeTiers ? static_cast<size_t>(tier) : 0;
+    }
+    constexpr double maker_rate(int tier) const { return maker[slot(tier)]; }
+    constexpr double taker_rate(int tier) const { return taker[slot(tier)]; }
+};
+
+constexpr FeeTable make_fee_table(const VenueFeeSchedule& schedule) {
+    FeeTable table{};
+    table.tiers = schedule.tiers;
+    for (size_t i = 0; i <= kMaxFeeTiers; ++i) {
+        const size_t tier = i >= 1 && i <= schedule.tiers ? i : 1;
+        table.maker[i] = schedule.maker[tier - 1];
+        table.taker[i] = schedule.taker[tier - 1];
+    }
+    return table;
+}
+
+// Built-in spot schedules (indicative published rates)
+namespace venues {
+
+struct Okx {
+    // The simulator's original three tiers: 0.1%, 0.05%, 0.02% taker
+    static constexpr VenueFeeSchedule schedule = {
+        "OKX", 3,
+        {0.0008, 0.00035, -0.00005},
+        {0.001, 0.0005, 0.0002}};
+};
+
+struct Binance {
+    // VIP 0-9
+    static constexpr VenueFeeSchedule schedule = {
+        "Binance", 10,
+        {0.001, 0.0009, 0.0008, 0.00042, 0.00042, 0.00036, 0.0003, 0.00024, 0.00018, 0.00012},
+        {0.001, 0.001, 0.001, 0.0006, 0.00054, 0.00048, 0.00042, 0.00036, 0.0003, 0.00024}};
+};
+
+struct Bybit {
+    // VIP 0-5
+    static constexpr VenueFeeSchedule schedule = {
+        "Bybit", 6,
+        {0.001, 0.000675, 0.00065, 0.000625, 0.0005, 0.0004},
+        {0.001, 0.0008, 0.000775, 0.00075, 0.0006, 0.0005}};
+};
+
+} // namespace venues
+
+// Fee model specialized for one venue: the table is built at compile time,
+// so fees for a venue known statically fold to a multiply by a constant
+template <typename Venue>
+struct VenueFeeModel {
+    static constexpr FeeTable table = make_fee_table(Venue::schedule);
+
+    static constexpr double taker_fee(double quantity, int tier) { return quantity * table.taker_rate(tier); }
+    static constexpr double maker_fee(double quantity, int tier) { return quantity * table.maker_rate(tier); }
+};
+
+// Maps each symbol to a venue's fee table, with optional per-instrument
+// overrides (promotional pairs, negotiated rates).
+//
+// Venues and assignments are set up before the feed and UI threads start;
+// table() is then a read-only lookup with no locking. Symbols without an
+// assignment, and unknown ids, use the default venue (the first registered,
+// OKX for the built-in set).
+class FeeScheduleRegistry {
+public:
+    explicit FeeScheduleRegistry(size_t symbols = 1);   // built-in venues registered
+
+    template <typename Venue>
+    void add_venue() { add_venue(Venue::schedule.name, VenueFeeModel<Venue>::table); }
+    // Register (or replace) a venue by name
+    void add_venue(const std::string& name, const FeeTable& table);
+    bool has_venue(const std::string& name) const;
+    std::vector<std::string> venue_names() const;
+
+    // Point a symbol at a venue's schedule, dropping its overrides; false for
+    // an unknown venue or symbol
+    bool assign(SymbolId symbol, const std::string& venue);
+    // Replace one tier's rates for one symbol; false if the tier is not in the venue's schedule
+    bool override_rates(SymbolId symbol, int tier, double maker, double taker);
+
+    const std::string& venue(SymbolId symbol) const;
+    const FeeTable& table(SymbolId symbol) const {
+        return symbol < tables_.size() ? tables_[symbol] : venues_.front().table;
+    }
+    size_t size() const { return tables_.size(); }
+
+    // Process-wide registry with one symbol on the default venue, for Models
+    // instances that have not been given one
+    static const FeeScheduleRegistry& builtin();
+
+private:
+    struct Venue {
+        std::string name;
+        FeeTable table;
+    };
+
+    std::vector<Venue> venues_;
+    std::vector<FeeTable> tables_;     // per symbol, overrides applied
+    std::vector<size_t> venue_of_;     // per symbol, index into venues_
+};
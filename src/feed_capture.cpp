@@ -0,0 +1,202 @@
+#include "feed_capture.h"
+#include "l2_parser.h"
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const char kMagic[8] = {'T', 'S', 'F', 'E', 'E', 'D', '0', '1'};
+const size_t kRecordHeader = sizeof(uint32_t) + sizeof(int64_t);
+
+int64_t wall_clock_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+FeedRecorder::FeedRecorder() : file_(nullptr), records_(0) {}
+
+FeedRecorder::~FeedRecorder() {
+    close();
+}
+
+bool FeedRecorder::open(const std::string& path) {
+    close();
+    file_ = std::fopen(path.c_str(), "ab");
+    if (!file_) {
+        std::cerr << "[Capture] Could not open " << path << std::endl;
+        return false;
+    }
+    // Large stdio buffer: the feed thread only pays for a memcpy per message
+    std::setvbuf(file_, nullptr, _IOFBF, 1 << 20);
+    std::fseek(file_, 0, SEEK_END);
+    if (std::ftell(file_) == 0) {
+        std::fwrite(kMagic, 1, sizeof(kMagic), file_);
+    }
+    return true;
+}
+
+void FeedRecorder::close() {
+    if (file_) {
+        std::fclose(file_);
+        file_ = nullptr;
+    }
+}
+
+void FeedRecorder::append(const char* data, size_t size) {
+    append(data, size, wall_clock_ns());
+}
+
+void FeedRecorder::append(const char* data, size_t size, int64_t recv_ts_ns) {
+    if (!file_) {
+        return;
+    }
+    const uint32_t length = static_cast<uint32_t>(size);
+    std::fwrite(&length, sizeof(length), 1, file_);
+    std::fwrite(&recv_ts_ns, sizeof(recv_ts_ns), 1, file_);
+    std::fwrite(data, 1, size, file_);
+    ++records_;
+}
+
+FeedReplay::FeedReplay()
+    : data_(nullptr), size_(0), offset_(0),
+#ifdef _WIN32
+      file_handle_(INVALID_HANDLE_VALUE), mapping_handle_(nullptr)
+#else
+      fd_(-1)
+#endif
+{}
+
+FeedReplay::~FeedReplay() {
+    close();
+}
+
+bool FeedReplay::open(const std::string& path) {
+    close();
+
+#ifdef _WIN32
+    file_handle_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                               FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file_handle_ == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file_handle_, &file_size) || file_size.QuadPart == 0) {
+        close();
+        return false;
+    }
+    mapping_handle_ = CreateFileMappingA(file_handle_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping_handle_) {
+        close();
+        return false;
+    }
+    data_ = static_cast<const char*>(MapViewOfFile(mapping_handle_, FILE_MAP_READ, 0, 0, 0));
+    size_ = static_cast<size_t>(file_size.QuadPart);
+#else
+    fd_ = ::open(path.c_str(), O_RDONLY);
+    if (fd_ < 0) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd_, &st) != 0 || st.st_size == 0) {
+        close();
+        return false;
+    }
+    void* mapped = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd_, 0);
+    if (mapped == MAP_FAILED) {
+        close();
+        return false;
+    }
+    madvise(mapped, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+    data_ = static_cast<const char*>(mapped);
+    size_ = static_cast<size_t>(st.st_size);
+#endif
+
+    if (!data_ || size_ < sizeof(kMagic) || std::memcmp(data_, kMagic, sizeof(kMagic)) != 0) {
+        std::cerr << "[Capture] " << path << " is not a feed capture" << std::endl;
+        close();
+        return false;
+    }
+    rewind();
+    return true;
+}
+
+void FeedReplay::close() {
+#ifdef _WIN32
+    if (data_) UnmapViewOfFile(data_);
+    if (mapping_handle_) CloseHandle(mapping_handle_);
+    if (file_handle_ != INVALID_HANDLE_VALUE) CloseHandle(file_handle_);
+    mapping_handle_ = nullptr;
+    file_handle_ = INVALID_HANDLE_VALUE;
+#else
+    if (data_) munmap(const_cast<char*>(data_), size_);
+    if (fd_ >= 0) ::close(fd_);
+    fd_ = -1;
+#endif
+    data_ = nullptr;
+    size_ = 0;
+    offset_ = 0;
+}
+
+void FeedReplay::rewind() {
+    offset_ = sizeof(kMagic);
+}
+
+bool FeedReplay::next(FeedRecord& record) {
+    if (!data_ || offset_ + kRecordHeader > size_) {
+        return false;
+    }
+    uint32_t length;
+    std::memcpy(&length, data_ + offset_, sizeof(length));
+    std::memcpy(&record.recv_ts_ns, data_ + offset_ + sizeof(length), sizeof(record.recv_ts_ns));
+    if (offset_ + kRecordHeader + length > size_) {
+        // Truncated tail (capture still being written or cut short)
+        return false;
+    }
+    record.data = data_ + offset_ + kRecordHeader;
+    record.size = length;
+    offset_ += kRecordHeader + length;
+    return true;
+}
+
+size_t FeedReplay::replay(const std::function<void(const FeedRecord&)>& sink, Pace pace) {
+    rewind();
+    FeedRecord record;
+    size_t delivered = 0;
+    int64_t first_ts = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    while (next(record)) {
+        if (pace == Pace::Recorded) {
+            if (delivered == 0) {
+                first_ts = record.recv_ts_ns;
+            }
+            std::this_thread::sleep_until(start + std::chrono::nanoseconds(record.recv_ts_ns - first_ts));
+        }
+        sink(record);
+        ++delivered;
+    }
+    return delivered;
+}
+
+size_t FeedReplay::replay_into(OrderBook& book, Pace pace) {
+    return replay([&book](const FeedRecord& record) {
+        try {
+            apply_l2_payload(book, record.data, record.size);
+        } catch (const std::exception& e) {
+            std::cerr << "[Capture] Error replaying record: " << e.what() << std::endl;
+        }
+    }, pace);
+}
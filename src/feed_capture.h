@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include "orderbook.h"
+
+// Binary capture of the raw feed and memory-mapped replay.
+//
+// File layout: an 8-byte magic ("TSFEED01") followed by records of
+//   uint32 payload length | int64 receive time (ns since epoch) | payload bytes
+// in host byte order. Captures are meant to be replayed on the machine
+// class that recorded them.
+
+struct FeedRecord {
+    int64_t recv_ts_ns;
+    const char* data;
+    uint32_t size;
+};
+
+class FeedRecorder {
+public:
+    FeedRecorder();
+    ~FeedRecorder();
+
+    bool open(const std::string& path);
+    void close();
+    bool is_open() const { return file_ != nullptr; }
+
+    // Append one payload stamped with the current wall-clock time
+    void append(const char* data, size_t size);
+    void append(const char* data, size_t size, int64_t recv_ts_ns);
+
+    uint64_t records() const { return records_; }
+
+private:
+    std::FILE* file_;
+    uint64_t records_;
+};
+
+class FeedReplay {
+public:
+    enum class Pace { AsFastAsPossible, Recorded };
+
+    FeedReplay();
+    ~FeedReplay();
+
+    // Memory-map a capture file; returns false if it is missing or not a capture
+    bool open(const std::string& path);
+    void close();
+
+    // Sequential access to the mapped records (payloads point into the mapping)
+    bool next(FeedRecord& record);
+    void rewind();
+
+    // Push every record to `sink`, optionally sleeping to reproduce recorded gaps.
+    // Returns the number of records delivered.
+    size_t replay(const std::function<void(const FeedRecord&)>& sink, Pace pace = Pace::AsFastAsPossible);
+
+    // Convenience: run the capture through the normal parse/apply path into a book
+    size_t replay_into(OrderBook& book, Pace pace = Pace::AsFastAsPossible);
+
+private:
+    const char* data_;
+    size_t size_;
+    size_t offset_;
+#ifdef _WIN32
+    void* file_handle_;
+    void* mapping_handle_;
+#else
+    int fd_;
+#endif
+};
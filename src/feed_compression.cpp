@@ -0,0 +1,156 @@
+#include "feed_compression.h"
+#include <zlib.h>
+#include <algorithm>
+
+namespace {
+
+// Negative window bits: raw deflate, no zlib or gzip wrapper
+constexpr int kRawWindowBits = -15;
+// The empty stored block a sync flush ends with; permessage-deflate strips it
+constexpr unsigned char kSyncFlushTail[4] = {0x00, 0x00, 0xff, 0xff};
+
+} // namespace
+
+const char* feed_compression_name(FeedCompression compression) {
+    switch (compression) {
+        case FeedCompression::None: return "none";
+        case FeedCompression::PerMessageDeflate: return "permessage-deflate";
+        case FeedCompression::RawDeflate: return "raw";
+    }
+    return "unknown";
+}
+
+bool parse_feed_compression(const std::string& name, FeedCompression& compression) {
+    if (name == "none") {
+        compression = FeedCompression::None;
+    } else if (name == "permessage-deflate" || name == "deflate") {
+        compression = FeedCompression::PerMessageDeflate;
+    } else if (name == "raw") {
+        compression = FeedCompression::RawDeflate;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+FeedInflater::FeedInflater(bool context_takeover, size_t initial_capacity)
+    : stream_(new z_stream()), takeover_(context_takeover),
+      buffer_(std::max<size_t>(initial_capacity, 4096)), size_(0), grows_(0) {
+    if (inflateInit2(stream_, kRawWindowBits) != Z_OK) {
+        delete stream_;
+        stream_ = nullptr;
+    }
+}
+
+FeedInflater::~FeedInflater() {
+    if (stream_ != nullptr) {
+        inflateEnd(stream_);
+        delete stream_;
+    }
+}
+
+void FeedInflater::reset() {
+    if (stream_ != nullptr) {
+        inflateReset(stream_);
+    }
+    size_ = 0;
+}
+
+bool FeedInflater::inflate(const char* data, size_t size) {
+    size_ = 0;
+    if (stream_ == nullptr) {
+        return false;
+    }
+    if (!takeover_) {
+        inflateReset(stream_);   // keeps the window allocation
+    }
+    const bool ok = run(reinterpret_cast<const unsigned char*>(data), size)
+                    && (!takeover_ || run(kSyncFlushTail, sizeof(kSyncFlushTail)));
+    if (!ok) {
+        inflateReset(stream_);
+        size_ = 0;
+    }
+    return ok;
+}
+
+bool FeedInflater::run(const unsigned char* data, size_t size) {
+    stream_->next_in = const_cast<Bytef*>(data);
+    stream_->avail_in = static_cast<uInt>(size);
+    while (true) {
+        if (size_ == buffer_.size()) {
+            buffer_.resize(buffer_.size() * 2);
+            ++grows_;
+        }
+        stream_->next_out = reinterpret_cast<Bytef*>(buffer_.data() + size_);
+        stream_->avail_out = static_cast<uInt>(buffer_.size() - size_);
+        const int rc = ::inflate(stream_, Z_SYNC_FLUSH);
+        size_ = buffer_.size() - stream_->avail_out;
+        if (rc == Z_STREAM_END) {
+            // The message closed its stream; whatever follows starts a new one
+            inflateReset(stream_);
+            return true;
+        }
+        if (rc != Z_OK && rc != Z_BUF_ERROR) {
+            return false;
+        }
+        if (stream_->avail_out != 0) {
+            // Input used up with room to spare. A standalone message must
+            // have ended its stream; running out first means it was cut short.
+            return takeover_;
+        }
+    }
+}
+
+FeedDeflater::FeedDeflater(int level, bool context_takeover, size_t initial_capacity)
+    : stream_(new z_stream()), takeover_(context_takeover),
+      buffer_(std::max<size_t>(initial_capacity, 4096)), size_(0) {
+    if (deflateInit2(stream_, level, Z_DEFLATED, kRawWindowBits, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        delete stream_;
+        stream_ = nullptr;
+    }
+}
+
+FeedDeflater::~FeedDeflater() {
+    if (stream_ != nullptr) {
+        deflateEnd(stream_);
+        delete stream_;
+    }
+}
+
+bool FeedDeflater::deflate(const char* data, size_t size) {
+    size_ = 0;
+    if (stream_ == nullptr) {
+        return false;
+    }
+    if (!takeover_) {
+        deflateReset(stream_);
+    }
+    const size_t bound = deflateBound(stream_, static_cast<uLong>(size)) + sizeof(kSyncFlushTail);
+    if (buffer_.size() < bound) {
+        buffer_.resize(bound);
+    }
+    stream_->next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+    stream_->avail_in = static_cast<uInt>(size);
+    const int flush = takeover_ ? Z_SYNC_FLUSH : Z_FINISH;
+    while (true) {
+        stream_->next_out = reinterpret_cast<Bytef*>(buffer_.data() + size_);
+        stream_->avail_out = static_cast<uInt>(buffer_.size() - size_);
+        const int rc = ::deflate(stream_, flush);
+        size_ = buffer_.size() - stream_->avail_out;
+        if (rc == Z_STREAM_END || (takeover_ && rc == Z_OK && stream_->avail_out != 0)) {
+            break;
+        }
+        if (rc != Z_OK && rc != Z_BUF_ERROR) {
+            deflateReset(stream_);
+            size_ = 0;
+            return false;
+        }
+        buffer_.resize(buffer_.size() * 2);
+    }
+    if (takeover_ && size_ >= sizeof(kSyncFlushTail)
+        && std::equal(kSyncFlushTail, kSyncFlushTail + sizeof(kSyncFlushTail), buffer_.data() + size_ - 4,
+                      [](unsigned char a, char b) { return a == static_cast<unsigned char>(b); })) {
+        size_ -= sizeof(kSyncFlushTail);
+    }
+    return true;
+}
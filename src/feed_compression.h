@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// zlib stays out of this header
+struct z_stream_s;
+
+// How a subscription's payloads are compressed on the wire
+enum class FeedCompression {
+    None,
+    // RFC 7692: negotiated in the WebSocket handshake, inflated by the WebSocket layer
+    PerMessageDeflate,
+    // Venue framing: each binary frame is one raw deflate (RFC 1951) stream, text frames are plain
+    RawDeflate
+};
+
+const char* feed_compression_name(FeedCompression compression);
+// "none", "permessage-deflate" (or "deflate") and "raw"; false for anything else
+bool parse_feed_compression(const std::string& name, FeedCompression& compression);
+
+// Raw inflate with one zlib context for the life of a connection.
+//
+// Output goes to a buffer that is sized up front and only grows, so in the
+// steady state inflating a message allocates nothing; the zlib window and
+// tables are allocated once, not per message. Without context takeover each
+// message is its own stream and the context is reset (not rebuilt) between
+// messages. With context takeover messages continue one stream and end at a
+// sync flush, as in permessage-deflate, and the stripped 00 00 FF FF tail is
+// fed back in after each message.
+class FeedInflater {
+public:
+    explicit FeedInflater(bool context_takeover = false, size_t initial_capacity = 256 << 10);
+    ~FeedInflater();
+
+    FeedInflater(const FeedInflater&) = delete;
+    FeedInflater& operator=(const FeedInflater&) = delete;
+
+    // Inflate one message; data() stays valid until the next call. On a
+    // corrupt message, or without context takeover one that ends before its
+    // stream does (a truncated frame), returns false and starts a fresh stream.
+    bool inflate(const char* data, size_t size);
+    // Forget the stream, e.g. after a reconnect
+    void reset();
+
+    const char* data() const { return buffer_.data(); }
+    size_t size() const { return size_; }
+    size_t capacity() const { return buffer_.size(); }
+    uint64_t grows() const { return grows_; }   // times a message outgrew the buffer
+
+private:
+    z_stream_s* stream_;
+    bool takeover_;
+    std::vector<char> buffer_;
+    size_t size_;
+    uint64_t grows_;
+
+    bool run(const unsigned char* data, size_t size);
+};
+
+// The sending side, for the local feed server and tests: raw deflate with a
+// persistent context and a reused output buffer. Without context takeover
+// every message is a complete stream; with it messages end at a sync flush
+// with the 00 00 FF FF tail stripped.
+class FeedDeflater {
+public:
+    explicit FeedDeflater(int level = -1, bool context_takeover = false, size_t initial_capacity = 64 << 10);
+    ~FeedDeflater();
+
+    FeedDeflater(const FeedDeflater&) = delete;
+    FeedDeflater& operator=(const FeedDeflater&) = delete;
+
+    bool deflate(const char* data, size_t size);
+
+    const char* data() const { return buffer_.data(); }
+    size_t size() const { return size_; }
+
+private:
+    z_stream_s* stream_;
+    bool takeover_;
+    std::vector<char> buffer_;
+    size_t size_;
+};
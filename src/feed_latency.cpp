@@ -0,0 +1,67 @@
+#include "feed_latency.h"
+#include <algorithm>
+#include <limits>
+
+namespace {
+
+constexpr int64_t kNoSample = std::numeric_limits<int64_t>::max();
+
+} // namespace
+
+ClockOffsetEstimator::ClockOffsetEstimator(int64_t window_ns, size_t intervals)
+    : window_ns_(std::max<int64_t>(window_ns, 1)),
+      interval_ns_(std::max<int64_t>(window_ns_ / static_cast<int64_t>(std::max<size_t>(intervals, 1)), 1)),
+      intervals_(std::max<size_t>(intervals, 1), Interval{std::numeric_limits<int64_t>::min(), kNoSample}),
+      current_(0), closed_min_ns_(kNoSample), offset_(0), valid_(false) {}
+
+int64_t ClockOffsetEstimator::add(int64_t raw_delay_ns, int64_t recv_wall_ns) {
+    const int64_t start_ns = recv_wall_ns - recv_wall_ns % interval_ns_;
+    if (start_ns > intervals_[current_].start_ns) {
+        // New interval: drop whatever fell out of the window
+        current_ = (current_ + 1) % intervals_.size();
+        intervals_[current_] = Interval{start_ns, kNoSample};
+        closed_min_ns_ = kNoSample;
+        for (size_t i = 0; i < intervals_.size(); ++i) {
+            if (i != current_ && intervals_[i].start_ns > start_ns - window_ns_) {
+                closed_min_ns_ = std::min(closed_min_ns_, intervals_[i].min_ns);
+            }
+        }
+    }
+    // A wall clock stepped backwards lands in the current interval
+    Interval& interval = intervals_[current_];
+    interval.min_ns = std::min(interval.min_ns, raw_delay_ns);
+
+    const int64_t estimate = std::min(closed_min_ns_, interval.min_ns);
+    offset_.store(estimate, std::memory_order_relaxed);
+    valid_.store(true, std::memory_order_release);
+    return estimate;
+}
+
+void FeedLatencyTracker::record(int64_t exchange_ts_ns, int64_t recv_wall_ns, int64_t recv_ts_ns, int64_t applied_ns) {
+    if (recv_ts_ns > 0) {
+        receive_to_apply_.record(applied_ns - recv_ts_ns);
+    }
+    if (exchange_ts_ns <= 0 || recv_wall_ns <= 0) {
+        without_timestamp_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    const int64_t raw_ns = recv_wall_ns - exchange_ts_ns;
+    const int64_t excess_ns = raw_ns - offset_.add(raw_ns, recv_wall_ns);
+    exchange_to_receive_.record(excess_ns);
+    LatencyMonitor::instance().record(LatencyStage::Exchange, excess_ns);
+
+    // EWMA with weight 1/16; single writer, so load-then-store is enough
+    const int64_t recent = recent_exchange_ns_.load(std::memory_order_relaxed);
+    recent_exchange_ns_.store(recent + (excess_ns - recent) / 16, std::memory_order_relaxed);
+}
+
+FeedLatencySummary FeedLatencyTracker::summary() const {
+    FeedLatencySummary summary;
+    summary.exchange_to_receive = exchange_to_receive_.summary();
+    summary.receive_to_apply = receive_to_apply_.summary();
+    summary.offset_valid = offset_.valid();
+    summary.clock_offset_ns = offset_.offset_ns();
+    summary.recent_exchange_ns = recent_exchange_ns_.load(std::memory_order_relaxed);
+    summary.without_timestamp = without_timestamp_.load(std::memory_order_relaxed);
+    return summary;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "latency_histogram.h"
+
+// Offset between the exchange clock and ours, from one-way samples.
+//
+// Receive wall time minus exchange timestamp is the one-way delay plus the
+// clock offset. Its minimum over a sliding window is the offset plus the
+// path's floor delay, the best estimate one-way samples allow. What a
+// message shows above that minimum is queueing, venue batching or a
+// congested path. The window is kept as per-interval minima keyed by
+// receive time, so a clock step or slew is absorbed within one window.
+class ClockOffsetEstimator {
+public:
+    explicit ClockOffsetEstimator(int64_t window_ns = 60LL * 1000000000, size_t intervals = 12);
+
+    // Single writer; returns the estimate including this sample
+    int64_t add(int64_t raw_delay_ns, int64_t recv_wall_ns);
+
+    // Any thread
+    bool valid() const { return valid_.load(std::memory_order_acquire); }
+    int64_t offset_ns() const { return offset_.load(std::memory_order_relaxed); }
+
+private:
+    struct Interval {
+        int64_t start_ns;
+        int64_t min_ns;
+    };
+
+    int64_t window_ns_;
+    int64_t interval_ns_;
+    std::vector<Interval> intervals_;
+    size_t current_;
+    int64_t closed_min_ns_;   // over the finished intervals still in the window
+    std::atomic<int64_t> offset_;
+    std::atomic<bool> valid_;
+};
+
+struct FeedLatencySummary {
+    LatencySummary exchange_to_receive;   // net of the clock offset estimate
+    LatencySummary receive_to_apply;      // socket read to book updated
+    bool offset_valid = false;
+    int64_t clock_offset_ns = 0;          // clock offset plus the floor one-way delay
+    int64_t recent_exchange_ns = 0;       // exchange_to_receive over roughly the last 16 messages
+    uint64_t without_timestamp = 0;       // applied payloads that carried no exchange time
+};
+
+// One symbol's feed latency, split into the part outside the process
+// (exchange timestamp to socket read) and the part inside it (socket read
+// to book applied). Recorded by the shard that owns the symbol; read from
+// any thread. The recent average reacts within a few messages, while the
+// histograms cover the whole session.
+class FeedLatencyTracker {
+public:
+    // exchange_ts_ns and recv_wall_ns are wall clock, recv_ts_ns and
+    // applied_ns steady clock; zeros mark a missing stamp
+    void record(int64_t exchange_ts_ns, int64_t recv_wall_ns, int64_t recv_ts_ns, int64_t applied_ns);
+
+    FeedLatencySummary summary() const;
+    const ClockOffsetEstimator& clock_offset() const { return offset_; }
+
+private:
+    LatencyHistogram exchange_to_receive_;
+    LatencyHistogram receive_to_apply_;
+    ClockOffsetEstimator offset_;
+    std::atomic<int64_t> recent_exchange_ns_{0};
+    std::atomic<uint64_t> without_timestamp_{0};
+};
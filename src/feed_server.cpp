@@ -0,0 +1,365 @@
+#include "feed_server.h"
+#include "feed_capture.h"
+#include "feed_compression.h"
+#include "latency_histogram.h"
+#include "logger.h"
+#include <websocketpp/config/asio_no_tls.hpp>
+#include <websocketpp/server.hpp>
+#include <websocketpp/extensions/permessage_deflate/enabled.hpp>
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/strand.hpp>
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <map>
+#include <mutex>
+#include <thread>
+
+// Accepts permessage-deflate offers, as most venues do
+struct deflate_server_config : websocketpp::config::asio {
+    struct permessage_deflate_config {
+        typedef websocketpp::config::asio::request_type request_type;
+    };
+    typedef websocketpp::extensions::permessage_deflate::enabled<permessage_deflate_config> permessage_deflate_type;
+};
+
+using ws_server = websocketpp::server<deflate_server_config>;
+using websocketpp::connection_hdl;
+
+namespace {
+
+// Sends per wake-up before yielding the io thread to other connections
+constexpr uint64_t kMaxBatch = 4096;
+// Wait before looking at a full send buffer again
+constexpr int64_t kThrottleWaitNs = 200000;
+
+int64_t wall_clock_ms() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// One client's stream. Its timer handlers run on its strand, so the
+// generator needs no lock even with several io threads.
+struct Stream {
+    boost::asio::strand<boost::asio::io_context::executor_type> strand;
+    boost::asio::steady_timer timer;
+    connection_hdl hdl;
+    std::unique_ptr<SyntheticFeed> feed;
+    std::unique_ptr<FeedReplay> replay;
+    FeedRecord pending{0, nullptr, 0};   // replay record not yet sent
+    int64_t replay_origin_ns = 0;        // receive time of the first record
+    FeedPacer pacer;
+    std::unique_ptr<FeedDeflater> deflater;   // raw deflate framing only
+    int64_t start_ns = 0;
+    uint64_t sent = 0;
+    bool closed = false;
+
+    Stream(boost::asio::io_context& io, connection_hdl handle, const FeedPacer& stream_pacer)
+        : strand(boost::asio::make_strand(io)), timer(strand), hdl(handle), pacer(stream_pacer) {}
+};
+
+} // namespace
+
+struct SyntheticFeedServer::Impl {
+    FeedServerConfig config;
+    boost::asio::io_context io;
+    boost::asio::executor_work_guard<boost::asio::io_context::executor_type> work;
+    ws_server server;
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::map<connection_hdl, std::shared_ptr<Stream>, std::owner_less<connection_hdl>> streams;
+    bool running = false;
+
+    std::atomic<uint64_t> connections{0};
+    std::atomic<uint64_t> rejected{0};
+    std::atomic<uint64_t> messages{0};
+    std::atomic<uint64_t> bytes{0};
+    std::atomic<uint64_t> compressed_bytes{0};
+    std::atomic<uint64_t> throttled{0};
+
+    explicit Impl(const FeedServerConfig& server_config)
+        : config(server_config), work(boost::asio::make_work_guard(io)) {
+        server.clear_access_channels(websocketpp::log::alevel::all);
+        server.clear_error_channels(websocketpp::log::elevel::all);
+        server.init_asio(&io);
+        server.set_reuse_addr(true);
+        server.set_open_handler([this](connection_hdl hdl) { on_open(hdl); });
+        server.set_close_handler([this](connection_hdl hdl) { on_closed(hdl); });
+        server.set_fail_handler([this](connection_hdl hdl) { on_closed(hdl); });
+    }
+
+    bool replaying() const { return !config.replay_path.empty(); }
+
+    void on_open(connection_hdl hdl) {
+        websocketpp::lib::error_code ec;
+        ws_server::connection_ptr con = server.get_con_from_hdl(hdl, ec);
+        if (ec) {
+            return;
+        }
+        connections.fetch_add(1, std::memory_order_relaxed);
+
+        auto stream = std::make_shared<Stream>(io, hdl, FeedPacer(config.rate, config.burst));
+        if (replaying()) {
+            stream->replay = std::make_unique<FeedReplay>();
+            if (!stream->replay->open(config.replay_path) || !stream->replay->next(stream->pending)) {
+                reject(hdl, "capture unavailable");
+                return;
+            }
+            stream->replay_origin_ns = stream->pending.recv_ts_ns;
+        } else {
+            // Last path segment names the symbol: /ws/l2-orderbook/okx/SYN-3
+            std::string resource = con->get_resource();
+            resource = resource.substr(0, resource.find('?'));
+            const std::string symbol = resource.substr(resource.rfind('/') + 1);
+            size_t index = config.symbols;
+            for (size_t i = 0; i < config.symbols; ++i) {
+                if (symbol == synthetic_symbol_name(i)) {
+                    index = i;
+                    break;
+                }
+            }
+            if (index == config.symbols) {
+                reject(hdl, "unknown symbol");
+                return;
+            }
+            stream->feed = std::make_unique<SyntheticFeed>(config.feed, index);
+        }
+
+        if (config.raw_deflate) {
+            stream->deflater = std::make_unique<FeedDeflater>(config.deflate_level);
+        }
+        stream->start_ns = LatencyMonitor::now_ns();
+        stream->pacer.start(stream->start_ns);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            streams[hdl] = stream;
+        }
+        boost::asio::post(stream->strand, [this, stream]() { pump(stream); });
+    }
+
+    void on_closed(connection_hdl hdl) {
+        std::shared_ptr<Stream> stream;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = streams.find(hdl);
+            if (it == streams.end()) {
+                return;
+            }
+            stream = it->second;
+            streams.erase(it);
+        }
+        boost::asio::post(stream->strand, [stream]() {
+            stream->closed = true;
+            stream->timer.cancel();
+        });
+    }
+
+    void reject(connection_hdl hdl, const char* reason) {
+        rejected.fetch_add(1, std::memory_order_relaxed);
+        LOG_WARN("[FeedServer] Rejecting connection: {}", reason);
+        websocketpp::lib::error_code ec;
+        server.close(hdl, websocketpp::close::status::policy_violation, reason, ec);
+    }
+
+    // Finish the stream with a normal close; the client sees a clean end of feed
+    void finish(Stream& stream) {
+        stream.closed = true;
+        websocketpp::lib::error_code ec;
+        server.close(stream.hdl, websocketpp::close::status::normal, "end of feed", ec);
+    }
+
+    // Send whatever is due, then sleep until the next burst
+    void pump(const std::shared_ptr<Stream>& stream) {
+        Stream& s = *stream;
+        if (s.closed) {
+            return;
+        }
+        websocketpp::lib::error_code ec;
+        ws_server::connection_ptr con = server.get_con_from_hdl(s.hdl, ec);
+        if (ec) {
+            return;
+        }
+
+        const int64_t now = LatencyMonitor::now_ns();
+        const bool recorded_pace = s.replay && config.rate <= 0.0;
+        uint64_t target = recorded_pace ? UINT64_MAX : s.pacer.due(now);
+        if (config.max_messages > 0) {
+            target = std::min(target, config.max_messages);
+        }
+        const int64_t ts_ms = wall_clock_ms();
+
+        bool full = false;
+        uint64_t batch = 0;
+        int64_t wake_ns = 0;
+        while (s.sent < target && batch < kMaxBatch) {
+            if (con->get_buffered_amount() > config.max_buffered_bytes) {
+                full = true;
+                break;
+            }
+            const char* data;
+            size_t size;
+            if (s.replay) {
+                if (recorded_pace) {
+                    const int64_t due_ns = s.start_ns + (s.pending.recv_ts_ns - s.replay_origin_ns);
+                    if (due_ns > now) {
+                        wake_ns = due_ns;
+                        break;
+                    }
+                }
+                data = s.pending.data;
+                size = s.pending.size;
+            } else {
+                const std::string& payload = s.feed->next(ts_ms);
+                data = payload.data();
+                size = payload.size();
+            }
+
+            if (s.deflater) {
+                if (!s.deflater->deflate(data, size)) {
+                    LOG_ERROR("[FeedServer] Cannot deflate a {} byte payload", size);
+                    finish(s);
+                    return;
+                }
+                ec = con->send(s.deflater->data(), s.deflater->size(), websocketpp::frame::opcode::binary);
+            } else {
+                ec = con->send(data, size, websocketpp::frame::opcode::text);
+            }
+            if (ec) {
+                return;   // connection is going away; the close handler cleans up
+            }
+            ++s.sent;
+            ++batch;
+            messages.fetch_add(1, std::memory_order_relaxed);
+            bytes.fetch_add(size, std::memory_order_relaxed);
+            if (s.deflater) {
+                compressed_bytes.fetch_add(s.deflater->size(), std::memory_order_relaxed);
+            }
+
+            if (s.replay && !s.replay->next(s.pending)) {
+                if (!config.replay_loop) {
+                    finish(s);
+                    return;
+                }
+                // Start the capture over on a fresh clock
+                s.replay->rewind();
+                s.replay->next(s.pending);
+                s.start_ns = LatencyMonitor::now_ns();
+                s.replay_origin_ns = s.pending.recv_ts_ns;
+            }
+        }
+
+        if (config.max_messages > 0 && s.sent >= config.max_messages) {
+            finish(s);
+            return;
+        }
+
+        if (full) {
+            throttled.fetch_add(1, std::memory_order_relaxed);
+            wake_ns = now + kThrottleWaitNs;
+        } else if (wake_ns != 0) {
+            // next record's recorded gap
+        } else if (s.sent < target) {
+            wake_ns = now;   // batch cap: let other connections run, then carry on
+        } else {
+            wake_ns = s.pacer.next_due_ns(s.sent);
+        }
+        s.timer.expires_after(std::chrono::nanoseconds(std::max<int64_t>(wake_ns - now, 0)));
+        s.timer.async_wait([this, stream](const boost::system::error_code& wait_ec) {
+            if (!wait_ec) {
+                pump(stream);
+            }
+        });
+    }
+};
+
+SyntheticFeedServer::SyntheticFeedServer(const FeedServerConfig& config)
+    : impl_(std::make_unique<Impl>(config)) {}
+
+SyntheticFeedServer::~SyntheticFeedServer() {
+    stop();
+}
+
+uint16_t SyntheticFeedServer::listen(uint16_t port, bool any_address) {
+    const boost::asio::ip::address address = any_address
+        ? boost::asio::ip::address(boost::asio::ip::address_v4::any())
+        : boost::asio::ip::address(boost::asio::ip::address_v4::loopback());
+    websocketpp::lib::error_code ec;
+    impl_->server.listen(boost::asio::ip::tcp::endpoint(address, port), ec);
+    if (!ec) {
+        impl_->server.start_accept(ec);
+    }
+    if (ec) {
+        LOG_ERROR("[FeedServer] Cannot listen on port {}: {}", static_cast<int>(port), ec.message());
+        return 0;
+    }
+    websocketpp::lib::asio::error_code endpoint_ec;
+    return impl_->server.get_local_endpoint(endpoint_ec).port();
+}
+
+void SyntheticFeedServer::start() {
+    if (impl_->running) {
+        return;
+    }
+    impl_->running = true;
+    const size_t threads = std::max<size_t>(impl_->config.io_threads, 1);
+    for (size_t i = 0; i < threads; ++i) {
+        Impl* impl = impl_.get();
+        impl_->threads.emplace_back([impl]() {
+            while (true) {
+                try {
+                    impl->io.run();
+                    return;
+                } catch (const std::exception& e) {
+                    LOG_ERROR("[FeedServer] io thread handler failed: {}", e.what());
+                }
+            }
+        });
+    }
+}
+
+void SyntheticFeedServer::stop() {
+    if (!impl_->running) {
+        return;
+    }
+    impl_->running = false;
+    Impl* impl = impl_.get();
+    boost::asio::post(impl->io, [impl]() {
+        websocketpp::lib::error_code ec;
+        impl->server.stop_listening(ec);
+        std::vector<std::shared_ptr<Stream>> open;
+        {
+            std::lock_guard<std::mutex> lock(impl->mutex);
+            for (const auto& entry : impl->streams) {
+                open.push_back(entry.second);
+            }
+        }
+        for (const auto& stream : open) {
+            boost::asio::post(stream->strand, [impl, stream]() {
+                stream->closed = true;
+                stream->timer.cancel();
+                websocketpp::lib::error_code close_ec;
+                impl->server.close(stream->hdl, websocketpp::close::status::going_away, "", close_ec);
+            });
+        }
+        impl->work.reset();
+    });
+    for (auto& thread : impl_->threads) {
+        thread.join();
+    }
+    impl_->threads.clear();
+}
+
+FeedServerStats SyntheticFeedServer::stats() const {
+    FeedServerStats stats;
+    stats.connections = impl_->connections.load(std::memory_order_relaxed);
+    stats.rejected = impl_->rejected.load(std::memory_order_relaxed);
+    stats.messages = impl_->messages.load(std::memory_order_relaxed);
+    stats.bytes = impl_->bytes.load(std::memory_order_relaxed);
+    stats.compressed_bytes = impl_->compressed_bytes.load(std::memory_order_relaxed);
+    stats.throttled = impl_->throttled.load(std::memory_order_relaxed);
+    return stats;
+}
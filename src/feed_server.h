@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include "synthetic_feed.h"
+
+struct FeedServerConfig {
+    SyntheticFeedConfig feed;
+    size_t symbols = 1;                   // streams SYN-0 .. SYN-<symbols-1>
+    double rate = 10000.0;                // messages/s per connection; 0 = as fast as the socket drains
+    size_t burst = 1;                     // back-to-back messages per send (see FeedPacer)
+    uint64_t max_messages = 0;            // per connection, then a normal close; 0 = unlimited
+    size_t max_buffered_bytes = 8 << 20;  // stop queueing on a connection that has this much unsent
+    size_t io_threads = 1;
+    // Serve a capture (see feed_capture.h) instead of the generator, to every
+    // connection whatever its path; paced by `rate`, or by the recorded gaps when rate is 0
+    std::string replay_path;
+    bool replay_loop = false;
+    // Deflate every payload into a binary frame (venue-style raw deflate
+    // framing). permessage-deflate needs no setting: it is accepted whenever
+    // the client offers it.
+    bool raw_deflate = false;
+    int deflate_level = -1;               // zlib level for raw_deflate; -1 = zlib default
+};
+
+struct FeedServerStats {
+    uint64_t connections = 0;   // accepted so far
+    uint64_t rejected = 0;      // unknown symbol or unreadable capture
+    uint64_t messages = 0;
+    uint64_t bytes = 0;                 // payload bytes, before any compression
+    uint64_t compressed_bytes = 0;      // raw deflate frames as sent
+    uint64_t throttled = 0;     // ticks that found a connection's send buffer full
+};
+
+// Local WebSocket exchange stand-in for end-to-end load tests.
+//
+// A client connects to any path ending in a synthetic symbol, such as
+// ws://127.0.0.1:<port>/ws/l2-orderbook/okx/SYN-3, and receives a stream for
+// that symbol. Every connection gets its own generator, seeded from the
+// config and the symbol, so each stream is byte-identical from run to run.
+// Each stream sends on an asio timer at `rate`, in bursts of `burst`.
+// Subscribe requests are accepted and ignored.
+//
+// A client slower than the rate is not dropped. Sending stops while more
+// than max_buffered_bytes is unsent and the backlog is caught up later. The
+// content stays the same; only the timing slips.
+class SyntheticFeedServer {
+public:
+    explicit SyntheticFeedServer(const FeedServerConfig& config = FeedServerConfig());
+    ~SyntheticFeedServer();
+
+    SyntheticFeedServer(const SyntheticFeedServer&) = delete;
+    SyntheticFeedServer& operator=(const SyntheticFeedServer&) = delete;
+
+    // Bind to loopback (port 0 = ephemeral); returns the bound port or 0 on failure
+    uint16_t listen(uint16_t port = 0, bool any_address = false);
+    void start();
+    void stop();   // closes every connection and joins the io threads
+
+    FeedServerStats stats() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
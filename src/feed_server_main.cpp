@@ -0,0 +1,139 @@
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include "feed_server.h"
+#include "logger.h"
+
+// Local synthetic exchange feed. Point the simulator or a load test at
+// ws://127.0.0.1:<port>/ws/l2-orderbook/okx/SYN-<n>
+namespace {
+
+std::atomic<bool> interrupted{false};
+
+void on_signal(int) {
+    interrupted = true;
+}
+
+void print_usage() {
+    std::cout << "Usage: feed_server [options]\n"
+                 "  --port <n>            listen port (default 8765)\n"
+                 "  --any                 listen on all interfaces instead of loopback\n"
+                 "  --symbols <n>         synthetic symbols SYN-0 .. SYN-<n-1> (default 1)\n"
+                 "  --rate <msgs/s>       per connection; 0 = unpaced (default 10000)\n"
+                 "  --burst <n>           messages sent back to back per burst (default 1)\n"
+                 "  --depth <n>           levels per side (default 50)\n"
+                 "  --levels <n>          resized levels per delta (default 4)\n"
+                 "  --snapshot-every <n>  deltas between snapshots; 0 = first message only\n"
+                 "  --min-bytes <n>       pad payloads to at least n bytes\n"
+                 "  --format flat|okx     payload shape (default flat)\n"
+                 "  --seed <n>            generator seed (default 1)\n"
+                 "  --messages <n>        close each connection after n messages\n"
+                 "  --threads <n>         io threads (default 1)\n"
+                 "  --replay <file>       serve a capture instead; recorded gaps unless --rate is given\n"
+                 "  --loop                restart the capture when it ends\n"
+                 "  --raw-deflate         send each payload as a raw deflate binary frame\n"
+                 "  --deflate-level <n>   zlib level for --raw-deflate (default: zlib's)\n"
+                 "                        (permessage-deflate is accepted whenever a client offers it)\n"
+                 "  --duration <s>        exit after s seconds (default: until interrupted)\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    FeedServerConfig config;
+    uint16_t port = 8765;
+    bool any_address = false;
+    bool rate_given = false;
+    double duration_s = 0.0;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (arg == "--help" || arg == "-h") {
+            print_usage();
+            return 0;
+        } else if (arg == "--any") {
+            any_address = true;
+        } else if (arg == "--loop") {
+            config.replay_loop = true;
+        } else if (arg == "--raw-deflate") {
+            config.raw_deflate = true;
+        } else if (!has_value) {
+            std::cerr << "Missing value for " << arg << std::endl;
+            print_usage();
+            return 1;
+        } else {
+            const std::string value = argv[++i];
+            if (arg == "--port") port = static_cast<uint16_t>(std::atoi(value.c_str()));
+            else if (arg == "--symbols") config.symbols = std::strtoull(value.c_str(), nullptr, 10);
+            else if (arg == "--rate") { config.rate = std::atof(value.c_str()); rate_given = true; }
+            else if (arg == "--burst") config.burst = std::strtoull(value.c_str(), nullptr, 10);
+            else if (arg == "--depth") config.feed.depth = std::strtoull(value.c_str(), nullptr, 10);
+            else if (arg == "--levels") config.feed.levels_per_update = std::strtoull(value.c_str(), nullptr, 10);
+            else if (arg == "--snapshot-every") config.feed.snapshot_every = std::strtoull(value.c_str(), nullptr, 10);
+            else if (arg == "--min-bytes") config.feed.min_message_bytes = std::strtoull(value.c_str(), nullptr, 10);
+            else if (arg == "--format") config.feed.format = value == "okx" ? SyntheticFeedFormat::Okx : SyntheticFeedFormat::Flat;
+            else if (arg == "--seed") config.feed.seed = std::strtoull(value.c_str(), nullptr, 10);
+            else if (arg == "--messages") config.max_messages = std::strtoull(value.c_str(), nullptr, 10);
+            else if (arg == "--threads") config.io_threads = std::strtoull(value.c_str(), nullptr, 10);
+            else if (arg == "--replay") config.replay_path = value;
+            else if (arg == "--deflate-level") config.deflate_level = std::atoi(value.c_str());
+            else if (arg == "--duration") duration_s = std::atof(value.c_str());
+            else {
+                std::cerr << "Unknown option " << arg << std::endl;
+                print_usage();
+                return 1;
+            }
+        }
+    }
+    if (!config.replay_path.empty() && !rate_given) {
+        config.rate = 0.0;   // replay keeps the recorded gaps
+    }
+
+    Logger::instance().start();
+    SyntheticFeedServer server(config);
+    const uint16_t bound = server.listen(port, any_address);
+    if (bound == 0) {
+        Logger::instance().stop();
+        return 1;
+    }
+    server.start();
+    std::signal(SIGINT, on_signal);
+    std::signal(SIGTERM, on_signal);
+
+    std::cout << "Synthetic feed on ws://" << (any_address ? "0.0.0.0" : "127.0.0.1") << ":" << bound
+              << "/ws/l2-orderbook/okx/SYN-<0.." << (config.symbols > 0 ? config.symbols - 1 : 0) << ">";
+    if (!config.replay_path.empty()) {
+        std::cout << " replaying " << config.replay_path;
+    }
+    std::cout << std::endl;
+
+    // One stats line per second
+    const auto start = std::chrono::steady_clock::now();
+    FeedServerStats last = server.stats();
+    while (!interrupted) {
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+        const FeedServerStats now = server.stats();
+        std::cout << "connections " << now.connections
+                  << "  msgs/s " << (now.messages - last.messages)
+                  << "  MB/s " << (now.bytes - last.bytes) / 1e6;
+        if (config.raw_deflate) {
+            std::cout << "  deflated MB/s " << (now.compressed_bytes - last.compressed_bytes) / 1e6;
+        }
+        std::cout << "  throttled " << (now.throttled - last.throttled)
+                  << "  total " << now.messages << std::endl;
+        last = now;
+        const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (duration_s > 0.0 && elapsed >= duration_s) {
+            break;
+        }
+    }
+
+    server.stop();
+    Logger::instance().stop();
+    return 0;
+}
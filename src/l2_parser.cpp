@@ -0,0 +1,413 @@
+#include "l2_parser.h"
+#include "latency_histogram.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <string_view>
+
+namespace {
+
+const double kPow10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+// Minimal in-place JSON scanner over [pos, end)
+class Scanner {
+public:
+    Scanner(const char* begin, const char* end) : pos_(begin), end_(end) {}
+
+    void skip_ws() {
+        while (pos_ < end_ && (*pos_ == ' ' || *pos_ == '\n' || *pos_ == '\r' || *pos_ == '\t')) ++pos_;
+    }
+
+    bool consume(char c) {
+        skip_ws();
+        if (pos_ < end_ && *pos_ == c) {
+            ++pos_;
+            return true;
+        }
+        return false;
+    }
+
+    bool peek(char c) {
+        skip_ws();
+        return pos_ < end_ && *pos_ == c;
+    }
+
+    bool at_end() {
+        skip_ws();
+        return pos_ >= end_;
+    }
+
+    // String contents without the quotes; escapes are left as-is
+    bool string(const char*& begin, const char*& finish) {
+        if (!consume('"')) return false;
+        begin = pos_;
+        while (pos_ < end_ && *pos_ != '"') {
+            if (*pos_ == '\\') ++pos_;
+            ++pos_;
+        }
+        if (pos_ >= end_) return false;
+        finish = pos_++;
+        return true;
+    }
+
+    // A number either bare or quoted, as exchanges send both
+    bool number(double& value) {
+        skip_ws();
+        const char* begin;
+        const char* finish;
+        if (pos_ < end_ && *pos_ == '"') {
+            if (!string(begin, finish)) return false;
+        } else {
+            begin = pos_;
+            while (pos_ < end_ && is_number_char(*pos_)) ++pos_;
+            finish = pos_;
+        }
+        return parse_decimal(begin, finish, value);
+    }
+
+    // A string's contents or a bare number/literal, without the quotes
+    bool scalar(const char*& begin, const char*& finish) {
+        skip_ws();
+        if (pos_ < end_ && *pos_ == '"') return string(begin, finish);
+        begin = pos_;
+        while (pos_ < end_ && *pos_ != ',' && *pos_ != '}' && *pos_ != ']' &&
+               *pos_ != ' ' && *pos_ != '\n' && *pos_ != '\r' && *pos_ != '\t') ++pos_;
+        finish = pos_;
+        return pos_ > begin;
+    }
+
+    bool skip_value() {
+        skip_ws();
+        if (pos_ >= end_) return false;
+        const char c = *pos_;
+        if (c == '"') {
+            const char* b;
+            const char* f;
+            return string(b, f);
+        }
+        if (c == '{' || c == '[') {
+            int depth = 0;
+            while (pos_ < end_) {
+                const char d = *pos_;
+                if (d == '"') {
+                    const char* b;
+                    const char* f;
+                    if (!string(b, f)) return false;
+                    continue;
+                }
+                ++pos_;
+                if (d == '{' || d == '[') ++depth;
+                else if (d == '}' || d == ']') {
+                    if (--depth == 0) return true;
+                }
+            }
+            return false;
+        }
+        // number, true, false, null
+        const char* b;
+        const char* f;
+        return scalar(b, f);
+    }
+
+private:
+    static bool is_number_char(char c) {
+        return (c >= '0' && c <= '9') || c == '.' || c == '-' || c == '+' || c == 'e' || c == 'E';
+    }
+
+    const char* pos_;
+    const char* end_;
+};
+
+bool key_equals(const char* begin, const char* end, const char* key) {
+    const size_t n = std::strlen(key);
+    return static_cast<size_t>(end - begin) == n && std::memcmp(begin, key, n) == 0;
+}
+
+// Fixed-width decimal field; false unless all n characters are digits
+bool fixed_digits(const char*& p, const char* end, int n, int& value) {
+    value = 0;
+    for (int i = 0; i < n; ++i, ++p) {
+        if (p >= end || *p < '0' || *p > '9') return false;
+        value = value * 10 + (*p - '0');
+    }
+    return true;
+}
+
+// Days since 1970-01-01 of a proleptic Gregorian date (H. Hinnant's days_from_civil)
+int64_t days_from_civil(int64_t y, int m, int d) {
+    y -= m <= 2;
+    const int64_t era = (y >= 0 ? y : y - 399) / 400;
+    const int64_t yoe = y - era * 400;
+    const int64_t doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    const int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+// YYYY-MM-DDTHH:MM:SS[.fraction][Z|+HH:MM|-HH:MM]
+bool parse_iso8601(const char* p, const char* end, int64_t& ts_ns) {
+    int year, month, day, hour, minute, second;
+    if (!fixed_digits(p, end, 4, year) || p >= end || *p++ != '-' || !fixed_digits(p, end, 2, month) || p >= end ||
+        *p++ != '-' || !fixed_digits(p, end, 2, day) || p >= end || (*p != 'T' && *p != ' ')) {
+        return false;
+    }
+    ++p;
+    if (!fixed_digits(p, end, 2, hour) || p >= end || *p++ != ':' || !fixed_digits(p, end, 2, minute) || p >= end ||
+        *p++ != ':' || !fixed_digits(p, end, 2, second)) {
+        return false;
+    }
+    if (month < 1 || month > 12 || day < 1 || day > 31 || hour > 23 || minute > 59 || second > 60) {
+        return false;
+    }
+    int64_t fraction_ns = 0;
+    if (p < end && *p == '.') {
+        int64_t scale = 100000000;
+        for (++p; p < end && *p >= '0' && *p <= '9'; ++p) {
+            fraction_ns += (*p - '0') * scale;
+            scale /= 10;   // digits past ns resolution add nothing
+        }
+    }
+    int64_t offset_s = 0;
+    if (p < end && (*p == '+' || *p == '-')) {
+        const int64_t sign = *p++ == '-' ? -1 : 1;
+        int offset_h, offset_m = 0;
+        if (!fixed_digits(p, end, 2, offset_h)) return false;
+        if (p < end && *p == ':') ++p;
+        if (p < end && !fixed_digits(p, end, 2, offset_m)) return false;
+        offset_s = sign * (offset_h * 3600 + offset_m * 60);
+    } else if (p < end && *p == 'Z') {
+        ++p;
+    }
+    if (p != end) return false;
+    const int64_t seconds = days_from_civil(year, month, day) * 86400 + hour * 3600 + minute * 60 + second - offset_s;
+    ts_ns = seconds * 1000000000 + fraction_ns;
+    return true;
+}
+
+enum class Status { Ok, Unsupported, Malformed };
+
+// [[price, size, ...], ...]
+Status parse_levels(Scanner& s, OrderLevel* levels, size_t& count) {
+    count = 0;
+    if (!s.consume('[')) return Status::Malformed;
+    if (s.consume(']')) return Status::Ok;
+    do {
+        if (count == L2Message::kMaxLevels) return Status::Unsupported;
+        if (!s.consume('[')) return Status::Malformed;
+        OrderLevel& level = levels[count++];
+        if (!s.number(level.price) || !s.consume(',') || !s.number(level.quantity)) return Status::Malformed;
+        // Remaining fields (liquidated orders, order count) are ignored
+        while (s.consume(',')) {
+            if (!s.skip_value()) return Status::Malformed;
+        }
+        if (!s.consume(']')) return Status::Malformed;
+    } while (s.consume(','));
+    return s.consume(']') ? Status::Ok : Status::Malformed;
+}
+
+// Object holding "asks"/"bids" (either the top level or a "data" element)
+Status parse_book_object(Scanner& s, L2Message& out, bool top_level, bool& has_book) {
+    if (!s.consume('{')) return Status::Malformed;
+    if (s.consume('}')) return Status::Ok;
+    do {
+        const char* key;
+        const char* key_end;
+        if (!s.string(key, key_end) || !s.consume(':')) return Status::Malformed;
+
+        Status status = Status::Ok;
+        if (key_equals(key, key_end, "asks")) {
+            status = parse_levels(s, out.asks, out.ask_count);
+            has_book = true;
+        } else if (key_equals(key, key_end, "bids")) {
+            status = parse_levels(s, out.bids, out.bid_count);
+            has_book = true;
+        } else if (top_level && key_equals(key, key_end, "action")) {
+            const char* value;
+            const char* value_end;
+            if (!s.string(value, value_end)) return Status::Malformed;
+            if (key_equals(value, value_end, "update")) out.action = L2Message::Action::Update;
+            else if (!key_equals(value, value_end, "snapshot")) return Status::Unsupported;
+        } else if (key_equals(key, key_end, "ts") || key_equals(key, key_end, "timestamp")) {
+            const char* value;
+            const char* value_end;
+            if (!s.scalar(value, value_end)) return Status::Malformed;
+            int64_t ts_ns;
+            if (parse_exchange_timestamp(value, value_end, ts_ns)) out.exchange_ts_ns = ts_ns;
+        } else if (top_level && key_equals(key, key_end, "data")) {
+            if (!s.consume('[')) return Status::Unsupported;
+            if (!s.peek(']')) {
+                status = parse_book_object(s, out, false, has_book);
+                // Several books in one message: leave it to the DOM path
+                if (status == Status::Ok && s.peek(',')) return Status::Unsupported;
+            }
+            if (status == Status::Ok && !s.consume(']')) return Status::Malformed;
+        } else if (!s.skip_value()) {
+            return Status::Malformed;
+        }
+
+        if (status != Status::Ok) return status;
+    } while (s.consume(','));
+    return s.consume('}') ? Status::Ok : Status::Malformed;
+}
+
+} // namespace
+
+bool parse_decimal(const char* begin, const char* end, double& value) {
+    const char* p = begin;
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) negative = *p++ == '-';
+
+    uint64_t mantissa = 0;
+    int digits = 0;
+    int exponent = 0;
+    bool any_digit = false;
+
+    for (; p < end && *p >= '0' && *p <= '9'; ++p, any_digit = true) {
+        if (digits < 19) {
+            mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+            if (mantissa != 0) ++digits;
+        } else {
+            ++exponent;
+        }
+    }
+    if (p < end && *p == '.') {
+        for (++p; p < end && *p >= '0' && *p <= '9'; ++p, any_digit = true) {
+            if (digits < 19) {
+                mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+                if (mantissa != 0) ++digits;
+                --exponent;
+            }
+        }
+    }
+    if (!any_digit) return false;
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        ++p;
+        bool exp_negative = false;
+        if (p < end && (*p == '-' || *p == '+')) exp_negative = *p++ == '-';
+        int e = 0;
+        if (p >= end || *p < '0' || *p > '9') return false;
+        for (; p < end && *p >= '0' && *p <= '9'; ++p) {
+            if (e < 10000) e = e * 10 + (*p - '0');
+        }
+        exponent += exp_negative ? -e : e;
+    }
+    if (p != end) return false;
+
+    // Clinger's fast path: both operands exactly representable, one rounding
+    if (digits <= 15 && exponent >= -22 && exponent <= 22) {
+        double result = static_cast<double>(mantissa);
+        result = exponent < 0 ? result / kPow10[-exponent] : result * kPow10[exponent];
+        value = negative ? -result : result;
+        return true;
+    }
+
+    char buffer[64];
+    const size_t length = static_cast<size_t>(end - begin);
+    if (length >= sizeof(buffer)) return false;
+    std::memcpy(buffer, begin, length);
+    buffer[length] = '\0';
+    value = std::strtod(buffer, nullptr);
+    return true;
+}
+
+bool parse_exchange_timestamp(const char* begin, const char* end, int64_t& ts_ns) {
+    if (begin >= end) return false;
+    if (end - begin > 19 || std::find_if(begin, end, [](char c) { return c < '0' || c > '9'; }) != end) {
+        return parse_iso8601(begin, end, ts_ns);
+    }
+    int64_t value = 0;
+    for (const char* p = begin; p < end; ++p) {
+        value = value * 10 + (*p - '0');
+    }
+    // Epoch seconds have 10 digits, ms 13, us 16, ns 19
+    if (value < 100000000000LL) ts_ns = value * 1000000000;
+    else if (value < 100000000000000LL) ts_ns = value * 1000000;
+    else if (value < 100000000000000000LL) ts_ns = value * 1000;
+    else ts_ns = value;
+    return true;
+}
+
+bool find_exchange_timestamp(const char* data, size_t size, int64_t& ts_ns) {
+    const std::string_view payload(data, size);
+    for (const std::string_view key : {std::string_view("\"ts\""), std::string_view("\"timestamp\"")}) {
+        const size_t pos = payload.find(key);
+        if (pos == std::string_view::npos) continue;
+        Scanner s(data + pos + key.size(), data + size);
+        const char* value;
+        const char* value_end;
+        if (s.consume(':') && s.scalar(value, value_end) && parse_exchange_timestamp(value, value_end, ts_ns)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+L2ParseResult parse_l2_message(const char* data, size_t size, L2Message& out) {
+    out.action = L2Message::Action::Snapshot;
+    out.exchange_ts_ns = 0;
+    out.ask_count = 0;
+    out.bid_count = 0;
+
+    Scanner s(data, data + size);
+    bool has_book = false;
+    const Status status = parse_book_object(s, out, true, has_book);
+
+    if (status == Status::Malformed || (status == Status::Ok && !s.at_end())) return L2ParseResult::Malformed;
+    if (status == Status::Unsupported) return L2ParseResult::Unsupported;
+    return has_book ? L2ParseResult::Ok : L2ParseResult::NoBook;
+}
+
+L2PayloadKind classify_l2_payload(const char* data, size_t size) {
+    const std::string_view payload(data, size);
+    if (payload.find("\"asks\"") == std::string_view::npos && payload.find("\"bids\"") == std::string_view::npos) {
+        return L2PayloadKind::Other;
+    }
+    size_t pos = payload.find("\"action\"");
+    if (pos == std::string_view::npos) {
+        return L2PayloadKind::Snapshot;
+    }
+    pos += 8;
+    while (pos < size && (payload[pos] == ' ' || payload[pos] == ':' || payload[pos] == '\t' || payload[pos] == '\n' || payload[pos] == '\r')) {
+        ++pos;
+    }
+    return payload.compare(pos, 8, "\"update\"") == 0 ? L2PayloadKind::Update : L2PayloadKind::Snapshot;
+}
+
+int64_t apply_l2_payload(OrderBook& book, const char* data, size_t size) {
+    thread_local L2Message message;
+    LatencyMonitor& latency = LatencyMonitor::instance();
+
+    const int64_t start_ns = LatencyMonitor::now_ns();
+    const L2ParseResult result = parse_l2_message(data, size, message);
+    int64_t parsed_ns = LatencyMonitor::now_ns();
+    int64_t exchange_ts_ns = message.exchange_ts_ns;
+
+    switch (result) {
+    case L2ParseResult::Ok:
+        latency.record(LatencyStage::Parse, parsed_ns - start_ns);
+        book.apply(message);
+        break;
+    case L2ParseResult::NoBook:
+        return 0;
+    case L2ParseResult::Unsupported:
+    case L2ParseResult::Malformed: {
+        // DOM path: handles the unusual shapes and reports parse errors
+        nlohmann::json document = nlohmann::json::parse(data, data + size);
+        if (!find_exchange_timestamp(data, size, exchange_ts_ns)) {
+            exchange_ts_ns = 0;
+        }
+        parsed_ns = LatencyMonitor::now_ns();
+        latency.record(LatencyStage::Parse, parsed_ns - start_ns);
+        book.update_from_json(document);
+        break;
+    }
+    }
+    latency.record(LatencyStage::Apply, LatencyMonitor::now_ns() - parsed_ns);
+    return exchange_ts_ns;
+}
+
+int64_t apply_l2_payload(OrderBook& book, const std::string& payload) {
+    return apply_l2_payload(book, payload.data(), payload.size());
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "orderbook.h"
+
+// Streaming parser for the exchange L2 schema.
+//
+// Scans the payload in place and writes levels into a fixed-capacity
+// L2Message, so a parse never touches the heap. Handles both the flat
+// full-depth shape ({"asks": [...], "bids": [...]}) and the OKX envelope
+// ({"action": ..., "data": [{"asks": ..., "bids": ...}]}). Anything else is
+// reported as Unsupported so callers can fall back to the nlohmann DOM path.
+
+struct L2Message {
+    static constexpr size_t kMaxLevels = BookSnapshot::kMaxDepth;
+
+    enum class Action { Snapshot, Update };
+
+    Action action = Action::Snapshot;
+    int64_t exchange_ts_ns = 0;   // "ts" or "timestamp" field, ns since the epoch; 0 if absent
+    size_t ask_count = 0;
+    size_t bid_count = 0;
+    OrderLevel asks[kMaxLevels];
+    OrderLevel bids[kMaxLevels];
+};
+
+enum class L2ParseResult {
+    Ok,            // levels written to the message
+    NoBook,        // well-formed message without book data (acks, heartbeats)
+    Unsupported,   // shape the fast path does not handle; use the DOM parser
+    Malformed      // not valid JSON
+};
+
+L2ParseResult parse_l2_message(const char* data, size_t size, L2Message& out);
+
+// Decimal string to double without allocation. Exact for up to 15
+// significant digits (every price/size we see), strtod on a stack buffer otherwise.
+bool parse_decimal(const char* begin, const char* end, double& value);
+
+// Exchange timestamp to ns since the Unix epoch, without allocation. Takes
+// integer epoch seconds, ms, us or ns (told apart by magnitude) and
+// ISO 8601 UTC times such as 2025-05-04T10:39:13.250Z or ...+01:00.
+bool parse_exchange_timestamp(const char* begin, const char* end, int64_t& ts_ns);
+// First "ts" or "timestamp" value in a payload, by substring scan
+bool find_exchange_timestamp(const char* data, size_t size, int64_t& ts_ns);
+
+// What a payload carries, from a substring scan that parses no levels. Lets
+// the network thread hold back deltas after a reconnect until the next
+// snapshot arrives. Book data without an "update" action counts as a snapshot.
+enum class L2PayloadKind { Snapshot, Update, Other };
+L2PayloadKind classify_l2_payload(const char* data, size_t size);
+
+// Apply a raw payload to the book: fast path first, DOM fallback for
+// unsupported shapes. Throws like nlohmann::json::parse on invalid input.
+// Returns the payload's exchange timestamp (ns since the epoch), 0 if it has none.
+int64_t apply_l2_payload(OrderBook& book, const char* data, size_t size);
+int64_t apply_l2_payload(OrderBook& book, const std::string& payload);
@@ -0,0 +1,158 @@
+#include "latency_histogram.h"
+#include "logger.h"
+#include <algorithm>
+#include <cmath>
+
+LatencyHistogram::LatencyHistogram()
+    : counts_(new std::atomic<uint64_t>[kBucketCount]), total_(0), sum_(0), max_(0) {
+    for (size_t i = 0; i < kBucketCount; ++i) {
+        counts_[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    for (size_t i = 0; i < kBucketCount; ++i) {
+        const uint64_t count = other.counts_[i].load(std::memory_order_relaxed);
+        if (count > 0) {
+            counts_[i].fetch_add(count, std::memory_order_relaxed);
+        }
+    }
+    total_.fetch_add(other.total_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    sum_.fetch_add(other.sum_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    const int64_t other_max = other.max_.load(std::memory_order_relaxed);
+    int64_t max = max_.load(std::memory_order_relaxed);
+    while (other_max > max && !max_.compare_exchange_weak(max, other_max, std::memory_order_relaxed)) {}
+}
+
+void LatencyHistogram::reset() {
+    for (size_t i = 0; i < kBucketCount; ++i) {
+        counts_[i].store(0, std::memory_order_relaxed);
+    }
+    total_.store(0, std::memory_order_relaxed);
+    sum_.store(0, std::memory_order_relaxed);
+    max_.store(0, std::memory_order_relaxed);
+}
+
+int64_t LatencyHistogram::bucket_upper_bound(size_t index) {
+    if (index < static_cast<size_t>(kSubBucketCount)) {
+        return static_cast<int64_t>(index);
+    }
+    const size_t offset = index - kSubBucketCount;
+    const int exponent = kSubBucketBits + static_cast<int>(offset / kHalfSubBucketCount);
+    const uint64_t sub_bucket = kHalfSubBucketCount + offset % kHalfSubBucketCount;
+    const int shift = exponent - (kSubBucketBits - 1);
+    return static_cast<int64_t>(((sub_bucket + 1) << shift) - 1);
+}
+
+int64_t LatencyHistogram::value_at_percentile(double percentile) const {
+    // Bucket counts are read one at a time, so while other threads record the
+    // walk can see slightly more samples than the total read up front
+    const uint64_t total = count();
+    if (total == 0) {
+        return 0;
+    }
+    const double fraction = std::min(std::max(percentile, 0.0), 100.0) / 100.0;
+    const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(fraction * total)));
+    const int64_t max_value = max();
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBucketCount; ++i) {
+        seen += counts_[i].load(std::memory_order_relaxed);
+        if (seen >= rank) {
+            return std::min(bucket_upper_bound(i), max_value);
+        }
+    }
+    return max_value;
+}
+
+LatencySummary LatencyHistogram::summary() const {
+    LatencySummary summary;
+    summary.count = count();
+    if (summary.count == 0) {
+        return summary;
+    }
+    summary.mean_ns = static_cast<double>(sum_.load(std::memory_order_relaxed)) / summary.count;
+    summary.p50_ns = value_at_percentile(50.0);
+    summary.p99_ns = value_at_percentile(99.0);
+    summary.p999_ns = value_at_percentile(99.9);
+    summary.max_ns = max();
+    return summary;
+}
+
+const char* latency_stage_name(LatencyStage stage) {
+    switch (stage) {
+    case LatencyStage::Receive: return "receive";
+    case LatencyStage::Queue: return "queue";
+    case LatencyStage::Parse: return "parse";
+    case LatencyStage::Apply: return "apply";
+    case LatencyStage::Model: return "model";
+    case LatencyStage::Render: return "render";
+    case LatencyStage::Handshake: return "handshake";
+    case LatencyStage::Reconnect: return "reconnect";
+    case LatencyStage::Exchange: return "exchange";
+    default: return "unknown";
+    }
+}
+
+LatencyMonitor& LatencyMonitor::instance() {
+    static LatencyMonitor monitor;
+    return monitor;
+}
+
+LatencyMonitor::LatencyMonitor() : last_report_ns_(now_ns()) {}
+
+LatencyHistogram* LatencyMonitor::thread_histograms() {
+    // Owned by the monitor so samples outlive the thread that recorded them
+    thread_local LatencyHistogram* histograms = nullptr;
+    if (!histograms) {
+        std::unique_ptr<LatencyHistogram[]> created(new LatencyHistogram[kStageCount]);
+        histograms = created.get();
+        std::lock_guard<std::mutex> lock(threads_mutex_);
+        threads_.push_back(std::move(created));
+    }
+    return histograms;
+}
+
+void LatencyMonitor::merge_into(LatencyStage stage, LatencyHistogram& out) const {
+    std::lock_guard<std::mutex> lock(threads_mutex_);
+    for (const auto& histograms : threads_) {
+        out.merge(histograms[static_cast<size_t>(stage)]);
+    }
+}
+
+LatencySummary LatencyMonitor::summary(LatencyStage stage) const {
+    LatencyHistogram merged;
+    merge_into(stage, merged);
+    return merged.summary();
+}
+
+void LatencyMonitor::reset() {
+    std::lock_guard<std::mutex> lock(threads_mutex_);
+    for (auto& histograms : threads_) {
+        for (size_t stage = 0; stage < kStageCount; ++stage) {
+            histograms[stage].reset();
+        }
+    }
+}
+
+void LatencyMonitor::report() const {
+    for (size_t i = 0; i < kStageCount; ++i) {
+        const LatencyStage stage = static_cast<LatencyStage>(i);
+        const LatencySummary s = summary(stage);
+        if (s.count == 0) {
+            continue;
+        }
+        LOG_INFO("[Latency] {} n={} p50={}us p99={}us p99.9={}us max={}us", latency_stage_name(stage), s.count,
+                 s.p50_ns / 1000.0, s.p99_ns / 1000.0, s.p999_ns / 1000.0, s.max_ns / 1000.0);
+    }
+}
+
+bool LatencyMonitor::report_if_due(int64_t interval_ns) {
+    const int64_t now = now_ns();
+    if (now - last_report_ns_ < interval_ns) {
+        return false;
+    }
+    last_report_ns_ = now;
+    report();
+    return true;
+}
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#ifndef _WIN32
+#include <time.h>
+#endif
+
+// HDR-style latency histograms for the feed -> book -> model -> UI pipeline.
+//
+// Buckets are log-linear: values below 64 ns are exact, and every power of
+// two above that is split into 32 sub-buckets, so any recorded value is
+// reported within ~3% over the full nanosecond-to-hours range. Each
+// histogram has a single writer, so recording is an index computation and a
+// few relaxed loads and stores with no locked instructions; percentiles are
+// read by walking the bucket counts.
+
+struct LatencySummary {
+    uint64_t count = 0;
+    double mean_ns = 0.0;
+    int64_t p50_ns = 0;
+    int64_t p99_ns = 0;
+    int64_t p999_ns = 0;
+    int64_t max_ns = 0;
+};
+
+class LatencyHistogram {
+public:
+    static constexpr int kSubBucketBits = 6;
+    static constexpr int64_t kSubBucketCount = int64_t(1) << kSubBucketBits;   // 64
+    static constexpr int64_t kHalfSubBucketCount = kSubBucketCount / 2;          // 32
+    static constexpr int kMaxExponent = 62;
+    static constexpr size_t kBucketCount =
+        kSubBucketCount + (kMaxExponent - kSubBucketBits + 1) * kHalfSubBucketCount;
+
+    LatencyHistogram();
+
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    // Single writer (LatencyMonitor gives each thread its own); any thread
+    // may read or merge() concurrently. Negative values count as zero.
+    void record(int64_t value_ns) {
+        const int64_t value = value_ns > 0 ? value_ns : 0;
+        std::atomic<uint64_t>& bucket = counts_[bucket_index(value)];
+        bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        total_.store(total_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        sum_.store(sum_.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+        if (value > max_.load(std::memory_order_relaxed)) {
+            max_.store(value, std::memory_order_relaxed);
+        }
+    }
+
+    // Add another histogram's counts into this one (other may still be
+    // recording). Uses atomic RMWs, so several threads may merge into the
+    // same target.
+    void merge(const LatencyHistogram& other);
+    // Not synchronized with the writer: a record racing a reset can bring
+    // back part of the old counts
+    void reset();
+
+    uint64_t count() const { return total_.load(std::memory_order_relaxed); }
+    int64_t max() const { return max_.load(std::memory_order_relaxed); }
+
+    // Highest value equivalent to the bucket holding the given percentile (0-100)
+    int64_t value_at_percentile(double percentile) const;
+    LatencySummary summary() const;
+
+    static size_t bucket_index(int64_t value) {
+        if (value < kSubBucketCount) {
+            return static_cast<size_t>(value);
+        }
+        const int exponent = static_cast<int>(highest_bit(static_cast<uint64_t>(value)));
+        const int shift = exponent - (kSubBucketBits - 1);
+        const int64_t sub_bucket = (value >> shift) - kHalfSubBucketCount;
+        return static_cast<size_t>(kSubBucketCount + (exponent - kSubBucketBits) * kHalfSubBucketCount + sub_bucket);
+    }
+
+    // Largest value that maps to the bucket
+    static int64_t bucket_upper_bound(size_t index);
+
+private:
+    static unsigned highest_bit(uint64_t word) {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanReverse64(&index, word);
+        return static_cast<unsigned>(index);
+#else
+        return 63u - static_cast<unsigned>(__builtin_clzll(word));
+#endif
+    }
+
+    std::unique_ptr<std::atomic<uint64_t>[]> counts_;
+    std::atomic<uint64_t> total_;
+    std::atomic<int64_t> sum_;
+    std::atomic<int64_t> max_;
+};
+
+enum class LatencyStage : int {
+    Receive,   // socket callback: payload copied into the book builder's ring
+    Queue,     // time spent waiting in the ring before the book builder picks it up
+    Parse,     // payload to L2Message (or DOM parse on the fallback path)
+    Apply,     // L2Message applied to the book and snapshot published
+    Model,     // cost model evaluation for the current order
+    Render,    // UI frame build
+    Handshake, // feed connect() to open: TCP, TLS and WebSocket handshakes
+    Reconnect, // feed drop to the next open, backoff included
+    Exchange,  // exchange timestamp to receive, net of the estimated clock offset (see feed_latency.h)
+    Count
+};
+
+const char* latency_stage_name(LatencyStage stage);
+
+// Process-wide per-stage histograms.
+//
+// Each recording thread gets its own set of histograms on first use, so the
+// record path never shares a cache line with another writer. Readers merge
+// the per-thread histograms on demand.
+class LatencyMonitor {
+public:
+    static constexpr size_t kStageCount = static_cast<size_t>(LatencyStage::Count);
+
+    static LatencyMonitor& instance();
+
+    static int64_t now_ns() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // Wall clock (ns since the Unix epoch), comparable with exchange timestamps
+    static int64_t wall_ns() {
+#ifdef _WIN32
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+#else
+        timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+#endif
+    }
+
+    void record(LatencyStage stage, int64_t value_ns) {
+        thread_histograms()[static_cast<size_t>(stage)].record(value_ns);
+    }
+
+    // Merge every thread's histogram for the stage into `out`
+    void merge_into(LatencyStage stage, LatencyHistogram& out) const;
+    LatencySummary summary(LatencyStage stage) const;
+    void reset();
+
+    // Log p50/p99/p99.9/max for every stage that has samples
+    void report() const;
+    // report() at most once per interval; call from a single thread
+    bool report_if_due(int64_t interval_ns);
+
+private:
+    LatencyMonitor();
+
+    LatencyHistogram* thread_histograms();
+
+    mutable std::mutex threads_mutex_;   // taken once per thread, on its first record
+    std::vector<std::unique_ptr<LatencyHistogram[]>> threads_;
+    int64_t last_report_ns_;
+};
+
+// Records the lifetime of the scope into a stage
+class ScopedLatency {
+public:
+    explicit ScopedLatency(LatencyStage stage) : stage_(stage), start_ns_(LatencyMonitor::now_ns()) {}
+    ~ScopedLatency() { LatencyMonitor::instance().record(stage_, LatencyMonitor::now_ns() - start_ns_); }
+
+    ScopedLatency(const ScopedLatency&) = delete;
+    ScopedLatency& operator=(const ScopedLatency&) = delete;
+
+private:
+    LatencyStage stage_;
+    int64_t start_ns_;
+};
@@ -0,0 +1,154 @@
+#include "logger.h"
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <ctime>
+
+std::atomic<int> Logger::level_(static_cast<int>(LogLevel::Info));
+
+namespace {
+
+const char* level_name(LogLevel level) {
+    switch (level) {
+    case LogLevel::Debug: return "DEBUG";
+    case LogLevel::Info: return "INFO";
+    case LogLevel::Warn: return "WARN";
+    case LogLevel::Error: return "ERROR";
+    default: return "";
+    }
+}
+
+} // namespace
+
+Logger& Logger::instance() {
+    static Logger logger;
+    return logger;
+}
+
+Logger::Logger() : ring_count_(0), dropped_(0), output_(stdout), running_(false) {}
+
+Logger::~Logger() {
+    stop();
+}
+
+void Logger::start(std::FILE* output) {
+    if (running_.exchange(true)) {
+        return;
+    }
+    output_ = output;
+    writer_ = std::thread([this]() { run(); });
+}
+
+void Logger::stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+    if (writer_.joinable()) {
+        writer_.join();
+    }
+}
+
+int64_t Logger::now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+void Logger::set_text(LogArg& arg, const char* value, size_t length) {
+    arg.type = LogArg::Type::Text;
+    if (length >= LogArg::kTextBytes) {
+        length = LogArg::kTextBytes - 1;
+    }
+    std::memcpy(arg.text, value, length);
+    arg.text[length] = '\0';
+}
+
+SpscRing<LogRecord>& Logger::thread_ring() {
+    thread_local SpscRing<LogRecord>* ring = nullptr;
+    if (!ring) {
+        // First log call on this thread: the logger keeps the ring alive past thread exit
+        auto owned = std::make_shared<SpscRing<LogRecord>>(kRingCapacity);
+        std::lock_guard<std::mutex> lock(rings_mutex_);
+        rings_.push_back(owned);
+        ring_count_.store(rings_.size(), std::memory_order_release);
+        ring = owned.get();
+    }
+    return *ring;
+}
+
+size_t Logger::format_record(const LogRecord& record, char* out, size_t size) {
+    const time_t seconds = static_cast<time_t>(record.ts_ns / 1000000000);
+    const long micros = static_cast<long>((record.ts_ns / 1000) % 1000000);
+    struct tm tm_buf;
+#ifdef _WIN32
+    gmtime_s(&tm_buf, &seconds);
+#else
+    gmtime_r(&seconds, &tm_buf);
+#endif
+    int n = std::snprintf(out, size, "%02d:%02d:%02d.%06ld [%s] ", tm_buf.tm_hour, tm_buf.tm_min,
+                          tm_buf.tm_sec, micros, level_name(record.level));
+    size_t used = n > 0 ? static_cast<size_t>(n) : 0;
+
+    size_t arg = 0;
+    for (const char* p = record.format; *p && used + 1 < size; ++p) {
+        if (p[0] == '{' && p[1] == '}' && arg < record.arg_count) {
+            const LogArg& a = record.args[arg++];
+            switch (a.type) {
+            case LogArg::Type::Int: n = std::snprintf(out + used, size - used, "%" PRId64, a.i); break;
+            case LogArg::Type::Uint: n = std::snprintf(out + used, size - used, "%" PRIu64, a.u); break;
+            case LogArg::Type::Double: n = std::snprintf(out + used, size - used, "%g", a.d); break;
+            case LogArg::Type::Text: n = std::snprintf(out + used, size - used, "%s", a.text); break;
+            }
+            used += n > 0 ? std::min(static_cast<size_t>(n), size - used - 1) : 0;
+            ++p;
+        } else {
+            out[used++] = *p;
+        }
+    }
+    if (used + 1 < size) {
+        out[used++] = '\n';
+    }
+    out[used] = '\0';
+    return used;
+}
+
+size_t Logger::drain(const std::vector<std::shared_ptr<SpscRing<LogRecord>>>& rings) {
+    char line[512];
+    size_t written = 0;
+    for (auto& ring : rings) {
+        LogRecord* record;
+        while ((record = ring->front()) != nullptr) {
+            const size_t length = format_record(*record, line, sizeof(line));
+            std::fwrite(line, 1, length, output_);
+            ring->pop();
+            ++written;
+        }
+    }
+    if (written > 0) {
+        std::fflush(output_);
+    }
+    return written;
+}
+
+void Logger::run() {
+    std::vector<std::shared_ptr<SpscRing<LogRecord>>> rings;
+
+    while (true) {
+        const bool running = running_.load(std::memory_order_relaxed);
+        if (ring_count_.load(std::memory_order_acquire) != rings.size()) {
+            std::lock_guard<std::mutex> lock(rings_mutex_);
+            rings = rings_;
+        }
+        if (drain(rings) == 0) {
+            if (!running) {
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    const uint64_t dropped = dropped_.load(std::memory_order_relaxed);
+    if (dropped > 0) {
+        std::fprintf(output_, "[Logger] %llu records dropped (ring full)\n", static_cast<unsigned long long>(dropped));
+        std::fflush(output_);
+    }
+}
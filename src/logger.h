@@ -0,0 +1,131 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "spsc_ring.h"
+
+// Asynchronous, low-overhead logging.
+//
+// Producers write fixed-size binary records (format pointer + typed
+// arguments) into a per-thread SPSC ring; a background thread formats and
+// writes them. Formats use "{}" placeholders and must be string literals.
+// When a level is disabled the LOG_* macros cost one relaxed load and a
+// branch. A full ring drops the record (counted) instead of blocking.
+
+enum class LogLevel : int { Debug = 0, Info = 1, Warn = 2, Error = 3, Off = 4 };
+
+struct LogArg {
+    enum class Type : uint8_t { Int, Uint, Double, Text };
+    static constexpr size_t kTextBytes = 64;
+
+    Type type;
+    union {
+        int64_t i;
+        uint64_t u;
+        double d;
+    };
+    char text[kTextBytes];   // strings are copied (truncated) into the record
+};
+
+struct LogRecord {
+    static constexpr size_t kMaxArgs = 6;
+
+    int64_t ts_ns;
+    LogLevel level;
+    const char* format;
+    uint8_t arg_count;
+    LogArg args[kMaxArgs];
+};
+
+class Logger {
+public:
+    static Logger& instance();
+
+    static bool enabled(LogLevel level) {
+        return static_cast<int>(level) >= level_.load(std::memory_order_relaxed);
+    }
+    static void set_level(LogLevel level) { level_.store(static_cast<int>(level), std::memory_order_relaxed); }
+
+    // Start the background writer; output defaults to stdout
+    void start(std::FILE* output = stdout);
+    void stop();   // drains pending records and flushes
+
+    template <typename... Args>
+    void log(LogLevel level, const char* format, const Args&... args) {
+        static_assert(sizeof...(Args) <= LogRecord::kMaxArgs, "too many log arguments");
+        SpscRing<LogRecord>& ring = thread_ring();
+        LogRecord* record = ring.claim();
+        if (!record) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        record->ts_ns = now_ns();
+        record->level = level;
+        record->format = format;
+        record->arg_count = 0;
+        int expand[] = {0, (set_arg(record->args[record->arg_count++], args), 0)...};
+        (void)expand;
+        ring.publish();
+    }
+
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+    // Render one record into `out` (exposed for tests)
+    static size_t format_record(const LogRecord& record, char* out, size_t size);
+
+private:
+    static constexpr size_t kRingCapacity = 1024;
+
+    Logger();
+    ~Logger();
+
+    static std::atomic<int> level_;
+
+    std::mutex rings_mutex_;   // taken once per thread, on its first log call
+    std::vector<std::shared_ptr<SpscRing<LogRecord>>> rings_;
+    std::atomic<size_t> ring_count_;
+    std::atomic<uint64_t> dropped_;
+    std::FILE* output_;
+    std::thread writer_;
+    std::atomic<bool> running_;
+
+    SpscRing<LogRecord>& thread_ring();
+    void run();
+    size_t drain(const std::vector<std::shared_ptr<SpscRing<LogRecord>>>& rings);
+    static int64_t now_ns();
+
+    template <typename T>
+    static typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type
+    set_arg(LogArg& arg, T value) { arg.type = LogArg::Type::Int; arg.i = value; }
+
+    template <typename T>
+    static typename std::enable_if<std::is_integral<T>::value && !std::is_signed<T>::value>::type
+    set_arg(LogArg& arg, T value) { arg.type = LogArg::Type::Uint; arg.u = value; }
+
+    template <typename T>
+    static typename std::enable_if<std::is_floating_point<T>::value>::type
+    set_arg(LogArg& arg, T value) { arg.type = LogArg::Type::Double; arg.d = value; }
+
+    static void set_arg(LogArg& arg, const char* value) { set_text(arg, value, std::strlen(value)); }
+    static void set_arg(LogArg& arg, const std::string& value) { set_text(arg, value.data(), value.size()); }
+    static void set_text(LogArg& arg, const char* value, size_t length);
+};
+
+#define LOG_AT(level, ...) \
+    do { \
+        if (Logger::enabled(level)) Logger::instance().log(level, __VA_ARGS__); \
+    } while (0)
+
+#define LOG_DEBUG(...) LOG_AT(LogLevel::Debug, __VA_ARGS__)
+#define LOG_INFO(...) LOG_AT(LogLevel::Info, __VA_ARGS__)
+#define LOG_WARN(...) LOG_AT(LogLevel::Warn, __VA_ARGS__)
+#define LOG_ERROR(...) LOG_AT(LogLevel::Error, __VA_ARGS__)
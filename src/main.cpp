@@ -1,36 +1,135 @@
+#include <algorithm>
+#include <cstdlib>
 #include <iostream>
 #include <thread>
-#include "websocket_client.h"
+#include <memory>
+#include <string>
+#include <vector>
+#include "connection_manager.h"
+#include "book_registry.h"
 #include "orderbook.h"
 #include "models.h"
+#include "coefficient_store.h"
+#include "fee_schedule.h"
+#include "slippage_calibrator.h"
+#include "slippage_quantiles.h"
+#include "work_stealing_pool.h"
 #include "ui.h"
+#include "logger.h"
 
-int main() {
+int main(int argc, char** argv) {
     std::cout << "Starting Trade Simulator..." << std::endl;
 
-    // Initialize orderbook
-    OrderBook orderbook;
+    // Feed and book-builder threads log through the async logger; --verbose
+    // enables per-message debug records
+    Logger::instance().start();
 
-    // Initialize WebSocket client with orderbook reference
-    WebSocketClient ws_client("wss://ws.gomarket-cpp.goquant.io/ws/l2-orderbook/okx/BTC-USDT-SWAP", orderbook);
+    // --capture <dir>: record each instrument's raw feed to <dir>/<symbol>.feed
+    // --sketches <file>: restore slippage quantile sketches at start, save them on exit
+    // --ca-file <pem>: trust these roots for wss:// instead of the system store
+    // --busy-poll <us>: SO_BUSY_POLL on feed sockets (Linux)
+    // --insecure: skip TLS certificate verification
+    // --compression none|permessage-deflate|raw: feed compression (default permessage-deflate,
+    //   plain JSON if the server declines it)
+    std::string capture_dir;
+    std::string sketch_path;
+    ConnectionManagerConfig feed_config;
+    FeedCompression compression = FeedCompression::PerMessageDeflate;
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (std::string(argv[i]) == "--capture") {
+            capture_dir = argv[i + 1];
+        } else if (std::string(argv[i]) == "--sketches") {
+            sketch_path = argv[i + 1];
+        } else if (std::string(argv[i]) == "--ca-file") {
+            feed_config.tls.ca_file = argv[i + 1];
+        } else if (std::string(argv[i]) == "--busy-poll") {
+            feed_config.socket.busy_poll_us = std::atoi(argv[i + 1]);
+        } else if (std::string(argv[i]) == "--compression" && !parse_feed_compression(argv[i + 1], compression)) {
+            std::cerr << "Unknown compression " << argv[i + 1] << ", using "
+                      << feed_compression_name(compression) << std::endl;
+        }
+    }
+    for (int i = 1; i < argc; ++i) {
+        if (std::string(argv[i]) == "--verbose") {
+            Logger::set_level(LogLevel::Debug);
+        } else if (std::string(argv[i]) == "--insecure") {
+            feed_config.tls.verify_peer = false;
+        }
+    }
+
+    // One book per instrument, sharded across at most one worker per instrument
+    BookRegistry registry(std::min<size_t>(std::thread::hardware_concurrency(), 5));
+    const std::pair<const char*, double> instruments[] = {
+        {"BTC-USDT-SWAP", 0.1},
+        {"ETH-USDT-SWAP", 0.01},
+        {"LTC-USDT-SWAP", 0.01},
+        {"XRP-USDT-SWAP", 0.0001},
+        {"BCH-USDT-SWAP", 0.01}
+    };
+    for (const auto& instrument : instruments) {
+        registry.add_symbol(instrument.first, instrument.second);
+    }
 
-    // Start WebSocket client in a separate thread
-    std::thread ws_thread([&ws_client]() {
-        ws_client.run();
-    });
+    // All instrument subscriptions share a couple of io threads; each thread
+    // registers a producer ring, so the manager exists before the shards start
+    feed_config.io_threads = 2;
+    ConnectionManager feeds(registry, feed_config);
+    for (SymbolId id = 0; id < registry.size(); ++id) {
+        FeedSubscription subscription;
+        subscription.uri = "wss://ws.gomarket-cpp.goquant.io/ws/l2-orderbook/okx/" + registry.symbol_name(id);
+        subscription.symbol = id;
+        subscription.compression = compression;
+        const size_t index = feeds.add_subscription(subscription);
+        if (!capture_dir.empty()) {
+            feeds.enable_capture(index, capture_dir + "/" + registry.symbol_name(id) + ".feed");
+        }
+    }
+    registry.start();
+    feeds.start();
 
-    // Initialize UI with orderbook and models
+    // Per-symbol model coefficients; recalibration publishes into the store
+    // while the UI and models keep reading
+    CoefficientStore coefficients(registry.size());
     Models models;
-    UI ui(orderbook, models);
+    models.set_coefficient_store(&coefficients);
+    models.set_volatility_source(&registry);
+
+    // Every instrument trades on OKX; other venues only need an assign() here
+    FeeScheduleRegistry fee_schedules(registry.size());
+    for (SymbolId id = 0; id < registry.size(); ++id) {
+        fee_schedules.assign(id, venues::Okx::schedule.name);
+    }
+    models.set_fee_schedules(&fee_schedules);
+
+    // Slippage distribution per size x volatility bucket, fed by the calibrator's depth walks
+    SlippageQuantileModel slippage_quantiles(registry.size());
+    if (!sketch_path.empty() && slippage_quantiles.load(sketch_path)) {
+        LOG_INFO("Restored slippage quantile sketches from {}", sketch_path);
+    }
+    models.set_slippage_quantiles(&slippage_quantiles);
+
+    // Refit the slippage regression from the live books in the background
+    SlippageCalibrator calibrator(registry, coefficients);
+    calibrator.set_quantile_model(&slippage_quantiles);
+    calibrator.start();
+
+    // Worker pool for Monte Carlo and scenario sweeps started from the UI
+    WorkStealingPool pool;
+
+    // Initialize UI with the book registry and models
+    UI ui(registry, models, pool);
 
     // Run UI main loop (blocking)
     ui.run();
 
     // Cleanup
-    ws_client.stop();
-    if (ws_thread.joinable()) {
-        ws_thread.join();
+    calibrator.stop();
+    if (!sketch_path.empty()) {
+        slippage_quantiles.save(sketch_path);
     }
+    feeds.stop();
+    registry.stop();
+    Logger::instance().stop();
 
     std::cout << "Trade Simulator stopped." << std::endl;
     return 0;
@@ -0,0 +1,31 @@
+#pragma once
+
+// Model coefficients shared by the per-order and batch paths in Models, so
+// the two can never drift apart.
+namespace model_coefficients {
+
+// Almgren-Chriss market impact
+constexpr double kImpactGamma = 0.1;          // permanent impact coefficient
+constexpr double kImpactEta = 0.05;           // temporary impact coefficient
+constexpr double kImpactHorizon = 1.0;        // trading horizon
+constexpr double kImpactRiskAversion = 1.0;   // lambda in E + lambda * V
+constexpr int kImpactSlices = 10;             // child orders over the horizon
+
+// Volatility used until a symbol's live estimator has seen a return, on the
+// estimator's scale (sigma per sqrt second of log price): 1e-4 is about 3%
+// a day, a typical level for major crypto pairs
+constexpr double kDefaultVolatility = 1e-4;
+
+// Linear slippage regression
+constexpr double kSlippageIntercept = 0.001;
+constexpr double kSlippageQuantity = 0.00001;
+constexpr double kSlippageVolatility = 0.05;
+
+// Logistic maker/taker regression
+constexpr double kMakerTakerIntercept = -1.0;
+constexpr double kMakerTakerQuantity = 0.0001;
+constexpr double kMakerTakerVolatility = 0.5;
+
+// Fee rates live in the venue schedules of fee_schedule.h
+
+} // namespace model_coefficients
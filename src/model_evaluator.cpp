@@ -0,0 +1,29 @@
+#include "model_evaluator.h"
+#include "models.h"
+
+ModelEvaluator::ModelEvaluator(Models& models) : models_(models), valid_(false), hits_(0), misses_(0) {}
+
+const ModelResult& ModelEvaluator::evaluate(double quantity, double volatility, int fee_tier, uint64_t book_version) {
+    ModelInputs inputs;
+    inputs.quantity = quantity;
+    inputs.volatility = volatility;
+    inputs.fee_tier = fee_tier;
+    inputs.symbol = models_.selected_symbol();
+    inputs.book_version = book_version;
+    inputs.coefficients_version = models_.coefficients_version();
+    if (valid_ && inputs == result_.inputs) {
+        ++hits_;
+        return result_;
+    }
+
+    ++misses_;
+    result_.inputs = inputs;
+    result_.slippage = models_.calculate_slippage(quantity, volatility);
+    result_.fees = models_.calculate_fees(quantity, fee_tier);
+    result_.market_impact = models_.calculate_market_impact(quantity, volatility);
+    result_.net_cost = result_.slippage + result_.fees + result_.market_impact;
+    result_.maker_taker = models_.predict_maker_taker_proportion(quantity, volatility);
+    result_.schedule = models_.optimal_schedule(quantity, volatility);
+    valid_ = true;
+    return result_;
+}
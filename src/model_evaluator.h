@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include "symbol_id.h"
+#include "almgren_chriss.h"
+
+class Models;
+
+// Everything a model evaluation depends on
+struct ModelInputs {
+    double quantity = 0.0;
+    double volatility = 0.0;
+    int fee_tier = 0;
+    SymbolId symbol = 0;
+    uint64_t book_version = 0;
+    uint64_t coefficients_version = 0;
+
+    bool operator==(const ModelInputs& other) const {
+        return quantity == other.quantity && volatility == other.volatility && fee_tier == other.fee_tier
+               && symbol == other.symbol && book_version == other.book_version
+               && coefficients_version == other.coefficients_version;
+    }
+    bool operator!=(const ModelInputs& other) const { return !(*this == other); }
+};
+
+// One evaluation of every per-order model, shared by all consumers
+struct ModelResult {
+    ModelInputs inputs;
+    double slippage = 0.0;
+    double fees = 0.0;
+    double market_impact = 0.0;
+    double net_cost = 0.0;   // slippage + fees + market impact, as Models::calculate_net_cost
+    double maker_taker = 0.0;
+    AlmgrenChrissSchedule schedule;
+};
+
+// Memoizes the per-order models on their inputs.
+//
+// evaluate() returns the previous result when quantity, volatility, fee
+// tier, selected symbol, book version and coefficient version all match
+// the last call, and recomputes only when one of them changed. Net cost is
+// summed from the components rather than calling calculate_net_cost, so
+// slippage, fees and impact are computed once per miss. Not thread-safe:
+// one evaluator per consuming thread.
+class ModelEvaluator {
+public:
+    explicit ModelEvaluator(Models& models);
+
+    const ModelResult& evaluate(double quantity, double volatility, int fee_tier, uint64_t book_version);
+    const ModelResult& result() const { return result_; }
+    // Force the next evaluate() to recompute
+    void invalidate() { valid_ = false; }
+
+    uint64_t hits() const { return hits_; }
+    uint64_t misses() const { return misses_; }
+
+private:
+    Models& models_;
+    ModelResult result_;
+    bool valid_;
+    uint64_t hits_;
+    uint64_t misses_;
+};
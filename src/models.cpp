@@ -1,46 +1,66 @@
 #include "models.h"
+#include "model_coefficients.h"
+#include "coefficient_store.h"
+#include "book_registry.h"
+#include "slippage_quantiles.h"
+#include "fee_schedule.h"
 #include <cmath>
 #include <iostream>
-#include <mutex>
-#include <vector>
-#include <thread>
 
-Models::Models() {
-    // Constructor implementation (if needed)
-}
+Models::Models()
+    : coefficients_(&CoefficientStore::builtin()), volatility_source_(nullptr),
+      slippage_quantiles_(nullptr), fee_schedules_(&FeeScheduleRegistry::builtin()), symbol_(0),
+      impact_cache_(new AlmgrenChrissCache()) {}
 
 Models::~Models() {
     // Destructor implementation (if needed)
 }
 
 // Almgren-Chriss market impact model implementation
+AlmgrenChrissParams Models::impact_params(double quantity, double volatility) const {
+    ModelCoefficients c;
+    coefficients_->read(symbol_, c);
+    return impact_params(c, quantity, volatility);
+}
+
+AlmgrenChrissParams Models::impact_params(const ModelCoefficients& c, double quantity, double volatility) {
+    AlmgrenChrissParams params;
+    params.quantity = quantity;
+    params.volatility = volatility;
+    params.horizon = c.impact_horizon;
+    params.slices = c.impact_slices;
+    params.risk_aversion = c.impact_risk_aversion;
+    params.gamma = c.impact_gamma;   // permanent impact coefficient
+    params.eta = c.impact_eta;       // temporary impact coefficient
+    return params;
+}
+
 double Models::calculate_market_impact(double quantity, double volatility) {
-    // Simplified Almgren-Chriss model parameters
-    const double gamma = 0.1;  // permanent impact coefficient
-    const double eta = 0.05;   // temporary impact coefficient
-    const double T = 1.0;      // trading horizon
+    // E[cost] / X of the optimal schedule: E scales with X^2, so this is X
+    // times the cached unit-quantity expected cost
+    return quantity * impact_cache_->unit_cost(impact_params(quantity, volatility)).expected_cost;
+}
 
-    double impact = gamma * quantity + eta * quantity / T;
-    return impact;
+AlmgrenChrissSchedule Models::optimal_schedule(double quantity, double volatility) {
+    return impact_cache_->schedule(impact_params(quantity, volatility));
 }
 
 // Regression model for slippage estimation
 double Models::calculate_slippage(double quantity, double volatility) {
-    // Example regression coefficients (to be calibrated)
-    const double intercept = 0.001;
-    const double coef_quantity = 0.00001;
-    const double coef_volatility = 0.05;
-
-    double slippage = intercept + coef_quantity * quantity + coef_volatility * volatility;
-    return slippage;
+    // Regression coefficients for the selected symbol (recalibrated online)
+    ModelCoefficients c;
+    coefficients_->read(symbol_, c);
+    return c.slippage_intercept + c.slippage_quantity * quantity + c.slippage_volatility * volatility;
 }
 
 // Logistic regression for maker/taker proportion prediction
 double Models::predict_maker_taker_proportion(double quantity, double volatility) {
-    // Example logistic regression coefficients
-    const double intercept = -1.0;
-    const double coef_quantity = 0.0001;
-    const double coef_volatility = 0.5;
+    // Logistic regression coefficients for the selected symbol
+    ModelCoefficients c;
+    coefficients_->read(symbol_, c);
+    const double intercept = c.maker_taker_intercept;
+    const double coef_quantity = c.maker_taker_quantity;
+    const double coef_volatility = c.maker_taker_volatility;
 
     double linear_combination = intercept + coef_quantity * quantity + coef_volatility * volatility;
     double odds = std::exp(linear_combination);
@@ -50,12 +70,13 @@ double Models::predict_maker_taker_proportion(double quantity, double volatility
 
 // Calculate fees based on quantity and fee tier
 double Models::calculate_fees(double quantity, int fee_tier) {
-    // Example fee tiers: 1=0.1%, 2=0.05%, 3=0.02%
-    double fee_rate = 0.001; // default 0.1%
-    if (fee_tier == 2) fee_rate = 0.0005;
-    else if (fee_tier == 3) fee_rate = 0.0002;
+    // Market orders take liquidity: one indexed load from the venue's table
+    return quantity * fee_schedules_->table(symbol_).taker_rate(fee_tier);
+}
 
-    return quantity * fee_rate;
+double Models::calculate_fees(double quantity, int fee_tier, double maker_share) {
+    const FeeTable& table = fee_schedules_->table(symbol_);
+    return quantity * (maker_share * table.maker_rate(fee_tier) + (1.0 - maker_share) * table.taker_rate(fee_tier));
 }
 
 // Calculate net cost combining slippage, fees, and market impact
@@ -67,34 +88,73 @@ double Models::calculate_net_cost(double quantity, double volatility, int fee_ti
     return slippage + fees + market_impact;
 }
 
-// Bonus: Thread-safe caching for regression coefficients to improve efficiency
-class RegressionCache {
-private:
-    std::mutex cache_mutex;
-    std::vector<double> cached_coefficients;
-public:
-    RegressionCache() : cached_coefficients({0.001, 0.00001, 0.05}) {}
+void Models::set_coefficient_store(const CoefficientStore* store) {
+    coefficients_ = store ? store : &CoefficientStore::builtin();
+}
 
-    std::vector<double> get_coefficients() {
-        std::lock_guard<std::mutex> lock(cache_mutex);
-        return cached_coefficients;
-    }
+void Models::select_symbol(SymbolId symbol) {
+    symbol_ = symbol;
+}
+
+void Models::coefficients(ModelCoefficients& out) const {
+    coefficients_->read(symbol_, out);
+}
+
+uint64_t Models::coefficients_version() const {
+    return coefficients_->version(symbol_);
+}
+
+void Models::set_fee_schedules(const FeeScheduleRegistry* schedules) {
+    fee_schedules_ = schedules ? schedules : &FeeScheduleRegistry::builtin();
+}
+
+const FeeTable& Models::fee_table() const {
+    return fee_schedules_->table(symbol_);
+}
 
-    void update_coefficients(const std::vector<double>& new_coeffs) {
-        std::lock_guard<std::mutex> lock(cache_mutex);
-        cached_coefficients = new_coeffs;
+void Models::set_volatility_source(const BookRegistry* registry) {
+    volatility_source_ = registry;
+}
+
+double Models::current_volatility() const {
+    if (volatility_source_ == nullptr || symbol_ >= volatility_source_->size()) {
+        return model_coefficients::kDefaultVolatility;
     }
-};
+    return volatility_source_->volatility(symbol_).model_volatility();
+}
 
-static RegressionCache regression_cache;
+double Models::calculate_market_impact(double quantity) {
+    return calculate_market_impact(quantity, current_volatility());
+}
 
-// Optimized slippage calculation using cached coefficients
-double Models::calculate_slippage_optimized(double quantity, double volatility) {
-    auto coeffs = regression_cache.get_coefficients();
-    double intercept = coeffs[0];
-    double coef_quantity = coeffs[1];
-    double coef_volatility = coeffs[2];
+double Models::calculate_slippage(double quantity) {
+    return calculate_slippage(quantity, current_volatility());
+}
+
+double Models::calculate_net_cost(double quantity, int fee_tier) {
+    return calculate_net_cost(quantity, current_volatility(), fee_tier);
+}
+
+double Models::predict_maker_taker_proportion(double quantity) {
+    return predict_maker_taker_proportion(quantity, current_volatility());
+}
 
-    double slippage = intercept + coef_quantity * quantity + coef_volatility * volatility;
-    return slippage;
+AlmgrenChrissSchedule Models::optimal_schedule(double quantity) {
+    return optimal_schedule(quantity, current_volatility());
+}
+
+void Models::set_slippage_quantiles(const SlippageQuantileModel* quantiles) {
+    slippage_quantiles_ = quantiles;
+}
+
+SlippageQuantiles Models::calculate_slippage_quantiles(double quantity, double volatility) const {
+    return slippage_quantiles_ ? slippage_quantiles_->quantiles(symbol_, quantity, volatility) : SlippageQuantiles();
+}
+
+SlippageQuantiles Models::calculate_slippage_quantiles(double quantity) const {
+    return calculate_slippage_quantiles(quantity, current_volatility());
+}
+
+double Models::calculate_slippage_optimized(double quantity, double volatility) {
+    return calculate_slippage(quantity, volatility);
 }
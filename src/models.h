@@ -1,19 +1,108 @@
 #ifndef MODELS_H
 #define MODELS_H
 
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include "symbol_id.h"
+#include "almgren_chriss.h"
+
+class CoefficientStore;
+struct ModelCoefficients;
+class BookRegistry;
+class SlippageQuantileModel;
+struct SlippageQuantiles;
+class FeeScheduleRegistry;
+struct FeeTable;
+
 class Models {
 public:
     Models();
     ~Models();
 
+    // Expected cost per unit of the Almgren-Chriss optimal schedule for the
+    // order, using the selected symbol's impact coefficients (cached by
+    // quantized parameters)
     double calculate_market_impact(double quantity, double volatility);
     double calculate_slippage(double quantity, double volatility);
+    // Taker fees at the selected symbol's venue and VIP tier (tiers outside
+    // the venue's schedule are charged tier 1)
     double calculate_fees(double quantity, int fee_tier);
+    // Fees with maker_share of the quantity filled passively at the maker rate
+    double calculate_fees(double quantity, int fee_tier, double maker_share);
     double calculate_net_cost(double quantity, double volatility, int fee_tier);
     double predict_maker_taker_proportion(double quantity, double volatility);
 
-    // Bonus optimized method
+    // Same as calculate_slippage (which already reads the coefficient store
+    // lock-free); kept for existing callers
     double calculate_slippage_optimized(double quantity, double volatility);
+
+    // Source of calibrated coefficients; defaults to CoefficientStore::builtin()
+    void set_coefficient_store(const CoefficientStore* store);
+    void select_symbol(SymbolId symbol);
+    SymbolId selected_symbol() const { return symbol_; }
+    void coefficients(ModelCoefficients& out) const;
+    // Version of the selected symbol's coefficients; moves on every publish
+    uint64_t coefficients_version() const;
+
+    // Live volatility: with a source set, the overloads without a volatility
+    // argument use the selected symbol's EWMA estimate (sigma per sqrt second).
+    // Without a source, or before the symbol's first return, they use
+    // model_coefficients::kDefaultVolatility.
+    void set_volatility_source(const BookRegistry* registry);
+    double current_volatility() const;
+
+    double calculate_market_impact(double quantity);
+    double calculate_slippage(double quantity);
+    double calculate_net_cost(double quantity, int fee_tier);
+    double predict_maker_taker_proportion(double quantity);
+    AlmgrenChrissSchedule optimal_schedule(double quantity);
+
+    // Venue fee schedules per symbol; defaults to FeeScheduleRegistry::builtin()
+    // (every symbol on OKX)
+    void set_fee_schedules(const FeeScheduleRegistry* schedules);
+    const FeeTable& fee_table() const;
+
+    // p50/p90/p99 slippage for the order's size and volatility bucket, from the
+    // streaming quantile model (count == 0 until it is set and has data)
+    void set_slippage_quantiles(const SlippageQuantileModel* quantiles);
+    SlippageQuantiles calculate_slippage_quantiles(double quantity, double volatility) const;
+    SlippageQuantiles calculate_slippage_quantiles(double quantity) const;
+
+    // Full optimal liquidation schedule behind calculate_market_impact
+    AlmgrenChrissSchedule optimal_schedule(double quantity, double volatility);
+    const AlmgrenChrissCache& impact_cache() const { return *impact_cache_; }
+
+    // Batch entry points over struct-of-arrays inputs: out[i] is the per-order
+    // method applied to element i. They run AVX2 kernels when the CPU supports
+    // them and a scalar loop otherwise. Market impact reads the schedule cache
+    // once per distinct volatility in the batch and scales by quantity in the
+    // kernel. Linear models match the per-order methods to rounding; the maker/taker batch uses a vectorized exp and
+    // matches within kBatchTolerance (relative).
+    static constexpr double kBatchTolerance = 1e-12;
+
+    void calculate_market_impact_batch(const double* quantity, const double* volatility, size_t n, double* out);
+    void calculate_slippage_batch(const double* quantity, const double* volatility, size_t n, double* out);
+    void calculate_fees_batch(const double* quantity, const int* fee_tier, size_t n, double* out);
+    void calculate_net_cost_batch(const double* quantity, const double* volatility, const int* fee_tier,
+                                  size_t n, double* out);
+    void predict_maker_taker_proportion_batch(const double* quantity, const double* volatility, size_t n, double* out);
+
+    // Whether the batch calls use the AVX2 kernels; disabling forces the scalar loop
+    static bool simd_available();
+    static bool simd_enabled();
+    static void set_simd_enabled(bool enabled);
+
+private:
+    const CoefficientStore* coefficients_;
+    const BookRegistry* volatility_source_;
+    const SlippageQuantileModel* slippage_quantiles_;
+    const FeeScheduleRegistry* fee_schedules_;
+    SymbolId symbol_;
+    std::unique_ptr<AlmgrenChrissCache> impact_cache_;
+
+    AlmgrenChrissParams impact_params(double quantity, double volatility) const;
+    static AlmgrenChrissParams impact_params(const ModelCoefficients& c, double quantity, double volatility);
 };
 
 #endif // MODELS_H
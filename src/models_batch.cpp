@@ -0,0 +1,326 @@
+#include "models.h"
+#include "model_coefficients.h"
+#include "coefficient_store.h"
+#include "fee_schedule.h"
+#include <atomic>
+#include <cmath>
+#include <cstring>
+
+// Batch (struct-of-arrays) versions of the Models methods.
+//
+// The AVX2 kernels are compiled with a per-function target attribute and
+// picked at runtime, so the binary still runs on CPUs without AVX2. The
+// linear models use the same operations in the same order as the per-order
+// methods and agree to the last bit; the target leaves out FMA on purpose so
+// the compiler cannot contract a multiply-add. The logistic model needs exp,
+// evaluated with a Cephes-style Pade approximant (about 1 ulp), and stays
+// within Models::kBatchTolerance of the std::exp result.
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define MODELS_HAVE_AVX2 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define MODELS_AVX2_TARGET
+#else
+#define MODELS_AVX2_TARGET __attribute__((target("avx2")))
+#endif
+#else
+#define MODELS_HAVE_AVX2 0
+#endif
+
+using namespace model_coefficients;
+
+namespace {
+
+bool detect_avx2() {
+#if MODELS_HAVE_AVX2
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    __cpuid(info, 1);
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    if (!osxsave || (_xgetbv(0) & 0x6) != 0x6) return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+#else
+    return false;
+#endif
+}
+
+const bool g_simd_available = detect_avx2();
+std::atomic<bool> g_simd_enabled(g_simd_available);
+
+bool use_simd() {
+    return g_simd_enabled.load(std::memory_order_relaxed);
+}
+
+// Orders are priced in chunks so the per-order unit impact costs fit on the stack
+constexpr size_t kImpactChunk = 256;
+
+// Unit-quantity impact cost E(1) for one batch. With epsilon split out,
+// E(X)/X = X * E(1) for fixed parameters, so the schedule cache is probed
+// once per distinct volatility in the batch instead of once per order, and
+// the coefficients are read once. Distinct values go in a small
+// open-addressed table; past kMemoLimit of them, lookups go to the cache.
+class UnitImpactCosts {
+public:
+    UnitImpactCosts(AlmgrenChrissCache& cache, const AlmgrenChrissParams& params)
+        : cache_(cache), params_(params), used_(), count_(0) {}
+
+    void fill(const double* volatility, size_t n, double* unit) {
+        for (size_t i = 0; i < n; ++i) {
+            unit[i] = lookup(volatility[i]);
+        }
+    }
+
+private:
+    static constexpr size_t kMemoSlots = 256;
+    static constexpr size_t kMemoLimit = kMemoSlots * 3 / 4;
+
+    struct Slot {
+        double volatility;
+        double unit_cost;
+    };
+
+    double lookup(double volatility) {
+        uint64_t bits;
+        std::memcpy(&bits, &volatility, sizeof(bits));
+        size_t i = static_cast<size_t>((bits * 0x9e3779b97f4a7c15ull) >> 56);
+        for (; used_[i / 64] & (1ull << (i % 64)); i = (i + 1) % kMemoSlots) {
+            if (slots_[i].volatility == volatility) {
+                return slots_[i].unit_cost;
+            }
+        }
+        params_.volatility = volatility;
+        const double unit_cost = cache_.unit_cost(params_).expected_cost;
+        if (count_ < kMemoLimit) {
+            slots_[i] = Slot{volatility, unit_cost};
+            used_[i / 64] |= 1ull << (i % 64);
+            ++count_;
+        }
+        return unit_cost;
+    }
+
+    AlmgrenChrissCache& cache_;
+    AlmgrenChrissParams params_;
+    uint64_t used_[kMemoSlots / 64];
+    size_t count_;
+    Slot slots_[kMemoSlots];
+};
+
+#if MODELS_HAVE_AVX2
+
+// exp(x) for four lanes. x = n*ln2 + r with |r| <= ln2/2, then
+// e^r = 1 + 2r*P(r^2) / (Q(r^2) - r*P(r^2)) and 2^n is built in the exponent
+// bits. Inputs are clamped to [-708, 709] so 2^n stays a normal double.
+MODELS_AVX2_TARGET inline __m256d exp_avx2(__m256d x) {
+    const __m256d p0 = _mm256_set1_pd(1.26177193074810590878e-4);
+    const __m256d p1 = _mm256_set1_pd(3.02994407707441961300e-2);
+    const __m256d p2 = _mm256_set1_pd(9.99999999999999999910e-1);
+    const __m256d q0 = _mm256_set1_pd(3.00198505138664455042e-6);
+    const __m256d q1 = _mm256_set1_pd(2.52448340349684104192e-3);
+    const __m256d q2 = _mm256_set1_pd(2.27265548208155028766e-1);
+    const __m256d q3 = _mm256_set1_pd(2.00000000000000000009e0);
+    const __m256d ln2_hi = _mm256_set1_pd(6.93145751953125e-1);
+    const __m256d ln2_lo = _mm256_set1_pd(1.42860682030941723212e-6);
+    const __m256d one = _mm256_set1_pd(1.0);
+
+    x = _mm256_min_pd(_mm256_max_pd(x, _mm256_set1_pd(-708.0)), _mm256_set1_pd(709.0));
+    const __m256d n = _mm256_floor_pd(_mm256_add_pd(_mm256_mul_pd(x, _mm256_set1_pd(1.4426950408889634073599)),
+                                                    _mm256_set1_pd(0.5)));
+    x = _mm256_sub_pd(x, _mm256_mul_pd(n, ln2_hi));
+    x = _mm256_sub_pd(x, _mm256_mul_pd(n, ln2_lo));
+
+    const __m256d xx = _mm256_mul_pd(x, x);
+    __m256d p = _mm256_add_pd(_mm256_mul_pd(xx, p0), p1);
+    p = _mm256_add_pd(_mm256_mul_pd(p, xx), p2);
+    p = _mm256_mul_pd(p, x);
+    __m256d q = _mm256_add_pd(_mm256_mul_pd(xx, q0), q1);
+    q = _mm256_add_pd(_mm256_mul_pd(q, xx), q2);
+    q = _mm256_add_pd(_mm256_mul_pd(q, xx), q3);
+    __m256d e = _mm256_div_pd(p, _mm256_sub_pd(q, p));
+    e = _mm256_add_pd(one, _mm256_add_pd(e, e));
+
+    // 2^n: adding 2^52 leaves the integer n + 1023 in the low mantissa bits
+    const __m256d biased = _mm256_add_pd(n, _mm256_set1_pd(1023.0 + 4503599627370496.0));
+    const __m256i bits = _mm256_slli_epi64(_mm256_castpd_si256(biased), 52);
+    return _mm256_mul_pd(e, _mm256_castsi256_pd(bits));
+}
+
+MODELS_AVX2_TARGET inline __m256d slippage_avx2(__m256d q, __m256d v, const ModelCoefficients& c) {
+    __m256d s = _mm256_add_pd(_mm256_set1_pd(c.slippage_intercept), _mm256_mul_pd(_mm256_set1_pd(c.slippage_quantity), q));
+    return _mm256_add_pd(s, _mm256_mul_pd(_mm256_set1_pd(c.slippage_volatility), v));
+}
+
+// Taker rate per lane gathered from the venue table; tiers outside
+// [0, kMaxFeeTiers] map to slot 0 as in FeeTable::slot
+MODELS_AVX2_TARGET inline __m256d fees_avx2(__m256d q, const int* tier, const FeeTable& fees) {
+    const __m128i t = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tier));
+    const __m128i in_range = _mm_cmpeq_epi32(_mm_min_epu32(t, _mm_set1_epi32(static_cast<int>(kMaxFeeTiers))), t);
+    // Masked form with an explicit source: the plain gather trips -Wmaybe-uninitialized in GCC
+    const __m256d rate = _mm256_mask_i32gather_pd(_mm256_setzero_pd(), fees.taker, _mm_and_si128(t, in_range),
+                                                  _mm256_castsi256_pd(_mm256_set1_epi64x(-1)), 8);
+    return _mm256_mul_pd(q, rate);
+}
+
+MODELS_AVX2_TARGET size_t slippage_avx2(const double* quantity, const double* volatility, size_t n, double* out,
+                                        const ModelCoefficients& c) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        _mm256_storeu_pd(out + i, slippage_avx2(_mm256_loadu_pd(quantity + i), _mm256_loadu_pd(volatility + i), c));
+    }
+    return i;
+}
+
+MODELS_AVX2_TARGET size_t fees_avx2(const double* quantity, const int* fee_tier, size_t n, double* out,
+                                    const FeeTable& fees) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        _mm256_storeu_pd(out + i, fees_avx2(_mm256_loadu_pd(quantity + i), fee_tier + i, fees));
+    }
+    return i;
+}
+
+MODELS_AVX2_TARGET size_t market_impact_avx2(const double* quantity, const double* unit_cost, size_t n, double* out) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        _mm256_storeu_pd(out + i, _mm256_mul_pd(_mm256_loadu_pd(quantity + i), _mm256_loadu_pd(unit_cost + i)));
+    }
+    return i;
+}
+
+// (slippage + fees) + quantity * unit impact cost, in the per-order order
+MODELS_AVX2_TARGET size_t net_cost_avx2(const double* quantity, const double* volatility, const int* fee_tier,
+                                        const double* unit_cost, size_t n, double* out, const ModelCoefficients& c,
+                                        const FeeTable& fees) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const __m256d q = _mm256_loadu_pd(quantity + i);
+        const __m256d v = _mm256_loadu_pd(volatility + i);
+        const __m256d impact = _mm256_mul_pd(q, _mm256_loadu_pd(unit_cost + i));
+        _mm256_storeu_pd(out + i, _mm256_add_pd(_mm256_add_pd(slippage_avx2(q, v, c), fees_avx2(q, fee_tier + i, fees)),
+                                                impact));
+    }
+    return i;
+}
+
+MODELS_AVX2_TARGET size_t maker_taker_avx2(const double* quantity, const double* volatility, size_t n, double* out,
+                                           const ModelCoefficients& c) {
+    const __m256d one = _mm256_set1_pd(1.0);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const __m256d q = _mm256_loadu_pd(quantity + i);
+        const __m256d v = _mm256_loadu_pd(volatility + i);
+        __m256d linear = _mm256_add_pd(_mm256_set1_pd(c.maker_taker_intercept), _mm256_mul_pd(_mm256_set1_pd(c.maker_taker_quantity), q));
+        linear = _mm256_add_pd(linear, _mm256_mul_pd(_mm256_set1_pd(c.maker_taker_volatility), v));
+        const __m256d odds = exp_avx2(linear);
+        _mm256_storeu_pd(out + i, _mm256_div_pd(odds, _mm256_add_pd(one, odds)));
+    }
+    return i;
+}
+
+#endif // MODELS_HAVE_AVX2
+
+} // namespace
+
+bool Models::simd_available() {
+    return g_simd_available;
+}
+
+bool Models::simd_enabled() {
+    return use_simd();
+}
+
+void Models::set_simd_enabled(bool enabled) {
+    g_simd_enabled.store(enabled && g_simd_available, std::memory_order_relaxed);
+}
+
+// Each batch call reads the selected symbol's coefficients once, runs the
+// vector kernel over whole groups of four and the per-order method over the
+// tail (or everything, on the scalar path)
+
+void Models::calculate_market_impact_batch(const double* quantity, const double* volatility, size_t n, double* out) {
+    ModelCoefficients c;
+    coefficients(c);
+    UnitImpactCosts unit_costs(*impact_cache_, impact_params(c, 1.0, 0.0));
+    double unit[kImpactChunk];
+    for (size_t base = 0; base < n; base += kImpactChunk) {
+        const size_t m = n - base < kImpactChunk ? n - base : kImpactChunk;
+        unit_costs.fill(volatility + base, m, unit);
+        size_t i = 0;
+#if MODELS_HAVE_AVX2
+        if (use_simd()) i = market_impact_avx2(quantity + base, unit, m, out + base);
+#endif
+        for (; i < m; ++i) {
+            out[base + i] = quantity[base + i] * unit[i];
+        }
+    }
+}
+
+void Models::calculate_slippage_batch(const double* quantity, const double* volatility, size_t n, double* out) {
+    size_t i = 0;
+#if MODELS_HAVE_AVX2
+    if (use_simd()) {
+        ModelCoefficients c;
+        coefficients(c);
+        i = slippage_avx2(quantity, volatility, n, out, c);
+    }
+#endif
+    for (; i < n; ++i) {
+        out[i] = calculate_slippage(quantity[i], volatility[i]);
+    }
+}
+
+void Models::calculate_fees_batch(const double* quantity, const int* fee_tier, size_t n, double* out) {
+    size_t i = 0;
+#if MODELS_HAVE_AVX2
+    if (use_simd()) i = fees_avx2(quantity, fee_tier, n, out, fee_table());
+#endif
+    for (; i < n; ++i) {
+        out[i] = calculate_fees(quantity[i], fee_tier[i]);
+    }
+}
+
+void Models::calculate_net_cost_batch(const double* quantity, const double* volatility, const int* fee_tier,
+                                      size_t n, double* out) {
+    size_t i = 0;
+#if MODELS_HAVE_AVX2
+    if (use_simd()) {
+        ModelCoefficients c;
+        coefficients(c);
+        UnitImpactCosts unit_costs(*impact_cache_, impact_params(c, 1.0, 0.0));
+        double unit[kImpactChunk];
+        // Whole groups of four only; the tail goes through the per-order method
+        const size_t vector_n = n & ~static_cast<size_t>(3);
+        for (size_t base = 0; base < vector_n; base += kImpactChunk) {
+            const size_t m = vector_n - base < kImpactChunk ? vector_n - base : kImpactChunk;
+            unit_costs.fill(volatility + base, m, unit);
+            net_cost_avx2(quantity + base, volatility + base, fee_tier + base, unit, m, out + base, c, fee_table());
+        }
+        i = vector_n;
+    }
+#endif
+    for (; i < n; ++i) {
+        out[i] = calculate_net_cost(quantity[i], volatility[i], fee_tier[i]);
+    }
+}
+
+void Models::predict_maker_taker_proportion_batch(const double* quantity, const double* volatility, size_t n, double* out) {
+    size_t i = 0;
+#if MODELS_HAVE_AVX2
+    if (use_simd()) {
+        ModelCoefficients c;
+        coefficients(c);
+        i = maker_taker_avx2(quantity, volatility, n, out, c);
+    }
+#endif
+    for (; i < n; ++i) {
+        out[i] = predict_maker_taker_proportion(quantity[i], volatility[i]);
+    }
+}
@@ -0,0 +1,149 @@
+#include "monte_carlo.h"
+#include "models.h"
+#include "coefficient_store.h"
+#include "work_stealing_pool.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+
+namespace {
+
+uint64_t splitmix64(uint64_t& state) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// xoshiro256**: small state, so a fresh generator per path is cheap to seed
+class PathRng {
+public:
+    using result_type = uint64_t;
+
+    PathRng(uint64_t seed, uint64_t path) {
+        uint64_t state = seed ^ (path * 0xD1B54A32D192ED03ull);
+        for (uint64_t& word : s_) {
+            word = splitmix64(state);
+        }
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    result_type operator()() {
+        const uint64_t result = rotl(s_[1] * 5, 7) * 9;
+        const uint64_t t = s_[1] << 17;
+        s_[2] ^= s_[0];
+        s_[3] ^= s_[1];
+        s_[1] ^= s_[2];
+        s_[0] ^= s_[3];
+        s_[2] ^= t;
+        s_[3] = rotl(s_[3], 45);
+        return result;
+    }
+
+private:
+    uint64_t s_[4];
+
+    static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+};
+
+} // namespace
+
+ExecutionPlan ExecutionPlan::from_schedule(const AlmgrenChrissSchedule& schedule, OrderSide side, double horizon_seconds) {
+    ExecutionPlan plan;
+    plan.side = side;
+    plan.slice_notional.reserve(schedule.trades.size());
+    for (double trade : schedule.trades) {
+        plan.slice_notional.push_back(std::abs(trade));
+    }
+    plan.slice_seconds = schedule.trades.empty() ? horizon_seconds : horizon_seconds / schedule.trades.size();
+    return plan;
+}
+
+MonteCarloParams MonteCarloParams::from_models(const Models& models) {
+    ModelCoefficients c;
+    models.coefficients(c);
+    MonteCarloParams params;
+    params.volatility = models.current_volatility();
+    const double impact = c.impact_gamma + c.impact_eta;
+    params.permanent_share = impact > 0.0 ? c.impact_gamma / impact : 0.0;
+    return params;
+}
+
+MonteCarloCostEngine::MonteCarloCostEngine(WorkStealingPool& pool) : pool_(pool) {}
+
+CostDistribution MonteCarloCostEngine::simulate(const BookSnapshot& book, const ExecutionPlan& plan,
+                                                const MonteCarloParams& params) {
+    CostDistribution result;
+    result.confidence = params.confidence;
+    // Versions are per book, so a fresh engine: the snapshot may come from another symbol
+    engine_ = ExecutionCostEngine();
+    engine_.update(book);
+    costs_.assign(params.paths, 0.0);
+    incomplete_.assign(params.paths, 0);
+    if (params.paths == 0 || !(engine_.mid() > 0.0) || plan.slice_notional.empty()) {
+        return result;
+    }
+
+    const double sign = plan.side == OrderSide::Buy ? 1.0 : -1.0;
+    const double step_sigma = params.volatility * std::sqrt(plan.slice_seconds);
+    const double liquidity_sigma = params.liquidity_volatility;
+
+    pool_.parallel_for(0, params.paths, params.paths_per_task, [&](size_t lo, size_t hi) {
+        for (size_t path = lo; path < hi; ++path) {
+            PathRng rng(params.seed, path);
+            std::normal_distribution<double> normal(0.0, 1.0);
+            double log_mid = 0.0;   // log(mid / arrival mid), including permanent impact
+            double cost = 0.0;
+            bool incomplete = false;
+            for (size_t j = 0; j < plan.slice_notional.size(); ++j) {
+                if (j > 0) {
+                    log_mid += step_sigma * normal(rng) - 0.5 * step_sigma * step_sigma;
+                }
+                const double liquidity = std::exp(liquidity_sigma * normal(rng) - 0.5 * liquidity_sigma * liquidity_sigma);
+                const double notional = plan.slice_notional[j];
+                const ExecutionEstimate fill = engine_.estimate(plan.side, notional / liquidity);
+                incomplete = incomplete || !fill.fully_filled;
+
+                const double mid = std::exp(log_mid);
+                const double price = mid * (1.0 + sign * fill.slippage);   // relative to the arrival mid
+                cost += sign * notional * (price - 1.0);
+                log_mid += sign * params.permanent_share * fill.slippage;
+            }
+            costs_[path] = cost;
+            incomplete_[path] = incomplete;
+        }
+    });
+
+    // Statistics in path order, so they do not depend on the schedule
+    const size_t n = params.paths;
+    double sum = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        sum += costs_[i];
+        result.incomplete_paths += incomplete_[i];
+    }
+    result.paths = n;
+    result.mean = sum / n;
+    double squares = 0.0;
+    for (double cost : costs_) {
+        squares += (cost - result.mean) * (cost - result.mean);
+    }
+    result.stddev = n > 1 ? std::sqrt(squares / (n - 1)) : 0.0;
+
+    sorted_ = costs_;
+    std::sort(sorted_.begin(), sorted_.end());
+    const double level = std::min(std::max(params.confidence, 0.0), 1.0);
+    size_t tail = static_cast<size_t>(std::ceil(level * n));
+    tail = std::min(n - 1, tail > 0 ? tail - 1 : 0);
+    result.var = sorted_[tail];
+    double tail_sum = 0.0;
+    for (size_t i = tail; i < n; ++i) {
+        tail_sum += sorted_[i];
+    }
+    result.cvar = tail_sum / (n - tail);
+    result.min = sorted_.front();
+    result.max = sorted_.back();
+    return result;
+}
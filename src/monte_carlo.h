@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "orderbook.h"
+#include "execution_cost.h"
+#include "almgren_chriss.h"
+
+class Models;
+class WorkStealingPool;
+
+// Child orders of a parent order: quote notional per slice, one slice every
+// slice_seconds starting at arrival
+struct ExecutionPlan {
+    OrderSide side = OrderSide::Buy;
+    std::vector<double> slice_notional;
+    double slice_seconds = 1.0;
+
+    // Slices from an Almgren-Chriss schedule (quote-currency trades) over horizon_seconds
+    static ExecutionPlan from_schedule(const AlmgrenChrissSchedule& schedule, OrderSide side, double horizon_seconds);
+};
+
+struct MonteCarloParams {
+    size_t paths = 10000;
+    uint64_t seed = 1;
+    double volatility = 0.0;             // sigma per sqrt(second) of the mid
+    double permanent_share = 0.0;        // part of each slice's book impact that stays in the mid
+    double liquidity_volatility = 0.25;  // lognormal per-slice shock to visible depth
+    double confidence = 0.95;            // VaR / CVaR level
+    size_t paths_per_task = 256;
+
+    // Volatility from the models' live estimate; permanent share
+    // gamma / (gamma + eta) from the selected symbol's impact coefficients
+    static MonteCarloParams from_models(const Models& models);
+};
+
+// Implementation shortfall versus the arrival mid, in quote currency (positive = cost)
+struct CostDistribution {
+    size_t paths = 0;
+    double mean = 0.0;
+    double stddev = 0.0;
+    double var = 0.0;    // cost quantile at the confidence level
+    double cvar = 0.0;   // mean cost at or beyond the VaR
+    double min = 0.0;
+    double max = 0.0;
+    double confidence = 0.0;
+    size_t incomplete_paths = 0;   // paths where some slice outran the visible depth
+};
+
+// Monte Carlo execution-cost simulator over one book snapshot.
+//
+// Each path walks the plan slice by slice. The mid follows a driftless GBM
+// at the given volatility. Visible depth is scaled by an independent
+// lognormal liquidity factor per slice; walking notional n through depth
+// scaled by L costs the same as walking n / L through the snapshot. Each
+// slice pays its depth-walk slippage against the current mid, and
+// permanent_share of that slippage is left in the mid for later slices.
+//
+// Paths are spread over the pool in chunks. Path i draws from its own RNG
+// seeded from (seed, i), so results are bit-identical for a given seed
+// whatever the thread count or scheduling.
+class MonteCarloCostEngine {
+public:
+    explicit MonteCarloCostEngine(WorkStealingPool& pool);
+
+    CostDistribution simulate(const BookSnapshot& book, const ExecutionPlan& plan, const MonteCarloParams& params);
+
+    // Per-path costs of the last simulate(), in path order
+    const std::vector<double>& path_costs() const { return costs_; }
+
+private:
+    WorkStealingPool& pool_;
+    ExecutionCostEngine engine_;
+    std::vector<double> costs_;
+    std::vector<uint8_t> incomplete_;
+    std::vector<double> sorted_;
+};
@@ -1,66 +1,240 @@
 #include "orderbook.h"
+#include "l2_parser.h"
 #include <algorithm>
 #include <random>
 #include <chrono>
+#include <cstring>
+#include <thread>
 
-OrderBook::OrderBook() {
-    // Initialize empty orderbook
-    asks_.clear();
-    bids_.clear();
+namespace {
+
+bool parse_level(const nlohmann::json& level, double& price, double& quantity) {
+    if (!level.is_array() || level.size() < 2) {
+        return false;
+    }
+    price = std::stod(level[0].get<std::string>());
+    quantity = std::stod(level[1].get<std::string>());
+    return true;
+}
+
+} // namespace
+
+OrderBook::OrderBook(double tick_size)
+    : asks_(PriceLadder::Side::Ask, tick_size),
+      bids_(PriceLadder::Side::Bid, tick_size),
+      seq_(0), best_ask_{0.0, 0.0}, best_bid_{0.0, 0.0}, has_ask_(false), has_bid_(false),
+      writer_(std::thread::id()), depth_requested_(false), depth_front_(0) {
 }
 
 void OrderBook::update_from_json(const nlohmann::json& j) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    asks_.clear();
-    bids_.clear();
+    static const nlohmann::json empty = nlohmann::json::array();
 
-    if (j.contains("asks") && j["asks"].is_array()) {
-        for (const auto& level : j["asks"]) {
-            if (level.is_array() && level.size() >= 2) {
-                OrderLevel ol;
-                ol.price = std::stod(level[0].get<std::string>());
-                ol.quantity = std::stod(level[1].get<std::string>());
-                asks_.push_back(ol);
+    // OKX-style envelope: {"action": "snapshot"|"update", "data": [{"asks": ..., "bids": ...}]}
+    if (j.contains("data") && j["data"].is_array()) {
+        const bool is_update = j.value("action", "snapshot") == "update";
+        for (const auto& book : j["data"]) {
+            const auto& asks = book.contains("asks") ? book["asks"] : empty;
+            const auto& bids = book.contains("bids") ? book["bids"] : empty;
+            if (is_update) {
+                apply_update(asks, bids);
+            } else {
+                apply_snapshot(asks, bids);
             }
         }
+        return;
     }
 
-    if (j.contains("bids") && j["bids"].is_array()) {
-        for (const auto& level : j["bids"]) {
-            if (level.is_array() && level.size() >= 2) {
-                OrderLevel ol;
-                ol.price = std::stod(level[0].get<std::string>());
-                ol.quantity = std::stod(level[1].get<std::string>());
-                bids_.push_back(ol);
-            }
+    // Flat message: always a full-depth snapshot
+    apply_snapshot(j.contains("asks") ? j["asks"] : empty,
+                   j.contains("bids") ? j["bids"] : empty);
+}
+
+void OrderBook::apply_snapshot(const nlohmann::json& asks, const nlohmann::json& bids) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    load_side(asks_, asks);
+    load_side(bids_, bids);
+    publish();
+}
+
+void OrderBook::apply_update(const nlohmann::json& asks, const nlohmann::json& bids) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    apply_levels(asks_, asks);
+    apply_levels(bids_, bids);
+    publish();
+}
+
+void OrderBook::apply(const L2Message& message) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (message.action == L2Message::Action::Snapshot) {
+        asks_.clear();
+        bids_.clear();
+    }
+    for (size_t i = 0; i < message.ask_count; ++i) {
+        asks_.set(asks_.to_tick(message.asks[i].price), message.asks[i].quantity);
+    }
+    for (size_t i = 0; i < message.bid_count; ++i) {
+        bids_.set(bids_.to_tick(message.bids[i].price), message.bids[i].quantity);
+    }
+    publish();
+}
+
+void OrderBook::load_side(PriceLadder& side, const nlohmann::json& levels) {
+    side.clear();
+    apply_levels(side, levels);
+}
+
+void OrderBook::apply_levels(PriceLadder& side, const nlohmann::json& levels) {
+    if (!levels.is_array()) {
+        return;
+    }
+
+    double price, quantity;
+    for (const auto& level : levels) {
+        if (parse_level(level, price, quantity)) {
+            side.set(side.to_tick(price), quantity);
         }
     }
+}
 
-    // Sort asks ascending by price
-    std::sort(asks_.begin(), asks_.end(), [](const OrderLevel& a, const OrderLevel& b) {
-        return a.price < b.price;
-    });
+void OrderBook::publish() {
+    const uint64_t seq = seq_.load(std::memory_order_relaxed);
+    seq_.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
 
-    // Sort bids descending by price
-    std::sort(bids_.begin(), bids_.end(), [](const OrderLevel& a, const OrderLevel& b) {
-        return a.price > b.price;
-    });
+    const int64_t ask = asks_.best_tick();
+    has_ask_ = ask != PriceLadder::kNoTick;
+    if (has_ask_) {
+        best_ask_ = OrderLevel{asks_.to_price(ask), asks_.quantity_at(ask)};
+    }
+    const int64_t bid = bids_.best_tick();
+    has_bid_ = bid != PriceLadder::kNoTick;
+    if (has_bid_) {
+        best_bid_ = OrderLevel{bids_.to_price(bid), bids_.quantity_at(bid)};
+    }
+
+    seq_.store(seq + 2, std::memory_order_release);
+    writer_.store(std::this_thread::get_id(), std::memory_order_relaxed);
+
+    if (depth_requested_.load(std::memory_order_relaxed)) {
+        publish_depth();
+    }
 }
 
-std::vector<OrderLevel> OrderBook::get_asks() {
+void OrderBook::serve_depth() {
+    if (!depth_requested_.load(std::memory_order_relaxed)) {
+        return;
+    }
     std::lock_guard<std::mutex> lock(mutex_);
-    return asks_;
+    publish_depth();
 }
 
-std::vector<OrderLevel> OrderBook::get_bids() {
+void OrderBook::flush_depth() {
     std::lock_guard<std::mutex> lock(mutex_);
-    return bids_;
+    const DepthBuffer& front = depth_[depth_front_.load(std::memory_order_relaxed)];
+    if (front.depth.version < version() || depth_requested_.load(std::memory_order_relaxed)) {
+        publish_depth();
+    }
+}
+
+void OrderBook::publish_depth() const {
+    depth_requested_.store(false, std::memory_order_relaxed);
+    const unsigned back = depth_front_.load(std::memory_order_relaxed) ^ 1u;
+    DepthBuffer& buffer = depth_[back];
+    const uint64_t seq = buffer.seq.load(std::memory_order_relaxed);
+    buffer.seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    size_t n = 0;
+    asks_.for_each(BookSnapshot::kMaxDepth, [&buffer, &n](double price, double quantity) {
+        buffer.depth.asks[n++] = OrderLevel{price, quantity};
+    });
+    buffer.depth.ask_count = n;
+
+    n = 0;
+    bids_.for_each(BookSnapshot::kMaxDepth, [&buffer, &n](double price, double quantity) {
+        buffer.depth.bids[n++] = OrderLevel{price, quantity};
+    });
+    buffer.depth.bid_count = n;
+    buffer.depth.version = seq_.load(std::memory_order_relaxed) >> 1;
+
+    buffer.seq.store(seq + 2, std::memory_order_release);
+    depth_front_.store(back, std::memory_order_release);
+}
+
+void OrderBook::read_snapshot(BookSnapshot& out) const {
+    const uint64_t wanted = version();
+    while (true) {
+        const DepthBuffer& buffer = depth_[depth_front_.load(std::memory_order_acquire)];
+        const uint64_t before = buffer.seq.load(std::memory_order_acquire);
+        if (before & 1) {
+            // Refilled under us after two swaps; the other buffer is now the front
+            continue;
+        }
+        const uint64_t copied = buffer.depth.version;
+        if (copied < wanted) {
+            if (writer_.load(std::memory_order_relaxed) == std::this_thread::get_id()) {
+                // The book's own writer thread: no message can arrive while it waits here
+                std::lock_guard<std::mutex> lock(mutex_);
+                publish_depth();
+                continue;
+            }
+            // Ask the writer for a copy and wait for it; never touch the writer's lock
+            if (!depth_requested_.load(std::memory_order_relaxed)) {
+                depth_requested_.store(true, std::memory_order_relaxed);
+            }
+            std::this_thread::yield();
+            continue;
+        }
+
+        // Counts may be torn mid-publish; clamp them and let the sequence check reject the copy
+        out.ask_count = std::min(buffer.depth.ask_count, BookSnapshot::kMaxDepth);
+        out.bid_count = std::min(buffer.depth.bid_count, BookSnapshot::kMaxDepth);
+        std::memcpy(out.asks, buffer.depth.asks, out.ask_count * sizeof(OrderLevel));
+        std::memcpy(out.bids, buffer.depth.bids, out.bid_count * sizeof(OrderLevel));
+        out.version = copied;
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (buffer.seq.load(std::memory_order_relaxed) == before) {
+            return;
+        }
+    }
+}
+
+bool OrderBook::read_top(OrderLevel& best_bid, OrderLevel& best_ask) const {
+    while (true) {
+        const uint64_t before = seq_.load(std::memory_order_acquire);
+        if (before & 1) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        const bool both_sides = has_ask_ && has_bid_;
+        best_bid = best_bid_;
+        best_ask = best_ask_;
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (seq_.load(std::memory_order_relaxed) == before) {
+            return both_sides;
+        }
+    }
+}
+
+std::vector<OrderLevel> OrderBook::get_asks() const {
+    thread_local BookSnapshot snapshot;
+    read_snapshot(snapshot);
+    return std::vector<OrderLevel>(snapshot.asks, snapshot.asks + snapshot.ask_count);
+}
+
+std::vector<OrderLevel> OrderBook::get_bids() const {
+    thread_local BookSnapshot snapshot;
+    read_snapshot(snapshot);
+    return std::vector<OrderLevel>(snapshot.bids, snapshot.bids + snapshot.bid_count);
 }
 
 void OrderBook::simulate_update() {
     std::lock_guard<std::mutex> lock(mutex_);
 
-    // Generate synthetic asks and bids with random prices and quantities
+    // Generate a synthetic book around a random mid with random quantities
     asks_.clear();
     bids_.clear();
 
@@ -68,19 +242,19 @@ void OrderBook::simulate_update() {
     std::uniform_real_distribution<double> price_dist(95000.0, 96000.0);
     std::uniform_real_distribution<double> quantity_dist(0.01, 10.0);
 
+    const double mid = price_dist(eng);
+
     // Generate 10 ask levels
     for (int i = 0; i < 10; ++i) {
-        OrderLevel ol;
-        ol.price = price_dist(eng) + i * 0.5; // ascending prices
-        ol.quantity = quantity_dist(eng);
-        asks_.push_back(ol);
+        const double price = mid + (i + 1) * 0.5; // ascending prices
+        asks_.set(asks_.to_tick(price), quantity_dist(eng));
     }
 
     // Generate 10 bid levels
     for (int i = 0; i < 10; ++i) {
-        OrderLevel ol;
-        ol.price = price_dist(eng) - i * 0.5; // descending prices
-        ol.quantity = quantity_dist(eng);
-        bids_.push_back(ol);
+        const double price = mid - (i + 1) * 0.5; // descending prices
+        bids_.set(bids_.to_tick(price), quantity_dist(eng));
     }
+
+    publish();
 }
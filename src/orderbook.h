@@ -3,27 +3,114 @@
 #include <vector>
 #include <string>
 #include <mutex>
+#include <atomic>
+#include <thread>
+#include <cstddef>
+#include <cstdint>
 #include <nlohmann/json.hpp>
+#include "price_ladder.h"
 
 struct OrderLevel {
     double price;
     double quantity;
 };
 
+// Fixed-capacity copy of the top of the book. Readers keep one around and
+// refill it with OrderBook::read_snapshot, so reading never allocates.
+struct BookSnapshot {
+    static constexpr size_t kMaxDepth = 400;
+
+    uint64_t version = 0;
+    size_t ask_count = 0;
+    size_t bid_count = 0;
+    OrderLevel asks[kMaxDepth];   // ascending
+    OrderLevel bids[kMaxDepth];   // descending
+};
+
+struct L2Message;
+
 class OrderBook {
 public:
-    OrderBook();
+    // tick_size is the instrument's price increment (0.1 for BTC-USDT-SWAP)
+    explicit OrderBook(double tick_size = 0.1);
 
+    // Accepts either a flat full-depth message ({"asks": [...], "bids": [...]})
+    // or an OKX-style envelope ({"action": "snapshot"|"update", "data": [...]}).
+    // Snapshots replace the book, updates are applied incrementally.
     void update_from_json(const nlohmann::json& j);
 
-    std::vector<OrderLevel> get_asks();
-    std::vector<OrderLevel> get_bids();
+    // Replace one side of the book / apply a single level delta.
+    // A quantity of 0 deletes the level.
+    void apply_snapshot(const nlohmann::json& asks, const nlohmann::json& bids);
+    void apply_update(const nlohmann::json& asks, const nlohmann::json& bids);
+
+    // Apply a message produced by the streaming parser (see l2_parser.h)
+    void apply(const L2Message& message);
+
+    // Read of the latest book without locks. The depth is copied out of the
+    // ladders lazily by the writer: a reader that finds the copy older than
+    // version() asks for one and waits until the writer serves it (its next
+    // applied message, or serve_depth() while idle). On the writer's own
+    // thread the request is served inline.
+    void read_snapshot(BookSnapshot& out) const;
+    // Best level of each side only, published with every message (lock-free);
+    // false while either side is empty
+    bool read_top(OrderLevel& best_bid, OrderLevel& best_ask) const;
+
+    // Incremented once per applied message; lets consumers skip unchanged books
+    uint64_t version() const { return seq_.load(std::memory_order_acquire) >> 1; }
+
+    // Convenience copies built from read_snapshot (these allocate)
+    std::vector<OrderLevel> get_asks() const;
+    std::vector<OrderLevel> get_bids() const;
+
+    double tick_size() const { return asks_.tick_size(); }
+
+    // Writer side. serve_depth() makes a copy if a reader has asked for one;
+    // an idle writer calls it between messages. flush_depth() brings the copy
+    // up to date unconditionally; a writer calls it when it stops, so later
+    // readers never wait.
+    void serve_depth();
+    void flush_depth();
 
     // For performance testing: simulate synthetic orderbook update
     void simulate_update();
 
 private:
-    std::vector<OrderLevel> asks_;
-    std::vector<OrderLevel> bids_;
-    std::mutex mutex_;
+    // Integer-tick ladders: levels are matched by tick, never by double equality
+    PriceLadder asks_;
+    PriceLadder bids_;
+    // Serializes writers; readers never take it
+    mutable std::mutex mutex_;
+
+    // Seqlock over the version and top of book: odd seq_ means a publish is in progress
+    std::atomic<uint64_t> seq_;
+    OrderLevel best_ask_;
+    OrderLevel best_bid_;
+    bool has_ask_;
+    bool has_bid_;
+
+    // Thread that applied the last message
+    std::atomic<std::thread::id> writer_;
+
+    // Depth copies, double-buffered: the writer fills the back buffer and
+    // swaps it to the front, so readers never wait on a copy in progress. Each
+    // buffer keeps a seqlock for a reader still on it two swaps later.
+    // Copying is O(depth), so it only happens when a reader has asked since
+    // the last copy; an applied message costs O(changed levels).
+    struct DepthBuffer {
+        std::atomic<uint64_t> seq{0};
+        BookSnapshot depth;
+    };
+    mutable std::atomic<bool> depth_requested_;
+    mutable std::atomic<unsigned> depth_front_;
+    mutable DepthBuffer depth_[2];
+
+    // Must be called with mutex_ held, after every mutation
+    void publish();
+    // mutex_ held
+    void publish_depth() const;
+
+    static void load_side(PriceLadder& side, const nlohmann::json& levels);
+    static void apply_levels(PriceLadder& side, const nlohmann::json& levels);
 };
@@ -0,0 +1,164 @@
+#include "price_ladder.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+constexpr size_t kNpos = static_cast<size_t>(-1);
+
+// First set bit at or after `start`
+size_t find_next_set(const std::vector<uint64_t>& bits, size_t start) {
+    size_t word = start >> 6;
+    if (word >= bits.size()) return kNpos;
+    uint64_t w = bits[word] & (~0ULL << (start & 63));
+    while (true) {
+        if (w) return (word << 6) + PriceLadder::lowest_bit(w);
+        if (++word >= bits.size()) return kNpos;
+        w = bits[word];
+    }
+}
+
+// Last set bit at or before `start`
+size_t find_prev_set(const std::vector<uint64_t>& bits, size_t start) {
+    size_t word = start >> 6;
+    uint64_t w = bits[word] & (~0ULL >> (63 - (start & 63)));
+    while (true) {
+        if (w) return (word << 6) + PriceLadder::highest_bit(w);
+        if (word-- == 0) return kNpos;
+        w = bits[word];
+    }
+}
+
+} // namespace
+
+PriceLadder::PriceLadder(Side side, double tick_size, size_t capacity)
+    : side_(side), tick_size_(tick_size), capacity_(((std::max<size_t>(capacity, 64) + 63) / 64) * 64),
+      base_tick_(0), count_(0), best_index_(0), dropped_(0) {
+    quantities_.assign(capacity_, 0.0);
+    occupied_.assign(capacity_ / 64, 0);
+    scratch_quantities_.assign(capacity_, 0.0);
+    scratch_occupied_.assign(capacity_ / 64, 0);
+}
+
+void PriceLadder::clear() {
+    std::fill(occupied_.begin(), occupied_.end(), 0);
+    count_ = 0;
+}
+
+int64_t PriceLadder::to_tick(double price) const {
+    return static_cast<int64_t>(std::llround(price / tick_size_));
+}
+
+void PriceLadder::set(int64_t tick, double quantity) {
+    if (!in_window(tick)) {
+        if (quantity <= 0.0) {
+            return;
+        }
+        if (count_ == 0) {
+            recenter(tick);
+        } else {
+            const int64_t best = best_tick();
+            // A new best price moves the window; otherwise re-anchor on the
+            // current best in case it drifted away from the touch edge.
+            recenter(is_deeper(best, tick) ? tick : best);
+            if (!in_window(tick)) {
+                ++dropped_;
+                return;
+            }
+        }
+    }
+
+    const size_t index = static_cast<size_t>(tick - base_tick_);
+    uint64_t& word = occupied_[index >> 6];
+    const uint64_t mask = 1ULL << (index & 63);
+    const bool present = (word & mask) != 0;
+
+    if (quantity <= 0.0) {
+        if (!present) {
+            return;
+        }
+        word &= ~mask;
+        --count_;
+        if (count_ > 0 && index == best_index_) {
+            best_index_ = scan_away_from_touch(index);
+        }
+        return;
+    }
+
+    quantities_[index] = quantity;
+    if (present) {
+        return;
+    }
+    word |= mask;
+    ++count_;
+    if (count_ == 1 || (side_ == Side::Ask ? index < best_index_ : index > best_index_)) {
+        best_index_ = index;
+    }
+}
+
+double PriceLadder::quantity_at(int64_t tick) const {
+    if (!in_window(tick)) {
+        return 0.0;
+    }
+    const size_t index = static_cast<size_t>(tick - base_tick_);
+    return (occupied_[index >> 6] >> (index & 63)) & 1ULL ? quantities_[index] : 0.0;
+}
+
+int64_t PriceLadder::best_tick() const {
+    return count_ == 0 ? kNoTick : base_tick_ + static_cast<int64_t>(best_index_);
+}
+
+int64_t PriceLadder::next_tick(int64_t tick) const {
+    if (count_ == 0 || !in_window(tick)) {
+        return kNoTick;
+    }
+    const size_t index = scan_away_from_touch(static_cast<size_t>(tick - base_tick_));
+    return index == kNpos ? kNoTick : base_tick_ + static_cast<int64_t>(index);
+}
+
+size_t PriceLadder::scan_from_touch(size_t start) const {
+    return side_ == Side::Ask ? find_next_set(occupied_, start) : find_prev_set(occupied_, start);
+}
+
+size_t PriceLadder::scan_away_from_touch(size_t index) const {
+    if (side_ == Side::Ask) {
+        return index + 1 >= capacity_ ? kNpos : find_next_set(occupied_, index + 1);
+    }
+    return index == 0 ? kNpos : find_prev_set(occupied_, index - 1);
+}
+
+void PriceLadder::recenter(int64_t best) {
+    // Keep a quarter of the window on the touch side of the best level and
+    // the remaining three quarters for depth.
+    const int64_t cap = static_cast<int64_t>(capacity_);
+    const int64_t new_base = side_ == Side::Ask ? best - cap / 4 : best - (cap - cap / 4 - 1);
+    if (new_base == base_tick_) {
+        return;
+    }
+
+    if (count_ > 0) {
+        std::fill(scratch_occupied_.begin(), scratch_occupied_.end(), 0);
+        size_t kept = 0;
+        for (size_t i = find_next_set(occupied_, 0); i != kNpos;
+             i = i + 1 < capacity_ ? find_next_set(occupied_, i + 1) : kNpos) {
+            const int64_t shifted = base_tick_ + static_cast<int64_t>(i) - new_base;
+            if (shifted < 0 || shifted >= cap) {
+                ++dropped_;
+                continue;
+            }
+            const size_t j = static_cast<size_t>(shifted);
+            scratch_quantities_[j] = quantities_[i];
+            scratch_occupied_[j >> 6] |= 1ULL << (j & 63);
+            ++kept;
+        }
+        quantities_.swap(scratch_quantities_);
+        occupied_.swap(scratch_occupied_);
+        count_ = kept;
+    }
+
+    base_tick_ = new_base;
+    if (count_ > 0) {
+        best_index_ = scan_from_touch(side_ == Side::Ask ? 0 : capacity_ - 1);
+    }
+}
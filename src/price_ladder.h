@@ -0,0 +1,125 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// One side of an order book keyed by integer ticks (price / tick_size).
+//
+// Quantities live in a contiguous array covering a window of `capacity` ticks
+// and a bitmap marks the occupied slots, so updates are a single indexed store
+// and best / next-level lookups are a few 64-bit word scans. The window is
+// anchored near the touch and re-centred when the best price moves outside it;
+// levels that end up deeper than the window are dropped (see dropped_levels()).
+class PriceLadder {
+public:
+    enum class Side { Ask, Bid };
+
+    static constexpr int64_t kNoTick = INT64_MIN;
+
+    PriceLadder(Side side, double tick_size, size_t capacity = 8192);
+
+    void clear();
+
+    // Insert, modify or delete (quantity <= 0) the level at `tick`.
+    void set(int64_t tick, double quantity);
+    double quantity_at(int64_t tick) const;
+
+    bool empty() const { return count_ == 0; }
+    size_t depth() const { return count_; }
+    uint64_t dropped_levels() const { return dropped_; }
+
+    // Best level (lowest ask / highest bid), or kNoTick when empty.
+    int64_t best_tick() const;
+    // Next occupied level strictly further from the touch than `tick`, or kNoTick.
+    int64_t next_tick(int64_t tick) const;
+
+    int64_t to_tick(double price) const;
+    double to_price(int64_t tick) const { return static_cast<double>(tick) * tick_size_; }
+    double tick_size() const { return tick_size_; }
+
+    // Visit up to `max_levels` occupied levels from the touch outwards.
+    // Walks the bitmap a word at a time, so cost is per occupied level.
+    template <typename F>
+    void for_each(size_t max_levels, F&& f) const {
+        if (count_ == 0 || max_levels == 0) {
+            return;
+        }
+        size_t visited = 0;
+        size_t word = best_index_ >> 6;
+        if (side_ == Side::Ask) {
+            uint64_t bits = occupied_[word] & (~0ULL << (best_index_ & 63));
+            while (true) {
+                while (bits) {
+                    const size_t index = (word << 6) + lowest_bit(bits);
+                    f(to_price(base_tick_ + static_cast<int64_t>(index)), quantities_[index]);
+                    if (++visited == max_levels) return;
+                    bits &= bits - 1;
+                }
+                if (++word == occupied_.size()) return;
+                bits = occupied_[word];
+            }
+        } else {
+            uint64_t bits = occupied_[word] & (~0ULL >> (63 - (best_index_ & 63)));
+            while (true) {
+                while (bits) {
+                    const unsigned bit = highest_bit(bits);
+                    const size_t index = (word << 6) + bit;
+                    f(to_price(base_tick_ + static_cast<int64_t>(index)), quantities_[index]);
+                    if (++visited == max_levels) return;
+                    bits &= ~(1ULL << bit);
+                }
+                if (word-- == 0) return;
+                bits = occupied_[word];
+            }
+        }
+    }
+
+    static unsigned lowest_bit(uint64_t word) {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward64(&index, word);
+        return static_cast<unsigned>(index);
+#else
+        return static_cast<unsigned>(__builtin_ctzll(word));
+#endif
+    }
+
+    static unsigned highest_bit(uint64_t word) {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanReverse64(&index, word);
+        return static_cast<unsigned>(index);
+#else
+        return 63u - static_cast<unsigned>(__builtin_clzll(word));
+#endif
+    }
+
+private:
+    Side side_;
+    double tick_size_;
+    size_t capacity_;      // always a multiple of 64
+    int64_t base_tick_;    // tick stored at index 0
+    size_t count_;
+    size_t best_index_;    // valid when count_ > 0
+    uint64_t dropped_;
+
+    std::vector<double> quantities_;
+    std::vector<uint64_t> occupied_;
+    // Scratch buffers for re-centring, allocated once up front
+    std::vector<double> scratch_quantities_;
+    std::vector<uint64_t> scratch_occupied_;
+
+    bool in_window(int64_t tick) const {
+        return tick >= base_tick_ && tick < base_tick_ + static_cast<int64_t>(capacity_);
+    }
+    bool is_deeper(int64_t a, int64_t b) const { return side_ == Side::Ask ? a > b : a < b; }
+
+    void recenter(int64_t best);
+    size_t scan_from_touch(size_t start) const;
+    size_t scan_away_from_touch(size_t start) const;
+};
@@ -0,0 +1,197 @@
+#include "quantile_sketch.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iterator>
+#include <limits>
+
+namespace {
+
+const double kPi = 3.14159265358979323846;
+
+template <typename T>
+void append_raw(std::string& out, const T& value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <typename T>
+bool read_raw(const char*& p, const char* end, T& value) {
+    if (static_cast<size_t>(end - p) < sizeof(value)) {
+        return false;
+    }
+    std::memcpy(&value, p, sizeof(value));
+    p += sizeof(value);
+    return true;
+}
+
+} // namespace
+
+QuantileSketch::QuantileSketch(double compression)
+    : compression_(compression > 10.0 ? compression : 10.0),
+      // Centroid count stays below ~compression; the buffer trades memory for fewer sorts
+      buffer_limit_(static_cast<size_t>(compression_) * 5), total_weight_(0.0), buffer_weight_(0.0),
+      min_(std::numeric_limits<double>::infinity()), max_(-std::numeric_limits<double>::infinity()) {
+    centroids_.reserve(static_cast<size_t>(compression_) + 1);
+    buffer_.reserve(buffer_limit_);
+}
+
+void QuantileSketch::clear() {
+    centroids_.clear();
+    buffer_.clear();
+    total_weight_ = 0.0;
+    buffer_weight_ = 0.0;
+    min_ = std::numeric_limits<double>::infinity();
+    max_ = -std::numeric_limits<double>::infinity();
+}
+
+void QuantileSketch::add(double value, double weight) {
+    if (!std::isfinite(value) || !(weight > 0.0)) {
+        return;
+    }
+    if (buffer_.size() >= buffer_limit_) {
+        compress();
+    }
+    buffer_.push_back(Centroid{value, weight});
+    buffer_weight_ += weight;
+    min_ = std::min(min_, value);
+    max_ = std::max(max_, value);
+}
+
+void QuantileSketch::merge(const QuantileSketch& other) {
+    for (const std::vector<Centroid>* source : {&other.centroids_, &other.buffer_}) {
+        for (const Centroid& c : *source) {
+            if (buffer_.size() >= buffer_limit_) {
+                compress();
+            }
+            buffer_.push_back(c);
+            buffer_weight_ += c.weight;
+        }
+    }
+    min_ = std::min(min_, other.min_);
+    max_ = std::max(max_, other.max_);
+}
+
+void QuantileSketch::compress() {
+    if (buffer_.empty()) {
+        return;
+    }
+    auto less = [](const Centroid& a, const Centroid& b) { return a.mean < b.mean; };
+    std::sort(buffer_.begin(), buffer_.end(), less);
+    scratch_.clear();
+    std::merge(centroids_.begin(), centroids_.end(), buffer_.begin(), buffer_.end(), std::back_inserter(scratch_), less);
+    buffer_.clear();
+
+    const double total = total_weight_ + buffer_weight_;
+    // Largest cumulative weight the current centroid may reach: one unit of k further on
+    const double step = 2.0 * kPi / compression_;
+    auto limit_after = [total, step](double so_far) {
+        const double angle = std::asin(std::min(1.0, std::max(-1.0, 2.0 * so_far / total - 1.0))) + step;
+        return angle >= kPi / 2.0 ? total : total * 0.5 * (std::sin(angle) + 1.0);
+    };
+
+    centroids_.clear();
+    Centroid current = scratch_[0];
+    double so_far = 0.0;
+    double limit = limit_after(0.0);
+    for (size_t i = 1; i < scratch_.size(); ++i) {
+        const Centroid& next = scratch_[i];
+        if (so_far + current.weight + next.weight <= limit) {
+            const double weight = current.weight + next.weight;
+            current.mean += (next.mean - current.mean) * next.weight / weight;
+            current.weight = weight;
+        } else {
+            so_far += current.weight;
+            centroids_.push_back(current);
+            limit = limit_after(so_far);
+            current = next;
+        }
+    }
+    centroids_.push_back(current);
+
+    total_weight_ = total;
+    buffer_weight_ = 0.0;
+}
+
+double QuantileSketch::quantile(double q) {
+    compress();
+    if (centroids_.empty()) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    if (q <= 0.0) {
+        return min_;
+    }
+    if (q >= 1.0) {
+        return max_;
+    }
+    if (centroids_.size() == 1) {
+        return centroids_[0].mean;
+    }
+
+    // Each centroid's mass sits at its centre; interpolate between neighbouring
+    // centres, and from min / max over the outer half-centroids
+    const double target = q * total_weight_;
+    const Centroid& first = centroids_.front();
+    if (target < first.weight / 2.0) {
+        return min_ + (first.mean - min_) * target / (first.weight / 2.0);
+    }
+    double cumulative = 0.0;
+    for (size_t i = 0; i + 1 < centroids_.size(); ++i) {
+        const Centroid& left = centroids_[i];
+        const Centroid& right = centroids_[i + 1];
+        const double left_centre = cumulative + left.weight / 2.0;
+        const double right_centre = cumulative + left.weight + right.weight / 2.0;
+        if (target < right_centre) {
+            const double t = (target - left_centre) / (right_centre - left_centre);
+            return left.mean + t * (right.mean - left.mean);
+        }
+        cumulative += left.weight;
+    }
+    const Centroid& last = centroids_.back();
+    const double t = (target - (total_weight_ - last.weight / 2.0)) / (last.weight / 2.0);
+    return last.mean + std::min(1.0, t) * (max_ - last.mean);
+}
+
+void QuantileSketch::serialize(std::string& out) {
+    compress();
+    append_raw(out, compression_);
+    append_raw(out, min_);
+    append_raw(out, max_);
+    append_raw(out, static_cast<uint64_t>(centroids_.size()));
+    for (const Centroid& c : centroids_) {
+        append_raw(out, c.mean);
+        append_raw(out, c.weight);
+    }
+}
+
+bool QuantileSketch::deserialize(const char*& p, const char* end) {
+    clear();
+    double compression = 0.0, lo = 0.0, hi = 0.0;
+    uint64_t count = 0;
+    if (!read_raw(p, end, compression) || !read_raw(p, end, lo) || !read_raw(p, end, hi) || !read_raw(p, end, count)) {
+        return false;
+    }
+    if (!(compression > 0.0) || count > static_cast<size_t>(end - p) / (2 * sizeof(double))) {
+        return false;
+    }
+
+    compression_ = compression;
+    buffer_limit_ = static_cast<size_t>(compression_) * 5;
+    double previous = -std::numeric_limits<double>::infinity();
+    for (uint64_t i = 0; i < count; ++i) {
+        Centroid c;
+        read_raw(p, end, c.mean);
+        read_raw(p, end, c.weight);
+        if (!std::isfinite(c.mean) || !(c.weight > 0.0) || c.mean < previous) {
+            clear();
+            return false;
+        }
+        previous = c.mean;
+        centroids_.push_back(c);
+        total_weight_ += c.weight;
+    }
+    if (count > 0) {
+        min_ = lo;
+        max_ = hi;
+    }
+    return true;
+}
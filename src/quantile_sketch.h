@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Merging t-digest (Dunning): a mergeable streaming quantile sketch.
+//
+// Values are appended to a small buffer. When the buffer fills, it is sorted
+// and merged with the existing centroids under the k1 scale function,
+// k(q) = compression / (2 pi) * asin(2q - 1). Centroids stay small near the
+// tails, so p99 is accurate to a fraction of a percent of rank. The sketch
+// holds at most ~compression centroids plus the buffer, however many values
+// it has seen.
+class QuantileSketch {
+public:
+    explicit QuantileSketch(double compression = 100.0);
+
+    void add(double value, double weight = 1.0);
+    // Fold another sketch in; the result approximates the union of both streams
+    void merge(const QuantileSketch& other);
+
+    // q in [0, 1]; NaN when empty. Non-const: flushes the buffer first.
+    double quantile(double q);
+
+    double count() const { return total_weight_ + buffer_weight_; }
+    bool empty() const { return count() == 0.0; }
+    double min() const { return min_; }
+    double max() const { return max_; }
+    double compression() const { return compression_; }
+    size_t centroid_count() const { return centroids_.size(); }
+    void clear();
+
+    // Flush the buffer into the centroids (done lazily by quantile() and serialize())
+    void compress();
+
+    // Binary form in host byte order: compression, min, max, centroid count, then
+    // (mean, weight) pairs. deserialize advances `p` and returns false on
+    // truncated or invalid input, leaving the sketch cleared.
+    void serialize(std::string& out);
+    bool deserialize(const char*& p, const char* end);
+
+private:
+    struct Centroid {
+        double mean;
+        double weight;
+    };
+
+    double compression_;
+    size_t buffer_limit_;
+    std::vector<Centroid> centroids_;   // sorted by mean
+    std::vector<Centroid> buffer_;      // unsorted pending values
+    std::vector<Centroid> scratch_;     // reused by compress()
+    double total_weight_;               // in centroids_
+    double buffer_weight_;
+    double min_;
+    double max_;
+};
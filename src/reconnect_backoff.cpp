@@ -0,0 +1,20 @@
+#include "reconnect_backoff.h"
+#include <algorithm>
+#include <cmath>
+
+ReconnectBackoff::ReconnectBackoff(const BackoffConfig& config, uint64_t seed)
+    : config_(config), attempts_(0), rng_(seed != 0 ? seed : std::random_device{}()) {
+    config_.initial_ms = std::max<int64_t>(config_.initial_ms, 1);
+    config_.max_ms = std::max(config_.max_ms, config_.initial_ms);
+    config_.multiplier = std::max(config_.multiplier, 1.0);
+    config_.jitter = std::min(std::max(config_.jitter, 0.0), 1.0);
+}
+
+int64_t ReconnectBackoff::next_delay_ms() {
+    // Exponent capped so the base cannot overflow before it is clamped to max_ms
+    const double growth = std::pow(config_.multiplier, std::min<uint32_t>(attempts_, 62));
+    const double base = std::min(static_cast<double>(config_.max_ms), config_.initial_ms * growth);
+    ++attempts_;
+    std::uniform_real_distribution<double> spread(0.0, base * config_.jitter);
+    return static_cast<int64_t>(base * (1.0 - config_.jitter) + spread(rng_));
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+#include <random>
+
+struct BackoffConfig {
+    int64_t initial_ms = 250;
+    int64_t max_ms = 30000;
+    double multiplier = 2.0;
+    double jitter = 0.5;   // fraction of each delay drawn at random, in [0, 1]
+};
+
+// Exponential reconnect delays with jitter.
+//
+// Attempt n (from 0) has a base delay of min(max_ms, initial_ms * multiplier^n).
+// The delay returned is base * (1 - jitter) plus a uniform draw from
+// [0, base * jitter]. Clients dropped together by one outage then spread
+// their reconnects out instead of arriving at the server in lockstep.
+class ReconnectBackoff {
+public:
+    explicit ReconnectBackoff(const BackoffConfig& config = BackoffConfig(), uint64_t seed = 0);   // 0 = random seed
+
+    int64_t next_delay_ms();
+    // Back to initial_ms after a connection that stayed up
+    void reset() { attempts_ = 0; }
+    uint32_t attempts() const { return attempts_; }
+
+private:
+    BackoffConfig config_;
+    uint32_t attempts_;
+    std::mt19937_64 rng_;
+};
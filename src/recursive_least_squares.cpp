@@ -0,0 +1,84 @@
+#include "recursive_least_squares.h"
+#include <algorithm>
+#include <utility>
+
+RecursiveLeastSquares::RecursiveLeastSquares(size_t features, double forgetting, double initial_covariance,
+                                             std::vector<double> scales)
+    : forgetting_(forgetting), initial_covariance_(initial_covariance),
+      max_trace_(initial_covariance * static_cast<double>(features)), scales_(std::move(scales)),
+      theta_(features, 0.0), p_(features * features, 0.0), x_(features), px_(features), observations_(0) {
+    if (scales_.size() != features) {
+        scales_.assign(features, 1.0);
+    }
+    reset();
+}
+
+void RecursiveLeastSquares::reset() {
+    const size_t k = theta_.size();
+    std::fill(theta_.begin(), theta_.end(), 0.0);
+    std::fill(p_.begin(), p_.end(), 0.0);
+    for (size_t i = 0; i < k; ++i) {
+        p_[i * k + i] = initial_covariance_;
+    }
+    observations_ = 0;
+}
+
+double RecursiveLeastSquares::update(const double* x, double y) {
+    const size_t k = theta_.size();
+    double prediction = 0.0;
+    for (size_t i = 0; i < k; ++i) {
+        x_[i] = x[i] / scales_[i];
+        prediction += theta_[i] * x_[i];
+    }
+
+    // Px and the innovation variance f + x'Px
+    double denominator = forgetting_;
+    for (size_t i = 0; i < k; ++i) {
+        double sum = 0.0;
+        for (size_t j = 0; j < k; ++j) {
+            sum += p_[i * k + j] * x_[j];
+        }
+        px_[i] = sum;
+        denominator += x_[i] * sum;
+    }
+
+    // theta += K e with gain K = Px / (f + x'Px)
+    const double error = y - prediction;
+    for (size_t i = 0; i < k; ++i) {
+        theta_[i] += px_[i] / denominator * error;
+    }
+
+    // P = (P - Px Px' / (f + x'Px)) / f, kept symmetric
+    double trace = 0.0;
+    for (size_t i = 0; i < k; ++i) {
+        for (size_t j = i; j < k; ++j) {
+            const double value = (p_[i * k + j] - px_[i] * px_[j] / denominator) / forgetting_;
+            p_[i * k + j] = value;
+            p_[j * k + i] = value;
+        }
+        trace += p_[i * k + i];
+    }
+    if (trace > max_trace_) {
+        const double shrink = max_trace_ / trace;
+        for (double& value : p_) {
+            value *= shrink;
+        }
+    }
+
+    ++observations_;
+    return error;
+}
+
+double RecursiveLeastSquares::predict(const double* x) const {
+    double prediction = 0.0;
+    for (size_t i = 0; i < theta_.size(); ++i) {
+        prediction += theta_[i] * x[i] / scales_[i];
+    }
+    return prediction;
+}
+
+void RecursiveLeastSquares::coefficients(double* out) const {
+    for (size_t i = 0; i < theta_.size(); ++i) {
+        out[i] = theta_[i] / scales_[i];
+    }
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// Exponentially weighted recursive least squares.
+//
+// Fits y ~ theta . x one observation at a time in O(k^2) with no matrix
+// inversion. Observations are discounted by the forgetting factor (0 < f <= 1)
+// per update, so the fit has an effective memory of about 1 / (1 - f)
+// samples and follows regime changes. Features are divided by fixed scales
+// before the update to keep P well conditioned when raw features differ by
+// orders of magnitude. theta is reported in unscaled units. The trace of P is
+// capped so directions the data stops exciting cannot wind up under
+// forgetting.
+class RecursiveLeastSquares {
+public:
+    RecursiveLeastSquares(size_t features, double forgetting = 0.995, double initial_covariance = 1e4,
+                          std::vector<double> scales = {});
+
+    // Add one observation; x must have features() entries. Returns the a-priori error.
+    double update(const double* x, double y);
+
+    double predict(const double* x) const;
+    void coefficients(double* out) const;   // unscaled theta
+
+    size_t features() const { return theta_.size(); }
+    size_t observations() const { return observations_; }
+    double forgetting() const { return forgetting_; }
+    void reset();
+
+private:
+    double forgetting_;
+    double initial_covariance_;
+    double max_trace_;
+    std::vector<double> scales_;
+    std::vector<double> theta_;   // in scaled feature units
+    std::vector<double> p_;       // k x k covariance, row-major
+    std::vector<double> x_;       // scratch: scaled features
+    std::vector<double> px_;      // scratch: P x
+    size_t observations_;
+};
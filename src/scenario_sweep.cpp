@@ -0,0 +1,136 @@
+#include "scenario_sweep.h"
+#include "models.h"
+#include "coefficient_store.h"
+#include "work_stealing_pool.h"
+#include <algorithm>
+
+namespace {
+
+constexpr size_t kMissing = static_cast<size_t>(-1);
+
+// For each value of `axis`, its position in `previous` (kMissing if absent).
+// Axes are short and usually unchanged, so try the same position first.
+template <typename T>
+std::vector<size_t> match_axis(const std::vector<T>& axis, const std::vector<T>& previous) {
+    std::vector<size_t> match(axis.size(), kMissing);
+    for (size_t i = 0; i < axis.size(); ++i) {
+        if (i < previous.size() && previous[i] == axis[i]) {
+            match[i] = i;
+            continue;
+        }
+        auto it = std::find(previous.begin(), previous.end(), axis[i]);
+        if (it != previous.end()) {
+            match[i] = static_cast<size_t>(it - previous.begin());
+        }
+    }
+    return match;
+}
+
+} // namespace
+
+std::vector<double> ScenarioGrid::linspace(double lo, double hi, size_t steps) {
+    std::vector<double> values;
+    if (steps == 0) {
+        return values;
+    }
+    if (steps == 1) {
+        values.push_back(lo);
+        return values;
+    }
+    values.reserve(steps);
+    const double step = (hi - lo) / (steps - 1);
+    for (size_t i = 0; i + 1 < steps; ++i) {
+        values.push_back(lo + step * i);
+    }
+    values.push_back(hi);
+    return values;
+}
+
+ScenarioSweep::ScenarioSweep(WorkStealingPool& pool, size_t cells_per_task)
+    : pool_(pool), cells_per_task_(std::max<size_t>(cells_per_task, 1)), evaluated_(false) {}
+
+const ScenarioSurface& ScenarioSweep::run(Models& models, const ScenarioGrid& grid) {
+    ModelCoefficients c;
+    models.coefficients(c);
+    const bool same_model = evaluated_ && surface_.symbol == models.selected_symbol() &&
+                            surface_.coefficients_version == c.version;
+    if (same_model && grid.quantities == surface_.grid.quantities && grid.volatilities == surface_.grid.volatilities
+        && grid.fee_tiers == surface_.grid.fee_tiers) {
+        // Nothing moved: every cell is current
+        surface_.cells_computed = 0;
+        surface_.cells_reused = grid.size();
+        return surface_;
+    }
+
+    const size_t nq = grid.quantities.size();
+    const size_t nv = grid.volatilities.size();
+    const size_t nt = grid.fee_tiers.size();
+    std::vector<double>& net_cost = next_net_cost_;
+    std::vector<double>& maker_taker = next_maker_taker_;
+    net_cost.resize(grid.size());
+    maker_taker.resize(grid.size());
+    dirty_.clear();
+
+    if (same_model) {
+        // Carry over every cell whose axis values were in the previous grid
+        const ScenarioGrid& previous = surface_.grid;
+        const std::vector<size_t> mq = match_axis(grid.quantities, previous.quantities);
+        const std::vector<size_t> mv = match_axis(grid.volatilities, previous.volatilities);
+        const std::vector<size_t> mt = match_axis(grid.fee_tiers, previous.fee_tiers);
+        for (size_t t = 0; t < nt; ++t) {
+            for (size_t v = 0; v < nv; ++v) {
+                for (size_t q = 0; q < nq; ++q) {
+                    const size_t cell = grid.index(q, v, t);
+                    if (mq[q] == kMissing || mv[v] == kMissing || mt[t] == kMissing) {
+                        dirty_.push_back(cell);
+                        continue;
+                    }
+                    const size_t old = previous.index(mq[q], mv[v], mt[t]);
+                    net_cost[cell] = surface_.net_cost[old];
+                    maker_taker[cell] = surface_.maker_taker[old];
+                }
+            }
+        }
+    } else {
+        dirty_.resize(grid.size());
+        for (size_t cell = 0; cell < dirty_.size(); ++cell) {
+            dirty_[cell] = cell;
+        }
+    }
+
+    // Each chunk gathers its cells' axis values and goes through the batch API
+    pool_.parallel_for(0, dirty_.size(), cells_per_task_, [&](size_t lo, size_t hi) {
+        const size_t n = hi - lo;
+        std::vector<double> quantity(n), volatility(n), cost(n), proportion(n);
+        std::vector<int> fee_tier(n);
+        for (size_t i = 0; i < n; ++i) {
+            const size_t cell = dirty_[lo + i];
+            quantity[i] = grid.quantities[cell % nq];
+            volatility[i] = grid.volatilities[(cell / nq) % nv];
+            fee_tier[i] = grid.fee_tiers[cell / (nq * nv)];
+        }
+        models.calculate_net_cost_batch(quantity.data(), volatility.data(), fee_tier.data(), n, cost.data());
+        models.predict_maker_taker_proportion_batch(quantity.data(), volatility.data(), n, proportion.data());
+        for (size_t i = 0; i < n; ++i) {
+            net_cost[dirty_[lo + i]] = cost[i];
+            maker_taker[dirty_[lo + i]] = proportion[i];
+        }
+    });
+
+    surface_.grid = grid;
+    surface_.net_cost.swap(net_cost);
+    surface_.maker_taker.swap(maker_taker);
+    surface_.symbol = models.selected_symbol();
+    surface_.coefficients_version = c.version;
+    surface_.cells_computed = dirty_.size();
+    surface_.cells_reused = grid.size() - dirty_.size();
+    if (surface_.net_cost.empty()) {
+        surface_.min_net_cost = surface_.max_net_cost = 0.0;
+    } else {
+        const auto range = std::minmax_element(surface_.net_cost.begin(), surface_.net_cost.end());
+        surface_.min_net_cost = *range.first;
+        surface_.max_net_cost = *range.second;
+    }
+    evaluated_ = true;
+    return surface_;
+}
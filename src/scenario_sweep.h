@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "symbol_id.h"
+
+class Models;
+class WorkStealingPool;
+
+// Axes of a quantity x volatility x fee-tier scenario grid
+struct ScenarioGrid {
+    std::vector<double> quantities;
+    std::vector<double> volatilities;
+    std::vector<int> fee_tiers;
+
+    size_t size() const { return quantities.size() * volatilities.size() * fee_tiers.size(); }
+    // Dense layout: quantity fastest, then volatility, then fee tier
+    size_t index(size_t quantity, size_t volatility, size_t fee_tier) const {
+        return (fee_tier * volatilities.size() + volatility) * quantities.size() + quantity;
+    }
+
+    // `steps` evenly spaced values from lo to hi inclusive (one value when steps <= 1)
+    static std::vector<double> linspace(double lo, double hi, size_t steps);
+};
+
+// Net cost and maker/taker proportion over every grid cell, in ScenarioGrid::index order
+struct ScenarioSurface {
+    ScenarioGrid grid;
+    std::vector<double> net_cost;
+    std::vector<double> maker_taker;
+    double min_net_cost = 0.0;
+    double max_net_cost = 0.0;
+
+    SymbolId symbol = 0;
+    uint64_t coefficients_version = 0;   // model the cells were evaluated with
+    size_t cells_computed = 0;           // by the last run()
+    size_t cells_reused = 0;
+};
+
+// Parallel sweep of Models::calculate_net_cost and the maker/taker model over
+// a scenario grid.
+//
+// Cells to evaluate are dealt to the pool in chunks. Each chunk gathers its
+// inputs into struct-of-arrays buffers and goes through the batch model API.
+// Between runs a cell is reused when its three axis values, the selected
+// symbol and the coefficient version are all unchanged. New book versions
+// alone do not change the models' outputs over a fixed grid, so
+// steady-state sweeps only redo the rows and columns that were edited, or
+// everything after a recalibration. A run with the same axes, symbol and
+// coefficient version returns the previous surface without touching it, and
+// the grid-sized buffers are reused between runs. Cells match the per-order methods
+// within Models::kBatchTolerance; for a given cells_per_task the surface is
+// bit-identical on any number of threads.
+class ScenarioSweep {
+public:
+    explicit ScenarioSweep(WorkStealingPool& pool, size_t cells_per_task = 256);
+
+    const ScenarioSurface& run(Models& models, const ScenarioGrid& grid);
+    const ScenarioSurface& surface() const { return surface_; }
+
+private:
+    WorkStealingPool& pool_;
+    size_t cells_per_task_;
+    ScenarioSurface surface_;
+    bool evaluated_;
+    std::vector<size_t> dirty_;   // cell indices to evaluate this run
+    // Filled by run() and swapped with the surface's, so neither reallocates
+    std::vector<double> next_net_cost_;
+    std::vector<double> next_maker_taker_;
+};
@@ -0,0 +1,148 @@
+#include "slippage_calibrator.h"
+#include "logger.h"
+#include <chrono>
+#include <cmath>
+#include <utility>
+
+namespace {
+
+const size_t kFeatures = 3;   // [1, quantity, volatility]
+
+} // namespace
+
+SlippageCalibrator::SymbolState::SymbolState(const CalibrationConfig& config)
+    // Scales bring quantity (~1e4 quote) and volatility (~1e-3 per second) to O(1)
+    : fit(kFeatures, config.forgetting, config.initial_covariance, {1.0, 1e4, 1e-3}) {}
+
+SlippageCalibrator::SlippageCalibrator(const BookRegistry& registry, CoefficientStore& store, CalibrationConfig config)
+    : registry_(registry), store_(store), quantiles_(nullptr), config_(std::move(config)), running_(false) {
+    for (size_t i = 0; i < registry_.size(); ++i) {
+        symbols_.emplace_back(new SymbolState(config_));
+    }
+}
+
+SlippageCalibrator::~SlippageCalibrator() {
+    stop();
+}
+
+void SlippageCalibrator::start() {
+    if (running_.exchange(true)) {
+        return;
+    }
+    worker_ = std::thread([this]() { run(); });
+}
+
+void SlippageCalibrator::stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
+
+void SlippageCalibrator::run() {
+    auto last_publish = std::chrono::steady_clock::now();
+    while (running_.load(std::memory_order_relaxed)) {
+        poll();
+        const auto now = std::chrono::steady_clock::now();
+        if (now - last_publish >= std::chrono::milliseconds(config_.publish_interval_ms)) {
+            publish();
+            last_publish = now;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(config_.poll_interval_ms));
+    }
+}
+
+size_t SlippageCalibrator::poll() {
+    size_t added = 0;
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (SymbolId id = 0; id < symbols_.size(); ++id) {
+        added += poll_symbol(id, *symbols_[id]);
+    }
+    if (quantiles_ && added > 0) {
+        quantiles_->publish();
+    }
+    return added;
+}
+
+size_t SlippageCalibrator::poll_symbol(SymbolId id, SymbolState& state) {
+    registry_.book(id).read_snapshot(snapshot_);
+    if (!state.engine.update(snapshot_) || !(state.engine.mid() > 0.0)) {
+        return 0;
+    }
+
+    // The same live estimate the models are evaluated with
+    const double volatility = registry_.volatility(id).model_volatility();
+    size_t added = 0;
+    for (double notional : config_.probe_notionals) {
+        for (OrderSide side : {OrderSide::Buy, OrderSide::Sell}) {
+            const ExecutionEstimate estimate = state.engine.estimate(side, notional);
+            if (!estimate.fully_filled) {
+                continue;   // beyond visible depth: slippage is not observed
+            }
+            const double x[kFeatures] = {1.0, notional, volatility};
+            state.fit.update(x, estimate.slippage);
+            if (quantiles_) {
+                quantiles_->add(id, notional, volatility, estimate.slippage);
+            }
+            ++added;
+        }
+    }
+    return added;
+}
+
+void SlippageCalibrator::observe(SymbolId symbol, double quantity, double volatility, double slippage) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (symbol >= symbols_.size()) {
+        return;
+    }
+    const double x[kFeatures] = {1.0, quantity, volatility};
+    symbols_[symbol]->fit.update(x, slippage);
+    if (quantiles_) {
+        quantiles_->add(symbol, quantity, volatility, slippage);
+        quantiles_->publish();
+    }
+}
+
+void SlippageCalibrator::set_quantile_model(SlippageQuantileModel* quantiles) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    quantiles_ = quantiles;
+}
+
+size_t SlippageCalibrator::publish() {
+    size_t published = 0;
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (SymbolId id = 0; id < symbols_.size(); ++id) {
+        const RecursiveLeastSquares& fit = symbols_[id]->fit;
+        if (fit.observations() < config_.min_observations) {
+            continue;
+        }
+        double theta[kFeatures];
+        fit.coefficients(theta);
+        if (!std::isfinite(theta[0]) || !std::isfinite(theta[1]) || !std::isfinite(theta[2])) {
+            LOG_WARN("[Calibration] Non-finite slippage fit for symbol {}; not published", id);
+            continue;
+        }
+
+        ModelCoefficients coefficients = store_.read(id);
+        coefficients.slippage_intercept = theta[0];
+        coefficients.slippage_quantity = theta[1];
+        coefficients.slippage_volatility = theta[2];
+        const uint64_t version = store_.publish(id, coefficients);
+        LOG_DEBUG("[Calibration] Symbol {} slippage model v{}: {} + {} * q + {} * vol",
+                  id, version, theta[0], theta[1], theta[2]);
+        ++published;
+    }
+    return published;
+}
+
+size_t SlippageCalibrator::observations(SymbolId symbol) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return symbol < symbols_.size() ? symbols_[symbol]->fit.observations() : 0;
+}
+
+double SlippageCalibrator::volatility(SymbolId symbol) const {
+    return symbol < registry_.size() ? registry_.volatility(symbol).model_volatility()
+                                     : model_coefficients::kDefaultVolatility;
+}
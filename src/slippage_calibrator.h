@@ -0,0 +1,84 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "book_registry.h"
+#include "coefficient_store.h"
+#include "execution_cost.h"
+#include "recursive_least_squares.h"
+#include "slippage_quantiles.h"
+
+struct CalibrationConfig {
+    double forgetting = 0.995;   // ~200-observation memory
+    double initial_covariance = 1e4;
+    // Order sizes (quote currency) priced against each new book, both sides
+    std::vector<double> probe_notionals = {1000.0, 5000.0, 10000.0, 50000.0, 100000.0};
+    int poll_interval_ms = 100;
+    int publish_interval_ms = 1000;
+    size_t min_observations = 50;   // per symbol, before its first publication
+};
+
+// Online calibration of the slippage regression
+//     slippage = intercept + b_q * quantity + b_v * volatility
+// from the live books.
+//
+// A background thread polls each symbol's published snapshot (lock-free
+// seqlock read). When the book version has moved, it prices the probe orders
+// with the depth-walk engine. Each realized slippage becomes one RLS
+// observation with a forgetting factor, so the fit follows regime changes.
+// Volatility is the symbol's live EWMA estimate from the registry.
+// Coefficients are published to the CoefficientStore every
+// publish interval; the impact and maker/taker fields of the current block
+// are carried over unchanged.
+class SlippageCalibrator {
+public:
+    SlippageCalibrator(const BookRegistry& registry, CoefficientStore& store, CalibrationConfig config = CalibrationConfig());
+    ~SlippageCalibrator();
+
+    void start();
+    void stop();
+
+    // One pass over every symbol; returns observations added. The thread
+    // calls this, and tests can drive it directly without start().
+    size_t poll();
+    // Publish symbols with enough observations; returns symbols published
+    size_t publish();
+
+    // External observation, e.g. a realized fill: slippage as a fraction of mid
+    void observe(SymbolId symbol, double quantity, double volatility, double slippage);
+
+    // Optional: also feed every observation into a quantile model, republished after each poll
+    void set_quantile_model(SlippageQuantileModel* quantiles);
+
+    size_t observations(SymbolId symbol) const;
+    // Volatility the probes are priced at (the models' fallback before the first return)
+    double volatility(SymbolId symbol) const;
+
+private:
+    struct SymbolState {
+        ExecutionCostEngine engine;
+        RecursiveLeastSquares fit;
+
+        explicit SymbolState(const CalibrationConfig& config);
+    };
+
+    const BookRegistry& registry_;
+    CoefficientStore& store_;
+    SlippageQuantileModel* quantiles_;
+    CalibrationConfig config_;
+    BookSnapshot snapshot_;   // scratch, reused across polls
+
+    mutable std::mutex mutex_;   // calibrator thread vs observe()/publish() callers
+    std::vector<std::unique_ptr<SymbolState>> symbols_;
+
+    std::thread worker_;
+    std::atomic<bool> running_;
+
+    void run();
+    size_t poll_symbol(SymbolId id, SymbolState& state);
+};
@@ -0,0 +1,216 @@
+#include "slippage_quantiles.h"
+#include "logger.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <utility>
+
+namespace {
+
+const char kMagic[8] = {'T', 'S', 'Q', 'S', 'K', 'T', '0', '1'};
+
+void append_u64(std::string& out, uint64_t value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+bool read_u64(const char*& p, const char* end, uint64_t& value) {
+    if (static_cast<size_t>(end - p) < sizeof(value)) {
+        return false;
+    }
+    std::memcpy(&value, p, sizeof(value));
+    p += sizeof(value);
+    return true;
+}
+
+size_t edge_bucket(const std::vector<double>& edges, double value) {
+    return static_cast<size_t>(std::upper_bound(edges.begin(), edges.end(), value) - edges.begin());
+}
+
+} // namespace
+
+SlippageQuantileModel::SlippageQuantileModel(size_t symbols, SlippageQuantileConfig config)
+    : config_(std::move(config)), symbols_(symbols),
+      buckets_per_symbol_((config_.size_edges.size() + 1) * (config_.volatility_edges.size() + 1)),
+      sketches_(symbols_ * buckets_per_symbol_, QuantileSketch(config_.compression)),
+      dirty_(symbols_ * buckets_per_symbol_, 0),
+      published_(new Published[symbols_ * buckets_per_symbol_]) {}
+
+size_t SlippageQuantileModel::bucket(double quantity, double volatility) const {
+    return edge_bucket(config_.size_edges, quantity) * volatility_buckets()
+         + edge_bucket(config_.volatility_edges, volatility);
+}
+
+void SlippageQuantileModel::add(SymbolId symbol, double quantity, double volatility, double slippage) {
+    if (symbol >= symbols_) {
+        return;
+    }
+    const size_t index = symbol * buckets_per_symbol_ + bucket(quantity, volatility);
+    std::lock_guard<std::mutex> lock(mutex_);
+    sketches_[index].add(slippage);
+    dirty_[index] = 1;
+}
+
+size_t SlippageQuantileModel::publish() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return publish_locked();
+}
+
+size_t SlippageQuantileModel::publish_locked() {
+    size_t refreshed = 0;
+    for (size_t i = 0; i < sketches_.size(); ++i) {
+        if (!dirty_[i]) {
+            continue;
+        }
+        dirty_[i] = 0;
+        QuantileSketch& sketch = sketches_[i];
+        SlippageQuantiles q;
+        if (!sketch.empty()) {
+            q.p50 = sketch.quantile(0.50);
+            q.p90 = sketch.quantile(0.90);
+            q.p99 = sketch.quantile(0.99);
+            q.count = static_cast<uint64_t>(sketch.count());
+        }
+
+        Published& slot = published_[i];
+        const uint64_t seq = slot.seq.load(std::memory_order_relaxed);
+        slot.seq.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.data = q;
+        slot.seq.store(seq + 2, std::memory_order_release);
+        ++refreshed;
+    }
+    return refreshed;
+}
+
+SlippageQuantiles SlippageQuantileModel::quantiles(SymbolId symbol, double quantity, double volatility) const {
+    if (symbol >= symbols_) {
+        return SlippageQuantiles();
+    }
+    const Published& slot = published_[symbol * buckets_per_symbol_ + bucket(quantity, volatility)];
+    while (true) {
+        const uint64_t before = slot.seq.load(std::memory_order_acquire);
+        if (before & 1) {
+            std::this_thread::yield();
+            continue;
+        }
+        const SlippageQuantiles out = slot.data;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.seq.load(std::memory_order_relaxed) == before) {
+            return out;
+        }
+    }
+}
+
+double SlippageQuantileModel::quantile(SymbolId symbol, double quantity, double volatility, double q) {
+    if (symbol >= symbols_) {
+        return 0.0;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    return sketches_[symbol * buckets_per_symbol_ + bucket(quantity, volatility)].quantile(q);
+}
+
+bool SlippageQuantileModel::merge(const SlippageQuantileModel& other) {
+    if (&other == this || other.symbols_ != symbols_ || other.config_.size_edges != config_.size_edges
+        || other.config_.volatility_edges != config_.volatility_edges) {
+        return false;
+    }
+    std::scoped_lock lock(mutex_, other.mutex_);
+    for (size_t i = 0; i < sketches_.size(); ++i) {
+        if (!other.sketches_[i].empty()) {
+            sketches_[i].merge(other.sketches_[i]);
+            dirty_[i] = 1;
+        }
+    }
+    publish_locked();
+    return true;
+}
+
+// Layout: magic | symbols | size edge count | edges | volatility edge count |
+// edges | one serialized sketch per bucket, in index order
+bool SlippageQuantileModel::save(const std::string& path) {
+    std::string out(kMagic, sizeof(kMagic));
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        append_u64(out, symbols_);
+        for (const std::vector<double>* edges : {&config_.size_edges, &config_.volatility_edges}) {
+            append_u64(out, edges->size());
+            out.append(reinterpret_cast<const char*>(edges->data()), edges->size() * sizeof(double));
+        }
+        for (QuantileSketch& sketch : sketches_) {
+            sketch.serialize(out);
+        }
+    }
+
+    // Write a sibling file and rename it over the old snapshot, so a crash
+    // mid-write never leaves a truncated file behind
+    const std::string temp = path + ".tmp";
+    std::FILE* file = std::fopen(temp.c_str(), "wb");
+    if (!file) {
+        LOG_WARN("[Quantiles] Could not write {}", temp);
+        return false;
+    }
+    const bool written = std::fwrite(out.data(), 1, out.size(), file) == out.size();
+    const bool closed = std::fclose(file) == 0;
+#ifdef _WIN32
+    std::remove(path.c_str());   // rename does not replace on Windows
+#endif
+    if (!written || !closed || std::rename(temp.c_str(), path.c_str()) != 0) {
+        std::remove(temp.c_str());
+        LOG_WARN("[Quantiles] Could not write {}", path);
+        return false;
+    }
+    return true;
+}
+
+bool SlippageQuantileModel::load(const std::string& path) {
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        return false;
+    }
+    std::string data;
+    char chunk[65536];
+    size_t n;
+    while ((n = std::fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        data.append(chunk, n);
+    }
+    std::fclose(file);
+
+    const char* p = data.data();
+    const char* end = p + data.size();
+    if (data.size() < sizeof(kMagic) || std::memcmp(p, kMagic, sizeof(kMagic)) != 0) {
+        LOG_WARN("[Quantiles] {} is not a quantile snapshot", path);
+        return false;
+    }
+    p += sizeof(kMagic);
+
+    uint64_t symbols = 0;
+    bool ok = read_u64(p, end, symbols) && symbols == symbols_;
+    for (const std::vector<double>* edges : {&config_.size_edges, &config_.volatility_edges}) {
+        uint64_t count = 0;
+        ok = ok && read_u64(p, end, count) && count == edges->size()
+             && static_cast<size_t>(end - p) >= count * sizeof(double)
+             && std::memcmp(p, edges->data(), count * sizeof(double)) == 0;
+        if (ok) {
+            p += count * sizeof(double);
+        }
+    }
+    if (!ok) {
+        LOG_WARN("[Quantiles] {} has a different bucket grid; ignored", path);
+        return false;
+    }
+
+    std::vector<QuantileSketch> restored(sketches_.size(), QuantileSketch(config_.compression));
+    for (QuantileSketch& sketch : restored) {
+        if (!sketch.deserialize(p, end)) {
+            LOG_WARN("[Quantiles] {} is truncated or corrupt; ignored", path);
+            return false;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    sketches_ = std::move(restored);
+    std::fill(dirty_.begin(), dirty_.end(), 1);
+    publish_locked();
+    return true;
+}
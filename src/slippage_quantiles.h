@@ -0,0 +1,83 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "symbol_id.h"
+#include "quantile_sketch.h"
+
+struct SlippageQuantileConfig {
+    double compression = 100.0;
+    // Upper edges of the order-size (quote notional) and volatility (sigma per
+    // sqrt second) buckets; values past the last edge fall in one more bucket
+    std::vector<double> size_edges = {2500.0, 7500.0, 25000.0, 75000.0};
+    std::vector<double> volatility_edges = {5e-5, 1e-4, 2e-4, 4e-4};
+};
+
+struct SlippageQuantiles {
+    double p50 = 0.0;
+    double p90 = 0.0;
+    double p99 = 0.0;
+    uint64_t count = 0;   // observations in the bucket; 0 means no estimate yet
+};
+
+// Conditional slippage distribution per symbol x order-size bucket x
+// volatility bucket, each held in a t-digest.
+//
+// Observations (the depth-walk results from the calibrator) go in under a
+// mutex. publish() recomputes p50/p90/p99 for the buckets that changed and
+// writes them into a per-bucket seqlock. quantiles() is then an
+// edge search plus a lock-free copy, with no sketch walk. Memory is fixed by
+// the bucket grid and the compression, however long the process runs.
+// Sketches merge bucket-wise and can be saved to and loaded from a file, so
+// a restart keeps the learned distribution.
+class SlippageQuantileModel {
+public:
+    explicit SlippageQuantileModel(size_t symbols, SlippageQuantileConfig config = SlippageQuantileConfig());
+
+    SlippageQuantileModel(const SlippageQuantileModel&) = delete;
+    SlippageQuantileModel& operator=(const SlippageQuantileModel&) = delete;
+
+    void add(SymbolId symbol, double quantity, double volatility, double slippage);
+    // Refresh the published quantiles of changed buckets; returns buckets refreshed
+    size_t publish();
+
+    // Lock-free; count == 0 for unknown symbols and empty buckets
+    SlippageQuantiles quantiles(SymbolId symbol, double quantity, double volatility) const;
+    // Any quantile straight from the sketch (takes the writer lock)
+    double quantile(SymbolId symbol, double quantity, double volatility, double q);
+
+    // Fold in another model with the same symbols and bucket edges
+    bool merge(const SlippageQuantileModel& other);
+
+    // Snapshot to / restore from a file. load() rejects files whose grid
+    // differs from this model's and leaves the model unchanged.
+    bool save(const std::string& path);
+    bool load(const std::string& path);
+
+    size_t symbols() const { return symbols_; }
+    size_t size_buckets() const { return config_.size_edges.size() + 1; }
+    size_t volatility_buckets() const { return config_.volatility_edges.size() + 1; }
+    size_t bucket(double quantity, double volatility) const;   // within one symbol
+
+private:
+    struct alignas(64) Published {
+        std::atomic<uint64_t> seq{0};   // odd while being written
+        SlippageQuantiles data;
+    };
+
+    SlippageQuantileConfig config_;
+    size_t symbols_;
+    size_t buckets_per_symbol_;
+
+    mutable std::mutex mutex_;   // sketches and dirty flags
+    std::vector<QuantileSketch> sketches_;   // [symbol][size bucket][volatility bucket]
+    std::vector<uint8_t> dirty_;
+    std::unique_ptr<Published[]> published_;
+
+    size_t publish_locked();
+};
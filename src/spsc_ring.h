@@ -0,0 +1,123 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Bounded single-producer / single-consumer ring of pre-allocated slots.
+//
+// The producer claims the next free slot, fills it in place and publishes it;
+// the consumer reads the oldest slot in place and pops it. Slots are reused,
+// so types that own buffers (std::string, std::vector) stop allocating once
+// they have grown to the largest message seen. Head and tail live on separate
+// cache lines and each side caches the other's index to avoid cross-core
+// traffic on every operation.
+template <typename T>
+class SpscRing {
+public:
+    explicit SpscRing(size_t capacity)
+        : slots_(round_up_pow2(capacity)), mask_(slots_.size() - 1),
+          head_(0), cached_tail_(0), tail_(0), cached_head_(0), stalled_(false), closed_(false),
+          high_water_mark_(0), full_events_(0), full_claims_(0), dropped_(0) {}
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    // Producer side: nullptr when the ring is full. A run of failed claims
+    // (a producer waiting for room) counts as one full event.
+    T* claim() {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - cached_head_ == slots_.size()) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            if (tail - cached_head_ == slots_.size()) {
+                // Single writer: plain load + store, no locked RMW
+                full_claims_.store(full_claims_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                if (!stalled_) {
+                    stalled_ = true;
+                    full_events_.store(full_events_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                }
+                return nullptr;
+            }
+        }
+        stalled_ = false;
+        return &slots_[tail & mask_];
+    }
+
+    void publish() {
+        const size_t tail = tail_.load(std::memory_order_relaxed) + 1;
+        tail_.store(tail, std::memory_order_release);
+        // cached_head_ may be stale and overstate the depth; re-read head_
+        // only when it would set a new peak, which is rare once warmed up
+        const size_t peak = high_water_mark_.load(std::memory_order_relaxed);
+        if (tail - cached_head_ > peak) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            if (tail - cached_head_ > peak) {
+                high_water_mark_.store(tail - cached_head_, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Producer side: count a message given up on (see closed())
+    void drop() {
+        stalled_ = false;
+        dropped_.store(dropped_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    // Consumer side: whether anyone will drain the ring. A producer waiting
+    // on a full, closed ring should drop instead of waiting forever.
+    void close() { closed_.store(true, std::memory_order_release); }
+    void open() { closed_.store(false, std::memory_order_release); }
+    bool closed() const { return closed_.load(std::memory_order_acquire); }
+
+    // Consumer side: nullptr when the ring is empty
+    T* front() {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if (head == cached_tail_) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            if (head == cached_tail_) {
+                return nullptr;
+            }
+        }
+        return &slots_[head & mask_];
+    }
+
+    void pop() {
+        head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // Approximate when read from a third thread
+    size_t size() const {
+        return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+    }
+    size_t capacity() const { return slots_.size(); }
+    size_t high_water_mark() const { return high_water_mark_.load(std::memory_order_relaxed); }
+    uint64_t full_events() const { return full_events_.load(std::memory_order_relaxed); }
+    uint64_t full_claims() const { return full_claims_.load(std::memory_order_relaxed); }
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+    // Direct slot access for pre-sizing buffers before the ring is in use
+    T& slot(size_t index) { return slots_[index]; }
+
+private:
+    static size_t round_up_pow2(size_t n) {
+        size_t p = 1;
+        while (p < n) p <<= 1;
+        return p;
+    }
+
+    std::vector<T> slots_;
+    const size_t mask_;
+
+    alignas(64) std::atomic<size_t> head_;   // written by the consumer
+    size_t cached_tail_;                     // consumer's view of tail_
+    alignas(64) std::atomic<size_t> tail_;   // written by the producer
+    size_t cached_head_;                     // producer's view of head_
+    bool stalled_;                           // producer: last claim failed
+    std::atomic<bool> closed_;               // set by the consumer side
+    // Producer-written counters, readable from any thread
+    std::atomic<size_t> high_water_mark_;    // peak depth seen at publish
+    std::atomic<uint64_t> full_events_;      // times the producer found the ring full
+    std::atomic<uint64_t> full_claims_;      // failed claims, including retries
+    std::atomic<uint64_t> dropped_;          // messages given up on a closed ring
+};
@@ -0,0 +1,6 @@
+#pragma once
+
+#include <cstdint>
+
+// Dense instrument id assigned by BookRegistry::add_symbol
+using SymbolId = uint32_t;
@@ -0,0 +1,218 @@
+#include "synthetic_feed.h"
+#include "orderbook.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Sizes are whole lots of 0.001
+constexpr int kLotDecimals = 3;
+constexpr uint32_t kMaxLots = 5000;
+
+const int64_t kPow10[] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000};
+
+} // namespace
+
+std::string synthetic_symbol_name(size_t index) {
+    return "SYN-" + std::to_string(index);
+}
+
+SyntheticFeed::SyntheticFeed(const SyntheticFeedConfig& config, size_t symbol_index)
+    : config_(config),
+      symbol_(synthetic_symbol_name(symbol_index)),
+      rng_(config.seed + symbol_index * 0x9E3779B97F4A7C15ULL),
+      deltas_since_snapshot_(0),
+      sequence_(0),
+      price_decimals_(0),
+      tick_units_(1) {
+    if (!(config_.tick_size > 0.0)) {
+        config_.tick_size = 0.1;
+    }
+    // Fewest decimals that print the tick exactly
+    for (int d = 0; d <= 9; ++d) {
+        const double scaled = config_.tick_size * kPow10[d];
+        price_decimals_ = d;
+        tick_units_ = std::max<int64_t>(std::llround(scaled), 1);
+        if (std::fabs(scaled - std::round(scaled)) < 1e-9 * std::max(1.0, scaled)) {
+            break;
+        }
+    }
+
+    const size_t depth = std::min(std::max<size_t>(config_.depth, 1), BookSnapshot::kMaxDepth);
+    const double start = config_.start_price * static_cast<double>(symbol_index + 1);
+    best_bid_tick_ = std::max<int64_t>(std::llround(start / config_.tick_size), static_cast<int64_t>(depth) + 1);
+
+    ask_lots_.resize(depth);
+    bid_lots_.resize(depth);
+    for (size_t i = 0; i < depth; ++i) {
+        ask_lots_[i] = random_lots();
+        bid_lots_[i] = random_lots();
+    }
+    ask_changes_.reserve(depth);
+    bid_changes_.reserve(depth);
+    buffer_.reserve(std::max<size_t>(config_.min_message_bytes, depth * 2 * 24 + 256));
+}
+
+double SyntheticFeed::price_of(int64_t tick) const {
+    return static_cast<double>(tick * tick_units_) / static_cast<double>(kPow10[price_decimals_]);
+}
+
+uint32_t SyntheticFeed::random_lots() {
+    return 1 + static_cast<uint32_t>(rng_() % kMaxLots);
+}
+
+const std::string& SyntheticFeed::next(int64_t ts_ms) {
+    if (sequence_ == 0 || (config_.snapshot_every > 0 && deltas_since_snapshot_ >= config_.snapshot_every)) {
+        return snapshot(ts_ms);
+    }
+    advance();
+    ++deltas_since_snapshot_;
+    write(false, ts_ms);
+    return buffer_;
+}
+
+const std::string& SyntheticFeed::snapshot(int64_t ts_ms) {
+    ask_changes_.clear();
+    bid_changes_.clear();
+    for (size_t i = 0; i < ask_lots_.size(); ++i) {
+        ask_changes_.push_back({best_bid_tick_ + 1 + static_cast<int64_t>(i), ask_lots_[i]});
+        bid_changes_.push_back({best_bid_tick_ - static_cast<int64_t>(i), bid_lots_[i]});
+    }
+    deltas_since_snapshot_ = 0;
+    write(true, ts_ms);
+    return buffer_;
+}
+
+void SyntheticFeed::advance() {
+    ask_changes_.clear();
+    bid_changes_.clear();
+    const int64_t depth = static_cast<int64_t>(ask_lots_.size());
+
+    std::uniform_real_distribution<double> coin(0.0, 1.0);
+    if (coin(rng_) < config_.move_probability) {
+        const bool up = (rng_() & 1) != 0;
+        if (up) {
+            // The best ask becomes the best bid; the deepest bid falls off the ladder
+            ask_changes_.push_back({best_bid_tick_ + 1, 0});
+            bid_changes_.push_back({best_bid_tick_ - depth + 1, 0});
+            ++best_bid_tick_;
+            std::rotate(ask_lots_.begin(), ask_lots_.begin() + 1, ask_lots_.end());
+            std::rotate(bid_lots_.rbegin(), bid_lots_.rbegin() + 1, bid_lots_.rend());
+            ask_lots_.back() = random_lots();
+            bid_lots_.front() = random_lots();
+            ask_changes_.push_back({best_bid_tick_ + depth, ask_lots_.back()});
+            bid_changes_.push_back({best_bid_tick_, bid_lots_.front()});
+        } else if (best_bid_tick_ > depth) {
+            // Mirror image; the floor keeps every price positive
+            bid_changes_.push_back({best_bid_tick_, 0});
+            ask_changes_.push_back({best_bid_tick_ + depth, 0});
+            --best_bid_tick_;
+            std::rotate(bid_lots_.begin(), bid_lots_.begin() + 1, bid_lots_.end());
+            std::rotate(ask_lots_.rbegin(), ask_lots_.rbegin() + 1, ask_lots_.rend());
+            bid_lots_.back() = random_lots();
+            ask_lots_.front() = random_lots();
+            bid_changes_.push_back({best_bid_tick_ - depth + 1, bid_lots_.back()});
+            ask_changes_.push_back({best_bid_tick_ + 1, ask_lots_.front()});
+        }
+    }
+
+    for (size_t k = 0; k < config_.levels_per_update; ++k) {
+        const bool ask = (rng_() & 1) != 0;
+        const int64_t level = static_cast<int64_t>(rng_() % static_cast<uint64_t>(depth));
+        const uint32_t lots = random_lots();
+        if (ask) {
+            ask_lots_[level] = lots;
+            ask_changes_.push_back({best_bid_tick_ + 1 + level, lots});
+        } else {
+            bid_lots_[level] = lots;
+            bid_changes_.push_back({best_bid_tick_ - level, lots});
+        }
+    }
+}
+
+void SyntheticFeed::write(bool snapshot, int64_t ts_ms) {
+    buffer_.clear();
+    const std::string ts = std::to_string(ts_ms);
+    if (config_.format == SyntheticFeedFormat::Okx) {
+        buffer_ += R"({"arg":{"channel":"books","instId":")";
+        buffer_ += symbol_;
+        buffer_ += snapshot ? R"("},"action":"snapshot","data":[{"asks":[)" : R"("},"action":"update","data":[{"asks":[)";
+        write_levels(ask_changes_);
+        buffer_ += R"(],"bids":[)";
+        write_levels(bid_changes_);
+        buffer_ += R"(],"ts":")";
+        buffer_ += ts;
+        buffer_ += R"(","seqId":)";
+        buffer_ += std::to_string(sequence_);
+        buffer_ += "}]}";
+    } else {
+        buffer_ += R"({"ts":")";
+        buffer_ += ts;
+        buffer_ += R"(","exchange":"synthetic","symbol":")";
+        buffer_ += symbol_;
+        buffer_ += snapshot ? R"(","asks":[)" : R"(","action":"update","asks":[)";
+        write_levels(ask_changes_);
+        buffer_ += R"(],"bids":[)";
+        write_levels(bid_changes_);
+        buffer_ += "]}";
+    }
+
+    // ,"pad":"xxx"} in place of the closing brace
+    if (buffer_.size() < config_.min_message_bytes) {
+        const size_t overhead = 9;
+        const size_t fill = config_.min_message_bytes > buffer_.size() + overhead
+                                ? config_.min_message_bytes - buffer_.size() - overhead : 0;
+        buffer_.pop_back();
+        buffer_ += R"(,"pad":")";
+        buffer_.append(fill, 'x');
+        buffer_ += "\"}";
+    }
+    ++sequence_;
+}
+
+void SyntheticFeed::write_levels(const std::vector<Level>& levels) {
+    for (size_t i = 0; i < levels.size(); ++i) {
+        buffer_ += i == 0 ? "[\"" : ",[\"";
+        write_fixed(levels[i].tick * tick_units_, price_decimals_);
+        buffer_ += "\",\"";
+        write_fixed(levels[i].lots, kLotDecimals);
+        buffer_ += "\"]";
+    }
+}
+
+// Non-negative fixed-point value without going through printf
+void SyntheticFeed::write_fixed(int64_t units, int decimals) {
+    char digits[24];
+    int n = 0;
+    uint64_t value = static_cast<uint64_t>(std::max<int64_t>(units, 0));
+    do {
+        digits[n++] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value != 0 || n <= decimals);
+    for (int i = n - 1; i >= 0; --i) {
+        buffer_ += digits[i];
+        if (i == decimals && decimals > 0) {
+            buffer_ += '.';
+        }
+    }
+}
+
+FeedPacer::FeedPacer(double rate, size_t burst)
+    : rate_(rate), burst_(std::max<size_t>(burst, 1)), start_ns_(0) {}
+
+uint64_t FeedPacer::due(int64_t now_ns) const {
+    if (unpaced()) {
+        return UINT64_MAX;
+    }
+    const double elapsed = static_cast<double>(std::max<int64_t>(now_ns - start_ns_, 0));
+    const uint64_t bursts = static_cast<uint64_t>(elapsed * rate_ / (1e9 * burst_)) + 1;
+    return bursts * burst_;
+}
+
+int64_t FeedPacer::next_due_ns(uint64_t sent) const {
+    return start_ns_ + static_cast<int64_t>(static_cast<double>(sent / burst_) * burst_interval_ns());
+}
+
+int64_t FeedPacer::burst_interval_ns() const {
+    return unpaced() ? 0 : static_cast<int64_t>(1e9 * burst_ / rate_);
+}
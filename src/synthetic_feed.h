@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+// Deterministic L2 feed generator for load tests.
+//
+// Each instrument is a ladder of `depth` contiguous levels per side,
+// one tick apart and with a one-tick spread. Every delta moves the touch
+// one tick up or down with probability move_probability. A move adds and
+// removes the levels it shifts across. The delta then resizes
+// levels_per_update random levels. A stream opens with a full-depth
+// snapshot and repeats one every snapshot_every deltas.
+//
+// Payloads depend only on the config, the symbol index and the ts passed
+// in. Two streams with the same seed are byte-identical no matter how fast
+// they are consumed, so load runs are reproducible. The generator keeps its
+// own copy of the book, so a consumer can check its book against it.
+
+enum class SyntheticFeedFormat {
+    Flat,   // {"ts":..,"exchange":..,"symbol":..,["action":"update",]"asks":[..],"bids":[..]}
+    Okx     // {"arg":{..},"action":"snapshot"|"update","data":[{"asks":..,"bids":..,"ts":..,"seqId":..}]}
+};
+
+struct SyntheticFeedConfig {
+    double start_price = 100.0;       // first touch of symbol 0; symbol i starts at (i + 1) * start_price
+    double tick_size = 0.1;
+    size_t depth = 50;                // levels per side, at most BookSnapshot::kMaxDepth
+    size_t levels_per_update = 4;     // resized levels per delta
+    double move_probability = 0.2;    // chance a delta shifts the touch by one tick
+    size_t snapshot_every = 0;        // deltas between snapshots; 0 = only the first message
+    size_t min_message_bytes = 0;     // pad shorter payloads with a "pad" field the parser skips
+    SyntheticFeedFormat format = SyntheticFeedFormat::Flat;
+    uint64_t seed = 1;
+};
+
+// "SYN-<index>", the symbol a synthetic stream answers to
+std::string synthetic_symbol_name(size_t index);
+
+class SyntheticFeed {
+public:
+    SyntheticFeed(const SyntheticFeedConfig& config, size_t symbol_index);
+
+    // Next payload of the stream; the returned buffer is reused by the next call.
+    // `ts_ms` fills the exchange timestamp field.
+    const std::string& next(int64_t ts_ms = 0);
+    // Full-depth snapshot of the current state; the next delta follows on from it
+    const std::string& snapshot(int64_t ts_ms = 0);
+
+    const std::string& symbol() const { return symbol_; }
+    uint64_t sequence() const { return sequence_; }   // payloads produced so far
+    double best_bid() const { return price_of(best_bid_tick_); }
+    double best_ask() const { return price_of(best_bid_tick_ + 1); }
+    size_t depth() const { return ask_lots_.size(); }
+
+private:
+    struct Level {
+        int64_t tick;
+        uint32_t lots;
+    };
+
+    SyntheticFeedConfig config_;
+    std::string symbol_;
+    std::mt19937_64 rng_;
+    int64_t best_bid_tick_;
+    // Level i of a side is i ticks away from its touch
+    std::vector<uint32_t> ask_lots_;
+    std::vector<uint32_t> bid_lots_;
+    std::vector<Level> ask_changes_;
+    std::vector<Level> bid_changes_;
+    size_t deltas_since_snapshot_;
+    uint64_t sequence_;
+    int price_decimals_;
+    int64_t tick_units_;   // tick size in units of 10^-price_decimals
+    std::string buffer_;
+
+    // Same value a parser gets from the printed decimal
+    double price_of(int64_t tick) const;
+    uint32_t random_lots();
+    void advance();
+    void write(bool snapshot, int64_t ts_ms);
+    void write_levels(const std::vector<Level>& levels);
+    void write_fixed(int64_t units, int decimals);
+};
+
+// Message schedule for a target rate delivered in bursts.
+//
+// Messages leave in bursts of `burst` back-to-back sends, one burst every
+// burst / rate seconds. The average rate stays the same, but a larger burst
+// gives the consumer spikier queues. A rate of 0 means unpaced.
+class FeedPacer {
+public:
+    explicit FeedPacer(double rate = 0.0, size_t burst = 1);
+
+    void start(int64_t now_ns) { start_ns_ = now_ns; }
+    bool unpaced() const { return rate_ <= 0.0; }
+    // Messages that should have been sent by now (the first burst is due at start)
+    uint64_t due(int64_t now_ns) const;
+    // When the burst that follows `sent` messages is due
+    int64_t next_due_ns(uint64_t sent) const;
+    int64_t burst_interval_ns() const;
+
+private:
+    double rate_;
+    size_t burst_;
+    int64_t start_ns_;
+};
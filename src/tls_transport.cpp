@@ -0,0 +1,183 @@
+#include "tls_transport.h"
+#include "logger.h"
+#include <boost/asio/ip/address.hpp>
+#include <boost/asio/ssl/context.hpp>
+#include <openssl/ssl.h>
+#include <openssl/x509.h>
+#include <openssl/x509v3.h>
+#ifdef _WIN32
+#include <windows.h>
+#include <wincrypt.h>
+#else
+#include <sys/socket.h>
+#endif
+
+namespace {
+
+int slot_index() {
+    static const int index = SSL_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr);
+    return index;
+}
+
+// New-session callback: the ticket goes to the slot of the connection that
+// received it. Returning 1 keeps the reference OpenSSL handed over.
+int store_session(SSL* ssl, SSL_SESSION* session) {
+    TlsSessionSlot* slot = static_cast<TlsSessionSlot*>(SSL_get_ex_data(ssl, slot_index()));
+    if (slot == nullptr) {
+        return 0;
+    }
+    // OpenSSL marks the live session not resumable when a connection ends
+    // without close_notify, as feeds dropped by the network do. TLS 1.3 allows
+    // resuming those, so keep a copy the teardown cannot touch. TLS 1.2
+    // sessions keep the stricter rule.
+    if (SSL_SESSION_get_protocol_version(session) >= TLS1_3_VERSION) {
+        SSL_SESSION* copy = SSL_SESSION_dup(session);
+        if (copy != nullptr) {
+            slot->store(copy);
+            return 0;
+        }
+    }
+    slot->store(session);
+    return 1;
+}
+
+#ifdef _WIN32
+// OpenSSL has no default trust store on Windows; copy the system root store
+bool load_windows_roots(SSL_CTX* ctx) {
+    HCERTSTORE store = CertOpenSystemStoreA(0, "ROOT");
+    if (store == nullptr) {
+        return false;
+    }
+    X509_STORE* x509_store = SSL_CTX_get_cert_store(ctx);
+    size_t added = 0;
+    PCCERT_CONTEXT cert = nullptr;
+    while ((cert = CertEnumCertificatesInStore(store, cert)) != nullptr) {
+        const unsigned char* der = cert->pbCertEncoded;
+        X509* x509 = d2i_X509(nullptr, &der, static_cast<long>(cert->cbCertEncoded));
+        if (x509 != nullptr) {
+            added += X509_STORE_add_cert(x509_store, x509) == 1 ? 1 : 0;
+            X509_free(x509);
+        }
+    }
+    CertCloseStore(store, 0);
+    return added > 0;
+}
+#endif
+
+} // namespace
+
+void TlsSessionSlot::store(SSL_SESSION* session) {
+    if (session_ != nullptr) {
+        SSL_SESSION_free(session_);
+    }
+    session_ = session;
+}
+
+bool apply_socket_tuning(boost::asio::ip::tcp::socket::lowest_layer_type& socket, const SocketTuning& tuning) {
+    bool applied = true;
+    boost::system::error_code ec;
+    if (tuning.no_delay) {
+        socket.set_option(boost::asio::ip::tcp::no_delay(true), ec);
+        if (ec) {
+            LOG_WARN("[Feed] TCP_NODELAY rejected: {}", ec.message());
+            applied = false;
+        }
+    }
+    if (tuning.receive_buffer_bytes > 0) {
+        socket.set_option(boost::asio::socket_base::receive_buffer_size(tuning.receive_buffer_bytes), ec);
+        if (ec) {
+            LOG_WARN("[Feed] SO_RCVBUF {} rejected: {}", tuning.receive_buffer_bytes, ec.message());
+            applied = false;
+        }
+    }
+    if (tuning.busy_poll_us > 0) {
+#ifdef SO_BUSY_POLL
+        const int value = tuning.busy_poll_us;
+        if (setsockopt(socket.native_handle(), SOL_SOCKET, SO_BUSY_POLL, &value, sizeof(value)) != 0) {
+            // Raising it above net.core.busy_poll needs CAP_NET_ADMIN
+            LOG_WARN("[Feed] SO_BUSY_POLL {}us rejected", value);
+            applied = false;
+        }
+#else
+        LOG_WARN("[Feed] SO_BUSY_POLL is not available on this platform");
+        applied = false;
+#endif
+    }
+    return applied;
+}
+
+std::shared_ptr<boost::asio::ssl::context> make_tls_client_context(const TlsConfig& config) {
+    namespace ssl = boost::asio::ssl;
+    auto context = std::make_shared<ssl::context>(ssl::context::tls_client);
+    context->set_options(ssl::context::default_workarounds | ssl::context::no_sslv2 | ssl::context::no_sslv3
+                         | ssl::context::no_tlsv1 | ssl::context::no_tlsv1_1);
+
+    boost::system::error_code ec;
+    if (config.verify_peer) {
+        context->set_verify_mode(ssl::verify_peer, ec);
+        if (!config.ca_file.empty()) {
+            context->load_verify_file(config.ca_file, ec);
+            if (ec) {
+                LOG_ERROR("[Feed] Cannot load CA file {}: {}", config.ca_file, ec.message());
+            }
+        } else {
+#ifdef _WIN32
+            if (!load_windows_roots(context->native_handle())) {
+                LOG_ERROR("[Feed] No trusted roots in the Windows certificate store");
+            }
+#else
+            context->set_default_verify_paths(ec);
+            if (ec) {
+                LOG_ERROR("[Feed] Cannot load the system trust store: {}", ec.message());
+            }
+#endif
+        }
+    } else {
+        context->set_verify_mode(ssl::verify_none, ec);
+    }
+
+    SSL_CTX* native = context->native_handle();
+    if (config.session_resumption) {
+        // Sessions live in the per-subscription slots, not in OpenSSL's cache
+        SSL_CTX_set_session_cache_mode(native, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+        SSL_CTX_sess_set_new_cb(native, store_session);
+    } else {
+        SSL_CTX_set_session_cache_mode(native, SSL_SESS_CACHE_OFF);
+        SSL_CTX_set_options(native, SSL_OP_NO_TICKET);
+    }
+    return context;
+}
+
+bool prepare_tls_session(SSL* ssl, const std::string& host, TlsSessionSlot* slot, const TlsConfig& config) {
+    std::string name = host;
+    if (name.size() > 2 && name.front() == '[' && name.back() == ']') {
+        name = name.substr(1, name.size() - 2);   // bracketed IPv6 literal
+    }
+    boost::system::error_code ec;
+    boost::asio::ip::make_address(name, ec);
+    const bool is_address = !ec;
+
+    // SNI carries host names only
+    if (!is_address && SSL_set_tlsext_host_name(ssl, name.c_str()) != 1) {
+        return false;
+    }
+    if (config.verify_peer) {
+        X509_VERIFY_PARAM* param = SSL_get0_param(ssl);
+        const int set = is_address ? X509_VERIFY_PARAM_set1_ip_asc(param, name.c_str())
+                                   : X509_VERIFY_PARAM_set1_host(param, name.c_str(), 0);
+        if (set != 1) {
+            return false;
+        }
+    }
+    if (config.session_resumption && slot != nullptr) {
+        SSL_set_ex_data(ssl, slot_index(), slot);
+        if (slot->has_session()) {
+            SSL_set_session(ssl, slot->session());   // takes its own reference
+        }
+    }
+    return true;
+}
+
+bool tls_session_resumed(SSL* ssl) {
+    return SSL_session_reused(ssl) == 1;
+}
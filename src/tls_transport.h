@@ -0,0 +1,64 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <boost/asio/ip/tcp.hpp>
+
+// OpenSSL stays out of this header: its global typedefs (UI among them)
+// collide with names in files that only need the config structs
+struct ssl_st;
+struct ssl_session_st;
+namespace boost { namespace asio { namespace ssl { class context; } } }
+
+// Socket options for feed connections, applied once TCP is connected and
+// before any TLS or WebSocket handshake bytes are read
+struct SocketTuning {
+    bool no_delay = true;                  // TCP_NODELAY: subscribes and pongs are tiny, never wait for Nagle
+    int receive_buffer_bytes = 4 << 20;    // SO_RCVBUF, absorbs bursts while the io thread is busy; 0 = kernel default
+    int busy_poll_us = 0;                  // SO_BUSY_POLL (Linux): spin on the NIC queue before sleeping; 0 = off
+};
+
+// Returns false if an option was rejected; the socket stays usable either way
+bool apply_socket_tuning(boost::asio::ip::tcp::socket::lowest_layer_type& socket, const SocketTuning& tuning);
+
+struct TlsConfig {
+    bool verify_peer = true;
+    std::string ca_file;              // PEM bundle; empty = the system trust store
+    bool session_resumption = true;   // offer the previous session (ticket) on reconnect
+};
+
+// One subscription's TLS session, kept across reconnects.
+//
+// The client context stores every session ticket the server issues in the
+// slot of the connection that received it. The next handshake for that
+// subscription offers the ticket, which lets the server skip the
+// certificate exchange and key agreement. TLS 1.3 servers send tickets
+// after the handshake, so the slot is updated whenever one arrives.
+class TlsSessionSlot {
+public:
+    TlsSessionSlot() : session_(nullptr) {}
+    ~TlsSessionSlot() { clear(); }
+
+    TlsSessionSlot(const TlsSessionSlot&) = delete;
+    TlsSessionSlot& operator=(const TlsSessionSlot&) = delete;
+
+    bool has_session() const { return session_ != nullptr; }
+    ssl_session_st* session() const { return session_; }
+    // Takes over the caller's reference and frees the previous session
+    void store(ssl_session_st* session);
+    void clear() { store(nullptr); }
+
+private:
+    ssl_session_st* session_;
+};
+
+// Client context shared by every connection of an io thread: TLS 1.2 or
+// newer, peer verification and client-side session caching into slots
+std::shared_ptr<boost::asio::ssl::context> make_tls_client_context(const TlsConfig& config);
+
+// Before the handshake: SNI and host name (or IP) verification for `host`,
+// plus the slot's session to resume. Returns false if the host cannot be set.
+bool prepare_tls_session(ssl_st* ssl, const std::string& host, TlsSessionSlot* slot, const TlsConfig& config);
+
+// True once the handshake completed by resuming a session
+bool tls_session_resumed(ssl_st* ssl);
@@ -1,4 +1,7 @@
 #include "ui.h"
+#include "coefficient_store.h"
+#include "fee_schedule.h"
+#include "model_coefficients.h"
 #include <windows.h>
 #include <d3d11.h>
 #include <tchar.h>
@@ -8,6 +11,7 @@
 #include "backends/imgui_impl_dx11.h"
 
 #include <iostream>
+#include <cmath>
 #include <chrono>
 #include <vector>
 #include <string>
@@ -18,6 +22,9 @@ static ID3D11DeviceContext* g_pd3dDeviceContext = nullptr;
 static IDXGISwapChain* g_pSwapChain = nullptr;
 static ID3D11RenderTargetView* g_mainRenderTargetView = nullptr;
 
+// Labels for the fee tier combos; each venue shows its first `tiers` entries
+static const char* kFeeTierItems[kMaxFeeTiers] = { "1", "2", "3", "4", "5", "6", "7", "8", "9", "10" };
+
 extern LRESULT ImGui_ImplWin32_WndProcHandler(HWND, UINT, WPARAM, LPARAM);
 static LRESULT WINAPI WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam);
 
@@ -63,28 +70,43 @@ void CleanupDeviceD3D() {
     if (g_pd3dDevice) { g_pd3dDevice->Release(); g_pd3dDevice = nullptr; }
 }
 
-UI::UI(OrderBook& orderbook, Models& models)
-    : orderbook_(orderbook), models_(models), fee_tier_(1), quantity_(100.0), volatility_(0.05),
-      spot_asset_index_(0), last_tick_time_(std::chrono::steady_clock::now()), internal_latency_ms_(0.0),
-      ui_update_latency_ms_(0.0)
+UI::UI(BookRegistry& registry, Models& models, WorkStealingPool& pool)
+    : registry_(registry), models_(models), fee_tier_(1), quantity_(100.0), volatility_(model_coefficients::kDefaultVolatility), manual_volatility_(false),
+      spot_asset_index_(0), book_symbol_(BookRegistry::kInvalidSymbol), evaluator_(models),
+      monte_carlo_(pool),
+      sweep_(pool), sweep_quantity_range_{10.0, 10000.0}, sweep_volatility_range_{0.0, 0.0}, sweep_steps_{32, 32},
+      sweep_tier_index_(0), sweep_symbol_(BookRegistry::kInvalidSymbol),
+      last_tick_time_(std::chrono::steady_clock::now()), frame_interval_ms_(0.0),
+      latency_refresh_ns_(0)
 {
-    spot_assets_ = {
-        "BTC-USDT-SWAP",
-        "ETH-USDT-SWAP",
-        "LTC-USDT-SWAP",
-        "XRP-USDT-SWAP",
-        "BCH-USDT-SWAP"
-    };
+    for (SymbolId id = 0; id < registry_.size(); ++id) {
+        spot_assets_.push_back(registry_.symbol_name(id));
+    }
+    feed_latency_summaries_.resize(registry_.size());
 }
 
 UI::~UI() {}
 
 void UI::record_tick_time() {
     auto now = std::chrono::steady_clock::now();
-    internal_latency_ms_ = std::chrono::duration<double, std::milli>(now - last_tick_time_).count();
+    frame_interval_ms_ = std::chrono::duration<double, std::milli>(now - last_tick_time_).count();
     last_tick_time_ = now;
 }
 
+void UI::refresh_book() {
+    if (spot_assets_.empty()) {
+        return;
+    }
+    const SymbolId id = static_cast<SymbolId>(spot_asset_index_);
+    const OrderBook& book = registry_.book(id);
+    if (id != book_symbol_ || book.version() != book_snapshot_.version) {
+        book.read_snapshot(book_snapshot_);
+        execution_cost_.update(book_snapshot_);
+        book_symbol_ = id;
+        models_.select_symbol(id);
+    }
+}
+
 void UI::run() {
     // Register window class
     WNDCLASSEX wc = { sizeof(WNDCLASSEX), CS_CLASSDC, WndProc, 0L, 0L,
@@ -128,15 +150,17 @@ void UI::run() {
         ImGui_ImplWin32_NewFrame();
         ImGui::NewFrame();
 
-        // Record tick time for internal latency measurement
         record_tick_time();
 
-        auto ui_start = std::chrono::high_resolution_clock::now();
-
-        render();
+        {
+            ScopedLatency frame(LatencyStage::Render);
+            render();
+        }
 
-        auto ui_end = std::chrono::high_resolution_clock::now();
-        ui_update_latency_ms_ = std::chrono::duration<double, std::milli>(ui_end - ui_start).count();
+        // Periodic p50/p99/p99.9/max for every stage, then per-symbol feed latency, in the log
+        if (LatencyMonitor::instance().report_if_due(10 * 1000000000LL)) {
+            registry_.report_feed_latency();
+        }
 
         ImGui::Render();
         const float clear_color[4] = { 0.1f, 0.1f, 0.1f, 1.0f };
@@ -171,8 +195,8 @@ void UI::render_input_panel() {
 
     ImGui::Text("Exchange: OKX");
 
-    // Spot Asset selection
-    if (ImGui::BeginCombo("Spot Asset", spot_assets_[spot_asset_index_].c_str())) {
+    // Spot Asset selection switches the live book shown in the output panel
+    if (!spot_assets_.empty() && ImGui::BeginCombo("Spot Asset", spot_assets_[spot_asset_index_].c_str())) {
         for (int n = 0; n < (int)spot_assets_.size(); n++) {
             bool is_selected = (spot_asset_index_ == n);
             if (ImGui::Selectable(spot_assets_[n].c_str(), is_selected))
@@ -186,14 +210,27 @@ void UI::render_input_panel() {
     ImGui::Text("Order Type: Market");
 
     ImGui::InputDouble("Quantity (USD)", &quantity_, 1.0, 10.0);
-    ImGui::InputDouble("Volatility", &volatility_, 0.01, 0.1);
+    // Volatility comes from the selected symbol's live estimator; tick the box to override it
+    ImGui::Checkbox("Manual Volatility", &manual_volatility_);
+    if (manual_volatility_) {
+        // sigma per sqrt second, the live estimator's scale
+        ImGui::InputDouble("Volatility", &volatility_, 1e-5, 1e-4, "%.6f");
+    } else {
+        volatility_ = models_.current_volatility();
+        ImGui::Text("Volatility (live EWMA): %.6f", volatility_);
+    }
 
-    // Fix fee tier slider to allow values 1, 2, and 3
-    static const char* fee_tier_items[] = { "1", "2", "3" };
-    static int current_fee_tier_idx = fee_tier_ - 1;
-    if (ImGui::Combo("Fee Tier", &current_fee_tier_idx, fee_tier_items, IM_ARRAYSIZE(fee_tier_items))) {
-        fee_tier_ = current_fee_tier_idx + 1;
+    // VIP tiers of the selected symbol's venue schedule
+    const FeeTable& fees = models_.fee_table();
+    const int tier_count = static_cast<int>(fees.tiers);
+    if (fee_tier_ > tier_count) {
+        fee_tier_ = 1;
     }
+    int fee_tier_idx = fee_tier_ - 1;
+    if (ImGui::Combo("Fee Tier", &fee_tier_idx, kFeeTierItems, tier_count)) {
+        fee_tier_ = fee_tier_idx + 1;
+    }
+    ImGui::Text("Maker %.4f%% / Taker %.4f%%", fees.maker_rate(fee_tier_) * 100.0, fees.taker_rate(fee_tier_) * 100.0);
 
     ImGui::EndChild();
 }
@@ -202,24 +239,235 @@ void UI::render_output_panel() {
     ImGui::BeginChild("Output Panel", ImVec2(0, 0), true);
     ImGui::Text("Output Parameters");
 
-    double slippage = models_.calculate_slippage(quantity_, volatility_);
-    double fees = models_.calculate_fees(quantity_, fee_tier_);
-    double market_impact = models_.calculate_market_impact(quantity_, volatility_);
-    double net_cost = models_.calculate_net_cost(quantity_, volatility_, fee_tier_);
-    double maker_taker = models_.predict_maker_taker_proportion(quantity_, volatility_);
+    refresh_book();
+    if (book_symbol_ != BookRegistry::kInvalidSymbol && book_snapshot_.ask_count > 0 && book_snapshot_.bid_count > 0) {
+        ImGui::Text("Best Bid: %.4f (%.4f)", book_snapshot_.bids[0].price, book_snapshot_.bids[0].quantity);
+        ImGui::Text("Best Ask: %.4f (%.4f)", book_snapshot_.asks[0].price, book_snapshot_.asks[0].quantity);
+        ImGui::Text("Book Depth: %zu / %zu levels", book_snapshot_.bid_count, book_snapshot_.ask_count);
+
+        ExecutionEstimate buy = execution_cost_.estimate(OrderSide::Buy, quantity_);
+        ImGui::Text("Book VWAP (buy): %.4f over %zu levels%s", buy.vwap, buy.levels_consumed,
+                    buy.fully_filled ? "" : " (insufficient depth)");
+        ImGui::Text("Book Slippage (depth walk): %.6f", buy.slippage);
+
+        // Per-second sigma of the touch price, three ways
+        const VolatilityEstimate vol = registry_.volatility(book_symbol_).estimate();
+        ImGui::Text("Realized Vol: EWMA %.6f, Window %.6f, Parkinson %.6f (%llu returns)",
+                    vol.ewma, vol.realized, vol.parkinson, static_cast<unsigned long long>(vol.samples));
+    } else {
+        ImGui::Text("Waiting for order book data...");
+    }
+
+    // Most frames change nothing; only a miss runs the models, and only misses are timed
+    const int64_t model_start_ns = LatencyMonitor::now_ns();
+    const uint64_t misses = evaluator_.misses();
+    const ModelResult& result = evaluator_.evaluate(quantity_, volatility_, fee_tier_, book_snapshot_.version);
+    if (evaluator_.misses() != misses) {
+        LatencyMonitor::instance().record(LatencyStage::Model, LatencyMonitor::now_ns() - model_start_ns);
+    }
+    const AlmgrenChrissSchedule& schedule = result.schedule;
+
+    ImGui::Text("Expected Slippage: %.6f", result.slippage);
+    const SlippageQuantiles slippage_q = models_.calculate_slippage_quantiles(quantity_, volatility_);
+    if (slippage_q.count > 0) {
+        ImGui::Text("Slippage p50 / p90 / p99: %.6f / %.6f / %.6f (%llu obs)", slippage_q.p50, slippage_q.p90,
+                    slippage_q.p99, static_cast<unsigned long long>(slippage_q.count));
+    } else {
+        ImGui::Text("Slippage p50 / p90 / p99: collecting...");
+    }
+    ImGui::Text("Expected Fees: %.6f", result.fees);
+    ImGui::Text("Expected Market Impact: %.6f", result.market_impact);
+    ImGui::Text("Net Cost: %.6f", result.net_cost);
+    ImGui::Text("Maker/Taker Proportion: %.6f", result.maker_taker);
+    ImGui::Text("Model Cache: %llu hits, %llu misses", static_cast<unsigned long long>(evaluator_.hits()),
+                static_cast<unsigned long long>(evaluator_.misses()));
+
+    // Optimal liquidation schedule behind the market impact estimate
+    ImGui::Text("Optimal Schedule: E[cost] %.6f, StdDev %.6f, kappa %.4f",
+                schedule.expected_cost, std::sqrt(schedule.variance), schedule.kappa);
+    if (!schedule.holdings.empty()) {
+        std::vector<float> holdings(schedule.holdings.begin(), schedule.holdings.end());
+        ImGui::PlotLines("Holdings", holdings.data(), static_cast<int>(holdings.size()), 0, nullptr,
+                         0.0f, static_cast<float>(quantity_), ImVec2(0, 60));
+    }
 
-    ImGui::Text("Expected Slippage: %.6f", slippage);
-    ImGui::Text("Expected Fees: %.6f", fees);
-    ImGui::Text("Expected Market Impact: %.6f", market_impact);
-    ImGui::Text("Net Cost: %.6f", net_cost);
-    ImGui::Text("Maker/Taker Proportion: %.6f", maker_taker);
+    render_monte_carlo_panel(schedule);
+    render_sweep_panel();
 
-    ImGui::Text("Internal Latency: %.3f ms", internal_latency_ms_);
-    ImGui::Text("UI Update Latency: %.3f ms", ui_update_latency_ms_);
+    ImGui::Text("Frame Interval: %.3f ms", frame_interval_ms_);
+    render_latency_panel();
 
     ImGui::EndChild();
 }
 
+void UI::render_monte_carlo_panel(const AlmgrenChrissSchedule& schedule) {
+    ImGui::Separator();
+    // Thousands of paths take milliseconds even spread over the pool, so only on request
+    if (ImGui::Button("Simulate Cost Distribution") && book_symbol_ != BookRegistry::kInvalidSymbol) {
+        ModelCoefficients c;
+        models_.coefficients(c);
+        MonteCarloParams params = MonteCarloParams::from_models(models_);
+        params.volatility = volatility_;
+        params.seed = static_cast<uint64_t>(book_snapshot_.version);
+        const ExecutionPlan plan = ExecutionPlan::from_schedule(schedule, OrderSide::Buy, c.impact_horizon);
+        cost_distribution_ = monte_carlo_.simulate(book_snapshot_, plan, params);
+    }
+    if (cost_distribution_.paths > 0) {
+        ImGui::Text("Shortfall over %zu paths: mean %.6f, stddev %.6f", cost_distribution_.paths,
+                    cost_distribution_.mean, cost_distribution_.stddev);
+        ImGui::Text("VaR %.0f%%: %.6f, CVaR: %.6f", cost_distribution_.confidence * 100.0, cost_distribution_.var,
+                    cost_distribution_.cvar);
+        if (cost_distribution_.incomplete_paths > 0) {
+            ImGui::Text("%zu paths outran the visible depth", cost_distribution_.incomplete_paths);
+        }
+    }
+}
+
+void UI::render_sweep_panel() {
+    ImGui::Separator();
+    ImGui::Text("Net Cost Surface");
+    bool changed = false;
+    changed |= ImGui::InputDouble("Sweep Qty Min", &sweep_quantity_range_[0], 10.0, 100.0);
+    changed |= ImGui::InputDouble("Sweep Qty Max", &sweep_quantity_range_[1], 10.0, 100.0);
+    // Volatility axis on the live estimator's scale: 0.25x to 4x the selected
+    // symbol's estimate, re-centred on a symbol switch or on request
+    const bool recentre = ImGui::Button("Centre Vol on Live");
+    if (recentre || sweep_symbol_ != models_.selected_symbol()) {
+        const double live = models_.current_volatility();
+        sweep_volatility_range_[0] = 0.25 * live;
+        sweep_volatility_range_[1] = 4.0 * live;
+        sweep_symbol_ = models_.selected_symbol();
+        changed = true;
+    }
+    changed |= ImGui::InputDouble("Sweep Vol Min", &sweep_volatility_range_[0], 1e-5, 1e-4, "%.6f");
+    changed |= ImGui::InputDouble("Sweep Vol Max", &sweep_volatility_range_[1], 1e-5, 1e-4, "%.6f");
+    changed |= ImGui::SliderInt2("Steps (qty, vol)", sweep_steps_, 2, 64);
+    const int tier_count = static_cast<int>(models_.fee_table().tiers);
+    if (sweep_tier_index_ >= tier_count) {
+        sweep_tier_index_ = 0;
+    }
+    ImGui::Combo("Sweep Fee Tier", &sweep_tier_index_, kFeeTierItems, tier_count);
+
+    if (changed || sweep_grid_.fee_tiers.size() != static_cast<size_t>(tier_count)) {
+        sweep_grid_.quantities =
+            ScenarioGrid::linspace(sweep_quantity_range_[0], sweep_quantity_range_[1], sweep_steps_[0]);
+        sweep_grid_.volatilities =
+            ScenarioGrid::linspace(sweep_volatility_range_[0], sweep_volatility_range_[1], sweep_steps_[1]);
+        sweep_grid_.fee_tiers.clear();
+        for (int tier = 1; tier <= tier_count; ++tier) {
+            sweep_grid_.fee_tiers.push_back(tier);
+        }
+    }
+    const ScenarioSurface& surface = sweep_.run(models_, sweep_grid_);
+    ImGui::Text("Cells: %zu computed, %zu reused; net cost %.6f .. %.6f", surface.cells_computed,
+                surface.cells_reused, surface.min_net_cost, surface.max_net_cost);
+
+    // Heatmap: quantity left to right, volatility bottom to top, shared colour scale across tiers
+    const size_t nq = surface.grid.quantities.size();
+    const size_t nv = surface.grid.volatilities.size();
+    if (nq == 0 || nv == 0) {
+        return;
+    }
+    const ImVec2 size(ImGui::GetContentRegionAvail().x, 160.0f);
+    const ImVec2 origin = ImGui::GetCursorScreenPos();
+    const float cell_w = size.x / nq;
+    const float cell_h = size.y / nv;
+    const double span = surface.max_net_cost - surface.min_net_cost;
+    ImDrawList* draw = ImGui::GetWindowDrawList();
+    for (size_t v = 0; v < nv; ++v) {
+        for (size_t q = 0; q < nq; ++q) {
+            const double cost = surface.net_cost[surface.grid.index(q, v, sweep_tier_index_)];
+            const float t = span > 0.0 ? static_cast<float>((cost - surface.min_net_cost) / span) : 0.0f;
+            const ImVec2 lo(origin.x + q * cell_w, origin.y + (nv - 1 - v) * cell_h);
+            const ImVec2 hi(lo.x + cell_w, lo.y + cell_h);
+            draw->AddRectFilled(lo, hi, ImGui::ColorConvertFloat4ToU32(ImVec4(t, 0.2f, 1.0f - t, 1.0f)));
+        }
+    }
+    ImGui::InvisibleButton("Net Cost Heatmap", size);
+    if (ImGui::IsItemHovered()) {
+        const ImVec2 mouse = ImGui::GetIO().MousePos;
+        // Clamp by hand: windows.h defines min/max macros
+        const float x = (mouse.x - origin.x) / cell_w;
+        const float y = (mouse.y - origin.y) / cell_h;
+        const size_t q = x <= 0.0f ? 0 : (static_cast<size_t>(x) < nq ? static_cast<size_t>(x) : nq - 1);
+        const size_t row = y <= 0.0f ? 0 : (static_cast<size_t>(y) < nv ? static_cast<size_t>(y) : nv - 1);
+        const size_t v = nv - 1 - row;
+        const size_t cell = surface.grid.index(q, v, sweep_tier_index_);
+        ImGui::SetTooltip("Qty %.2f, Vol %.6f\nNet Cost %.6f\nMaker/Taker %.4f", surface.grid.quantities[q],
+                          surface.grid.volatilities[v], surface.net_cost[cell], surface.maker_taker[cell]);
+    }
+}
+
+void UI::render_latency_panel() {
+    ImGui::Separator();
+    ImGui::Text("Pipeline Latency (us)");
+    if (ImGui::BeginTable("Latency", 6)) {
+        ImGui::TableSetupColumn("Stage");
+        ImGui::TableSetupColumn("Count");
+        ImGui::TableSetupColumn("p50");
+        ImGui::TableSetupColumn("p99");
+        ImGui::TableSetupColumn("p99.9");
+        ImGui::TableSetupColumn("Max");
+        ImGui::TableHeadersRow();
+        // Merging every thread's buckets is cheap but not free; a few times a second is enough
+        const int64_t now_ns = LatencyMonitor::now_ns();
+        const bool refresh = now_ns - latency_refresh_ns_ > 250 * 1000000LL;
+        if (refresh) {
+            latency_refresh_ns_ = now_ns;
+        }
+        for (size_t i = 0; i < LatencyMonitor::kStageCount; ++i) {
+            const LatencyStage stage = static_cast<LatencyStage>(i);
+            if (refresh) {
+                latency_summaries_[i] = LatencyMonitor::instance().summary(stage);
+            }
+            const LatencySummary& summary = latency_summaries_[i];
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn(); ImGui::Text("%s", latency_stage_name(stage));
+            ImGui::TableNextColumn(); ImGui::Text("%llu", static_cast<unsigned long long>(summary.count));
+            ImGui::TableNextColumn(); ImGui::Text("%.1f", summary.p50_ns / 1000.0);
+            ImGui::TableNextColumn(); ImGui::Text("%.1f", summary.p99_ns / 1000.0);
+            ImGui::TableNextColumn(); ImGui::Text("%.1f", summary.p999_ns / 1000.0);
+            ImGui::TableNextColumn(); ImGui::Text("%.1f", summary.max_ns / 1000.0);
+        }
+        ImGui::EndTable();
+    }
+
+    // Outside the process (exchange timestamp to socket read, net of the
+    // estimated clock offset) versus inside it (socket read to book applied)
+    ImGui::Text("Feed Latency by Symbol (us)");
+    if (ImGui::BeginTable("FeedLatency", 7)) {
+        ImGui::TableSetupColumn("Symbol");
+        ImGui::TableSetupColumn("Exch p50");
+        ImGui::TableSetupColumn("Exch p99");
+        ImGui::TableSetupColumn("Exch recent");
+        ImGui::TableSetupColumn("Offset (ms)");
+        ImGui::TableSetupColumn("Applied p50");
+        ImGui::TableSetupColumn("Applied p99");
+        ImGui::TableHeadersRow();
+        for (SymbolId id = 0; id < feed_latency_summaries_.size(); ++id) {
+            if (refresh) {
+                feed_latency_summaries_[id] = registry_.feed_latency(id).summary();
+            }
+            const FeedLatencySummary& summary = feed_latency_summaries_[id];
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn(); ImGui::Text("%s", registry_.symbol_name(id).c_str());
+            if (summary.offset_valid) {
+                ImGui::TableNextColumn(); ImGui::Text("%.1f", summary.exchange_to_receive.p50_ns / 1000.0);
+                ImGui::TableNextColumn(); ImGui::Text("%.1f", summary.exchange_to_receive.p99_ns / 1000.0);
+                ImGui::TableNextColumn(); ImGui::Text("%.1f", summary.recent_exchange_ns / 1000.0);
+                ImGui::TableNextColumn(); ImGui::Text("%.3f", summary.clock_offset_ns / 1e6);
+            } else {
+                for (int column = 0; column < 4; ++column) {
+                    ImGui::TableNextColumn(); ImGui::Text("-");
+                }
+            }
+            ImGui::TableNextColumn(); ImGui::Text("%.1f", summary.receive_to_apply.p50_ns / 1000.0);
+            ImGui::TableNextColumn(); ImGui::Text("%.1f", summary.receive_to_apply.p99_ns / 1000.0);
+        }
+        ImGui::EndTable();
+    }
+}
+
 // Windows message handler
 LRESULT WINAPI WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam) {
     if (ImGui_ImplWin32_WndProcHandler(hWnd, msg, wParam, lParam))
@@ -1,41 +1,81 @@
 #pragma once
 
 #include "orderbook.h"
+#include "book_registry.h"
 #include "models.h"
+#include "slippage_quantiles.h"
+#include "execution_cost.h"
+#include "latency_histogram.h"
+#include "monte_carlo.h"
+#include "scenario_sweep.h"
+#include "model_evaluator.h"
+#include "work_stealing_pool.h"
 #include <vector>
 #include <string>
 #include <chrono>
 
 class UI {
 public:
-    UI(OrderBook& orderbook, Models& models);
+    UI(BookRegistry& registry, Models& models, WorkStealingPool& pool);
     ~UI();
 
     void run();
 
 private:
-    OrderBook& orderbook_;
+    BookRegistry& registry_;
     Models& models_;
 
     int fee_tier_;
     double quantity_;
+    // Live estimate of the selected symbol unless manual_volatility_ is set
     double volatility_;
+    bool manual_volatility_;
 
-    // For dynamic spot asset selection
+    // For dynamic spot asset selection: one entry per registry symbol
     std::vector<std::string> spot_assets_;
     int spot_asset_index_;
 
-    // For internal latency measurement
-    std::chrono::steady_clock::time_point last_tick_time_;
-    double internal_latency_ms_;
+    // Last snapshot of the selected book, refreshed only when its version moves
+    BookSnapshot book_snapshot_;
+    SymbolId book_symbol_;
+    // Depth-walk cost of the current order against the selected book
+    ExecutionCostEngine execution_cost_;
+
+    // Per-order model outputs, recomputed only when an input or version moves
+    ModelEvaluator evaluator_;
+
+    // Cost distribution of the optimal schedule, simulated on demand over the pool
+    MonteCarloCostEngine monte_carlo_;
+    CostDistribution cost_distribution_;
 
-    // For UI update latency measurement
-    double ui_update_latency_ms_;
+    // Net-cost surface over a quantity x volatility grid for each fee tier.
+    // The axes are rebuilt only when an input changes, and the sweep returns
+    // at once while axes, symbol and coefficients are unchanged.
+    ScenarioSweep sweep_;
+    ScenarioGrid sweep_grid_;
+    double sweep_quantity_range_[2];
+    double sweep_volatility_range_[2];   // sigma per sqrt second, centred on the live estimate
+    int sweep_steps_[2];   // quantity, volatility
+    int sweep_tier_index_;
+    SymbolId sweep_symbol_;   // symbol the volatility axis was centred for
+
+    // Time between frames (the old "internal latency"); per-stage pipeline
+    // latency comes from the LatencyMonitor histograms
+    std::chrono::steady_clock::time_point last_tick_time_;
+    double frame_interval_ms_;
+    LatencySummary latency_summaries_[LatencyMonitor::kStageCount];
+    // Per-symbol exchange -> receive -> applied latency, refreshed with the stage summaries
+    std::vector<FeedLatencySummary> feed_latency_summaries_;
+    int64_t latency_refresh_ns_;
 
     void record_tick_time();
+    void refresh_book();
 
     void render();
     void render_input_panel();
     void render_output_panel();
+    void render_latency_panel();
+    void render_monte_carlo_panel(const AlmgrenChrissSchedule& schedule);
+    void render_sweep_panel();
 
 };
@@ -0,0 +1,140 @@
+#include "volatility_estimator.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+const int64_t kNoTime = std::numeric_limits<int64_t>::min();
+const double kParkinsonScale = 1.0 / (4.0 * std::log(2.0));
+
+} // namespace
+
+VolatilityEstimator::VolatilityEstimator(VolatilityConfig config)
+    : config_(config),
+      decay_per_second_(std::log(2.0) / std::max(config.ewma_half_life_seconds, 1e-9)),
+      last_price_(0.0), last_ns_(kNoTime), samples_(0), ewma_variance_(0.0),
+      window_(std::max<size_t>(config.window, 1)), window_head_(0), window_filled_(0), sum_r2_(0.0), sum_dt_(0.0),
+      bar_ns_(std::max<int64_t>(static_cast<int64_t>(config.bar_seconds * 1e9), 1)), bar_index_(kNoTime),
+      bar_high_(0.0), bar_low_(0.0),
+      bar_variance_(std::max<size_t>(config.bars, 1)), bar_head_(0), bars_filled_(0), sum_bar_variance_(0.0),
+      ewma_(0.0), realized_(0.0), parkinson_(0.0), price_(0.0), published_samples_(0) {}
+
+double VolatilityEstimator::microprice(const OrderLevel& best_bid, const OrderLevel& best_ask) {
+    // Weighted toward the side with less size: that is where the price is about to move
+    const double size = best_bid.quantity + best_ask.quantity;
+    if (!(size > 0.0)) {
+        return 0.5 * (best_bid.price + best_ask.price);
+    }
+    return (best_bid.price * best_ask.quantity + best_ask.price * best_bid.quantity) / size;
+}
+
+void VolatilityEstimator::on_top_of_book(int64_t ts_ns, const OrderLevel& best_bid, const OrderLevel& best_ask) {
+    on_price(ts_ns, config_.use_microprice ? microprice(best_bid, best_ask)
+                                           : 0.5 * (best_bid.price + best_ask.price));
+}
+
+void VolatilityEstimator::on_price(int64_t ts_ns, double price) {
+    if (!(price > 0.0) || !std::isfinite(price)) {
+        return;
+    }
+
+    // Parkinson bars; each bar opens at the previous close so gaps count toward its range
+    const int64_t bar = ts_ns / bar_ns_;
+    if (bar != bar_index_) {
+        if (bar_index_ != kNoTime) {
+            close_bar();
+        }
+        bar_index_ = bar;
+        bar_high_ = bar_low_ = last_price_ > 0.0 ? last_price_ : price;
+    }
+    bar_high_ = std::max(bar_high_, price);
+    bar_low_ = std::min(bar_low_, price);
+
+    if (last_ns_ == kNoTime) {
+        last_price_ = price;
+        last_ns_ = ts_ns;
+        price_.store(price, std::memory_order_relaxed);
+        return;
+    }
+    if (ts_ns <= last_ns_) {
+        return;   // same timestamp: the next return spans this move
+    }
+
+    const double r = std::log(price / last_price_);
+    const double dt = (ts_ns - last_ns_) * 1e-9;
+    const double r2 = r * r;
+    last_price_ = price;
+    last_ns_ = ts_ns;
+    ++samples_;
+
+    // Time-decayed EWMA of the variance rate
+    const double rate = r2 / dt;
+    if (samples_ == 1) {
+        ewma_variance_ = rate;
+    } else {
+        const double keep = std::exp(-decay_per_second_ * dt);
+        ewma_variance_ = keep * ewma_variance_ + (1.0 - keep) * rate;
+    }
+
+    // Windowed realized variance with running sums
+    Return& slot = window_[window_head_];
+    if (window_filled_ == window_.size()) {
+        sum_r2_ -= slot.r2;
+        sum_dt_ -= slot.dt;
+    } else {
+        ++window_filled_;
+    }
+    slot = Return{r2, dt};
+    sum_r2_ += r2;
+    sum_dt_ += dt;
+    if (++window_head_ == window_.size()) {
+        window_head_ = 0;
+        sum_r2_ = sum_dt_ = 0.0;
+        for (const Return& entry : window_) {
+            sum_r2_ += entry.r2;
+            sum_dt_ += entry.dt;
+        }
+    }
+
+    ewma_.store(std::sqrt(ewma_variance_), std::memory_order_relaxed);
+    realized_.store(sum_dt_ > 0.0 ? std::sqrt(std::max(sum_r2_, 0.0) / sum_dt_) : 0.0, std::memory_order_relaxed);
+    price_.store(price, std::memory_order_relaxed);
+    published_samples_.store(samples_, std::memory_order_relaxed);
+}
+
+void VolatilityEstimator::close_bar() {
+    if (!(bar_low_ > 0.0)) {
+        return;
+    }
+    const double range = std::log(bar_high_ / bar_low_);
+    const double variance = range * range * kParkinsonScale / config_.bar_seconds;
+
+    double& slot = bar_variance_[bar_head_];
+    if (bars_filled_ == bar_variance_.size()) {
+        sum_bar_variance_ -= slot;
+    } else {
+        ++bars_filled_;
+    }
+    slot = variance;
+    sum_bar_variance_ += variance;
+    if (++bar_head_ == bar_variance_.size()) {
+        bar_head_ = 0;
+        sum_bar_variance_ = 0.0;
+        for (double entry : bar_variance_) {
+            sum_bar_variance_ += entry;
+        }
+    }
+
+    parkinson_.store(std::sqrt(std::max(sum_bar_variance_, 0.0) / bars_filled_), std::memory_order_relaxed);
+}
+
+VolatilityEstimate VolatilityEstimator::estimate() const {
+    VolatilityEstimate estimate;
+    estimate.ewma = ewma_.load(std::memory_order_relaxed);
+    estimate.realized = realized_.load(std::memory_order_relaxed);
+    estimate.parkinson = parkinson_.load(std::memory_order_relaxed);
+    estimate.price = price_.load(std::memory_order_relaxed);
+    estimate.samples = published_samples_.load(std::memory_order_relaxed);
+    return estimate;
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "orderbook.h"
+#include "model_coefficients.h"
+
+struct VolatilityConfig {
+    double ewma_half_life_seconds = 30.0;
+    size_t window = 512;          // log-returns in the windowed realized estimate
+    double bar_seconds = 1.0;     // Parkinson bar length
+    size_t bars = 120;            // closed bars in the Parkinson average
+    bool use_microprice = true;   // size-weighted touch price instead of the plain mid
+};
+
+// All volatilities are sigma per sqrt(second) of log price
+struct VolatilityEstimate {
+    double ewma = 0.0;
+    double realized = 0.0;    // over the last `window` returns
+    double parkinson = 0.0;   // high/low range over the last `bars` bars
+    double price = 0.0;       // last mid or microprice
+    uint64_t samples = 0;     // returns observed
+};
+
+// Incremental realized-volatility estimator for one symbol, fed from the
+// top of book after every applied update.
+//
+// Each tick contributes one log-return r over dt. Three estimates are kept:
+//   - EWMA of r^2 / dt, with a time-based decay (half-life in seconds), so
+//     bursts of updates do not shorten its memory;
+//   - windowed realized variance, sum(r^2) / sum(dt) over a fixed ring of
+//     returns, with running sums;
+//   - Parkinson range variance, (ln(H/L))^2 / (4 ln 2) per bar, averaged over
+//     a ring of closed bars.
+// Updates are O(1); the window sums are recomputed once per wrap to shed
+// rounding drift. There is a single writer (the shard thread that owns the
+// book). Results are published through relaxed atomics, so any thread can
+// read them without locking. A reader may combine fields from adjacent ticks.
+class VolatilityEstimator {
+public:
+    explicit VolatilityEstimator(VolatilityConfig config = VolatilityConfig());
+
+    // Writer thread only; ts_ns is steady_clock nanoseconds
+    void on_top_of_book(int64_t ts_ns, const OrderLevel& best_bid, const OrderLevel& best_ask);
+    void on_price(int64_t ts_ns, double price);
+
+    VolatilityEstimate estimate() const;
+    double volatility() const { return ewma_.load(std::memory_order_relaxed); }
+    // What the models and the slippage calibrator price with: volatility(),
+    // or model_coefficients::kDefaultVolatility before the first return
+    double model_volatility() const {
+        return samples() > 0 ? volatility() : model_coefficients::kDefaultVolatility;
+    }
+    uint64_t samples() const { return published_samples_.load(std::memory_order_relaxed); }
+
+    const VolatilityConfig& config() const { return config_; }
+
+    static double microprice(const OrderLevel& best_bid, const OrderLevel& best_ask);
+
+private:
+    struct Return {
+        double r2;
+        double dt;
+    };
+
+    VolatilityConfig config_;
+    double decay_per_second_;   // ln 2 / half-life
+
+    // Writer state
+    double last_price_;
+    int64_t last_ns_;
+    uint64_t samples_;
+    double ewma_variance_;
+
+    std::vector<Return> window_;
+    size_t window_head_;
+    size_t window_filled_;
+    double sum_r2_;
+    double sum_dt_;
+
+    int64_t bar_ns_;
+    int64_t bar_index_;
+    double bar_high_;
+    double bar_low_;
+    std::vector<double> bar_variance_;
+    size_t bar_head_;
+    size_t bars_filled_;
+    double sum_bar_variance_;
+
+    // Published for readers
+    std::atomic<double> ewma_;
+    std::atomic<double> realized_;
+    std::atomic<double> parkinson_;
+    std::atomic<double> price_;
+    std::atomic<uint64_t> published_samples_;
+
+    void close_bar();
+};
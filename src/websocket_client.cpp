@@ -1,14 +1,25 @@
 #include "websocket_client.h"
+#include "l2_parser.h"
+#include "feed_capture.h"
+#include "latency_histogram.h"
 #include <iostream>
 #include <thread>
 #include <chrono>
-#include <nlohmann/json.hpp>  // For JSON parsing, assuming nlohmann/json is used
 // Include WebSocket++ or other WebSocket library headers here
 
-using json = nlohmann::json;
-
 WebSocketClient::WebSocketClient(const std::string& uri, OrderBook& orderbook)
-    : uri_(uri), orderbook_(orderbook), running_(false) {}
+    : uri_(uri), orderbook_(&orderbook), registry_(nullptr), symbol_(BookRegistry::kInvalidSymbol),
+      producer_(0), ring_(nullptr), running_(false) {
+    builder_.reset(new BookBuilder([this](const FeedMessage& message) {
+        apply_l2_payload(*orderbook_, message.payload);
+    }));
+    builder_->set_idle_handler([this]() { orderbook_->serve_depth(); });
+    ring_ = &builder_->add_input();
+}
+
+WebSocketClient::WebSocketClient(const std::string& uri, BookRegistry& registry, SymbolId symbol)
+    : uri_(uri), orderbook_(nullptr), registry_(&registry), symbol_(symbol),
+      producer_(registry.register_producer()), ring_(nullptr), running_(false) {}
 
 WebSocketClient::~WebSocketClient() {
     stop();
@@ -16,6 +27,9 @@ WebSocketClient::~WebSocketClient() {
 
 void WebSocketClient::run() {
     running_ = true;
+    if (builder_) {
+        builder_->start();
+    }
     connect();
 
     // Main loop to keep connection alive and process messages
@@ -25,12 +39,32 @@ void WebSocketClient::run() {
     }
 
     disconnect();
+    if (builder_) {
+        builder_->stop();
+        orderbook_->flush_depth();
+    }
 }
 
 void WebSocketClient::stop() {
     running_ = false;
 }
 
+FeedQueueStats WebSocketClient::queue_stats() const {
+    if (builder_) {
+        return builder_->stats();
+    }
+    return registry_->queue_stats(registry_->shard_of(symbol_));
+}
+
+bool WebSocketClient::enable_capture(const std::string& path) {
+    recorder_.reset(new FeedRecorder());
+    if (!recorder_->open(path)) {
+        recorder_.reset();
+        return false;
+    }
+    return true;
+}
+
 void WebSocketClient::connect() {
     std::cout << "Connecting to WebSocket: " << uri_ << std::endl;
     // Implement WebSocket connection setup here
@@ -42,11 +76,18 @@ void WebSocketClient::disconnect() {
 }
 
 void WebSocketClient::on_message(const std::string& message) {
-    try {
-        auto j = json::parse(message);
-        // Parse L2 orderbook data from JSON and update orderbook
-        orderbook_.update_from_json(j);
-    } catch (const std::exception& e) {
-        std::cerr << "Error parsing WebSocket message: " << e.what() << std::endl;
+    const int64_t recv_ts_ns = LatencyMonitor::now_ns();
+    const int64_t recv_wall_ns = LatencyMonitor::wall_ns();
+
+    if (recorder_) {
+        recorder_->append(message.data(), message.size());
+    }
+
+    // Only copy bytes here; parsing and the book update run on the builder thread
+    if (registry_) {
+        registry_->submit(producer_, symbol_, message.data(), message.size(), recv_ts_ns, recv_wall_ns);
+    } else {
+        BookBuilder::push(*ring_, symbol_, message.data(), message.size(), recv_ts_ns, recv_wall_ns);
     }
+    LatencyMonitor::instance().record(LatencyStage::Receive, LatencyMonitor::now_ns() - recv_ts_ns);
 }
@@ -2,20 +2,41 @@
 
 #include <string>
 #include <atomic>
+#include <memory>
 #include "orderbook.h"
+#include "book_registry.h"
+#include "book_builder.h"
+
+class FeedRecorder;
 
 class WebSocketClient {
 public:
+    // Single book: payloads are handed to a dedicated book-builder thread
     WebSocketClient(const std::string& uri, OrderBook& orderbook);
+    // Registry mode: payloads are handed to the shard that owns `symbol`.
+    // Construct before registry.start(), as this registers a producer.
+    WebSocketClient(const std::string& uri, BookRegistry& registry, SymbolId symbol);
     ~WebSocketClient();
 
     void run();
     void stop();
 
+    // Append every received payload to a binary capture (see feed_capture.h)
+    bool enable_capture(const std::string& path);
+
+    // Network thread -> book builder queue depth and high-water mark
+    FeedQueueStats queue_stats() const;
+
 private:
     std::string uri_;
-    OrderBook& orderbook_;
+    OrderBook* orderbook_;
+    BookRegistry* registry_;
+    SymbolId symbol_;
+    size_t producer_;
+    std::unique_ptr<BookBuilder> builder_;   // single-book mode only
+    FeedRing* ring_;
     std::atomic<bool> running_;
+    std::unique_ptr<FeedRecorder> recorder_;
 
     void on_message(const std::string& message);
     void connect();
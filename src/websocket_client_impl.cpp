@@ -1,18 +1,35 @@
 #include "websocket_client.h"
+#include "l2_parser.h"
+#include "feed_capture.h"
+#include "latency_histogram.h"
+#include "logger.h"
+#include "reconnect_backoff.h"
 #include <websocketpp/config/asio_no_tls_client.hpp>
 #include <websocketpp/client.hpp>
 #include <iostream>
 #include <thread>
 #include <chrono>
 #include <functional>
+#include <atomic>
 
 using websocketpp::connection_hdl;
 using client = websocketpp::client<websocketpp::config::asio_client>;
 
 class WebSocketClientImpl {
 public:
-    WebSocketClientImpl(const std::string& uri, OrderBook& orderbook)
-        : uri_(uri), orderbook_(orderbook), running_(false) {
+    WebSocketClientImpl(const std::string& uri, OrderBook* orderbook, BookRegistry* registry, SymbolId symbol)
+        : uri_(uri), orderbook_(orderbook), registry_(registry), symbol_(symbol), producer_(0),
+          ring_(nullptr), running_(false) {
+        if (registry_) {
+            producer_ = registry_->register_producer();
+        } else {
+            builder_.reset(new BookBuilder([this](const FeedMessage& message) {
+                apply_l2_payload(*orderbook_, message.payload);
+            }));
+            builder_->set_idle_handler([this]() { orderbook_->serve_depth(); });
+            ring_ = &builder_->add_input();
+        }
+
         client_.init_asio();
         client_.set_message_handler(std::bind(&WebSocketClientImpl::on_message, this, std::placeholders::_1, std::placeholders::_2));
         client_.set_open_handler(std::bind(&WebSocketClientImpl::on_open, this, std::placeholders::_1));
@@ -21,77 +38,128 @@ public:
     }
 
     void run() {
-        websocketpp::lib::error_code ec;
-        auto con = client_.get_connection(uri_, ec);
-        if (ec) {
-            std::cerr << "Could not create connection because: " << ec.message() << std::endl;
-            return;
-        }
-        hdl_ = con->get_handle();
-        client_.connect(con);
         running_ = true;
+        if (builder_) {
+            builder_->start();
+        }
+        // Perpetual: the loop stays up between a drop and the reconnect timer
+        client_.start_perpetual();
+        connect();
         client_.run();
     }
 
+    FeedQueueStats queue_stats() const {
+        return builder_ ? builder_->stats() : registry_->queue_stats(registry_->shard_of(symbol_));
+    }
+
+    bool enable_capture(const std::string& path) {
+        return recorder_.open(path);
+    }
+
     void stop() {
         running_ = false;
+        client_.stop_perpetual();
         websocketpp::lib::error_code ec;
         client_.close(hdl_, websocketpp::close::status::going_away, "", ec);
         if (ec) {
             std::cerr << "Error closing connection: " << ec.message() << std::endl;
         }
+        if (builder_) {
+            builder_->stop();
+            orderbook_->flush_depth();
+        }
     }
 
 private:
     void on_message(connection_hdl hdl, client::message_ptr msg) {
-        try {
-            auto start = std::chrono::high_resolution_clock::now();
-
-            std::cout << "[WebSocket] Received message of size: " << msg->get_payload().size() << std::endl;
-            std::cout << "[WebSocket] Message payload (truncated): " << msg->get_payload().substr(0, 200) << std::endl;
+        const int64_t recv_ts_ns = LatencyMonitor::now_ns();
+        const int64_t recv_wall_ns = LatencyMonitor::wall_ns();
 
-            orderbook_.update_from_json(nlohmann::json::parse(msg->get_payload()));
+        if (recorder_.is_open()) {
+            recorder_.append(msg->get_payload().data(), msg->get_payload().size());
+        }
 
-            auto end = std::chrono::high_resolution_clock::now();
-            std::chrono::duration<double, std::milli> processing_time = end - start;
-            std::cout << "[Benchmark] Data processing latency: " << processing_time.count() << " ms" << std::endl;
+        try {
+            // Only copy bytes on the asio thread; the book builder parses and applies
+            const std::string& payload = msg->get_payload();
+            if (registry_) {
+                registry_->submit(producer_, symbol_, payload.data(), payload.size(), recv_ts_ns, recv_wall_ns);
+            } else {
+                BookBuilder::push(*ring_, symbol_, payload.data(), payload.size(), recv_ts_ns, recv_wall_ns);
+            }
+
+            const int64_t handoff_ns = LatencyMonitor::now_ns() - recv_ts_ns;
+            LatencyMonitor::instance().record(LatencyStage::Receive, handoff_ns);
+
+            // Logging is asynchronous and the preview is truncated into the record,
+            // so the hot path never formats, allocates or touches stdout
+            LOG_DEBUG("[WebSocket] Received {} bytes, handoff {} ns: {}", payload.size(), handoff_ns, payload);
         } catch (const std::exception& e) {
-            std::cerr << "[WebSocket] Error parsing message: " << e.what() << std::endl;
+            LOG_ERROR("[WebSocket] Error handling message: {}", e.what());
         }
     }
 
+    void connect() {
+        websocketpp::lib::error_code ec;
+        auto con = client_.get_connection(uri_, ec);
+        if (ec) {
+            LOG_ERROR("[WebSocket] Could not create connection to {}: {}", uri_, ec.message());
+            return;
+        }
+        hdl_ = con->get_handle();
+        client_.connect(con);
+    }
+
     void on_open(connection_hdl hdl) {
-        std::cout << "[WebSocket] Connection opened." << std::endl;
+        LOG_INFO("[WebSocket] Connection opened: {}", uri_);
+        backoff_.reset();
     }
 
     void on_close(connection_hdl hdl) {
-        std::cout << "[WebSocket] Connection closed." << std::endl;
-        if (running_) {
-            std::cout << "[WebSocket] Attempting to reconnect in 5 seconds..." << std::endl;
-            std::this_thread::sleep_for(std::chrono::seconds(5));
-            run();
-        }
+        LOG_WARN("[WebSocket] Connection closed: {}", uri_);
+        schedule_reconnect();
     }
 
     void on_fail(connection_hdl hdl) {
-        std::cout << "[WebSocket] Connection failed." << std::endl;
-        if (running_) {
-            std::cout << "[WebSocket] Attempting to reconnect in 5 seconds..." << std::endl;
-            std::this_thread::sleep_for(std::chrono::seconds(5));
-            run();
+        LOG_WARN("[WebSocket] Connection failed: {}", uri_);
+        schedule_reconnect();
+    }
+
+    // Retry from a timer on the event loop rather than sleeping in the handler
+    // and re-entering run() (see ConnectionManager for many subscriptions)
+    void schedule_reconnect() {
+        if (!running_) {
+            return;
         }
+        const int64_t delay_ms = backoff_.next_delay_ms();
+        LOG_INFO("[WebSocket] Reconnecting to {} in {} ms", uri_, delay_ms);
+        client_.set_timer(static_cast<long>(delay_ms), [this](const websocketpp::lib::error_code& ec) {
+            if (!ec && running_) {
+                connect();
+            }
+        });
     }
 
     std::string uri_;
-    OrderBook& orderbook_;
+    OrderBook* orderbook_;
+    BookRegistry* registry_;
+    SymbolId symbol_;
+    size_t producer_;
+    std::unique_ptr<BookBuilder> builder_;   // single-book mode only
+    FeedRing* ring_;
+    FeedRecorder recorder_;
     client client_;
     connection_hdl hdl_;
-    bool running_;
+    ReconnectBackoff backoff_;
+    std::atomic<bool> running_;
 };
 
 // Wrapper class to hide implementation details
 WebSocketClient::WebSocketClient(const std::string& uri, OrderBook& orderbook)
-    : impl_(new WebSocketClientImpl(uri, orderbook)) {}
+    : impl_(new WebSocketClientImpl(uri, &orderbook, nullptr, BookRegistry::kInvalidSymbol)) {}
+
+WebSocketClient::WebSocketClient(const std::string& uri, BookRegistry& registry, SymbolId symbol)
+    : impl_(new WebSocketClientImpl(uri, nullptr, &registry, symbol)) {}
 
 WebSocketClient::~WebSocketClient() {
     stop();
@@ -105,3 +173,11 @@ void WebSocketClient::run() {
 void WebSocketClient::stop() {
     impl_->stop();
 }
+
+bool WebSocketClient::enable_capture(const std::string& path) {
+    return impl_->enable_capture(path);
+}
+
+FeedQueueStats WebSocketClient::queue_stats() const {
+    return impl_->queue_stats();
+}
@@ -0,0 +1,146 @@
+#include "work_stealing_pool.h"
+#include <algorithm>
+#include <exception>
+
+namespace {
+
+// Lets a nested parallel_for start from the calling worker's own deque
+thread_local const WorkStealingPool* tl_pool = nullptr;
+thread_local size_t tl_worker = 0;
+
+struct TaskGroup {
+    std::atomic<size_t> remaining{0};
+    std::mutex mutex;
+    std::condition_variable done;
+    std::exception_ptr error;
+};
+
+} // namespace
+
+WorkStealingPool::WorkStealingPool(size_t threads) : pending_(0), stopping_(false), steals_(0) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (size_t i = 0; i < threads; ++i) {
+        queues_.push_back(std::make_unique<Queue>());
+    }
+    for (size_t i = 0; i < threads; ++i) {
+        threads_.emplace_back([this, i]() { worker_loop(i); });
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (std::thread& thread : threads_) {
+        thread.join();
+    }
+}
+
+void WorkStealingPool::worker_loop(size_t index) {
+    tl_pool = this;
+    tl_worker = index;
+    while (true) {
+        if (run_one(index)) {
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleep_mutex_);
+        wake_.wait(lock, [this]() { return stopping_ || pending_.load(std::memory_order_acquire) > 0; });
+        if (stopping_ && pending_.load(std::memory_order_acquire) == 0) {
+            return;
+        }
+    }
+}
+
+bool WorkStealingPool::run_one(size_t home) {
+    Task task;
+    {
+        Queue& own = *queues_[home];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+        }
+    }
+    for (size_t i = 1; !task && i < queues_.size(); ++i) {
+        Queue& victim = *queues_[(home + i) % queues_.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            steals_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    if (!task) {
+        return false;
+    }
+    pending_.fetch_sub(1, std::memory_order_acq_rel);
+    task();
+    return true;
+}
+
+void WorkStealingPool::parallel_for(size_t begin, size_t end, size_t grain,
+                                    const std::function<void(size_t, size_t)>& body) {
+    if (begin >= end) {
+        return;
+    }
+    grain = std::max<size_t>(grain, 1);
+    const size_t chunks = (end - begin + grain - 1) / grain;
+    if (chunks == 1) {
+        body(begin, end);
+        return;
+    }
+
+    auto group = std::make_shared<TaskGroup>();
+    group->remaining.store(chunks, std::memory_order_relaxed);
+    auto make_task = [&body, group, begin, end, grain](size_t chunk) {
+        const size_t lo = begin + chunk * grain;
+        const size_t hi = std::min(end, lo + grain);
+        return [&body, group, lo, hi]() {
+            try {
+                body(lo, hi);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(group->mutex);
+                if (!group->error) {
+                    group->error = std::current_exception();
+                }
+            }
+            if (group->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                std::lock_guard<std::mutex> lock(group->mutex);
+                group->done.notify_all();
+            }
+        };
+    };
+
+    // Deal contiguous runs of chunks, one run per worker deque
+    const size_t per_queue = (chunks + queues_.size() - 1) / queues_.size();
+    pending_.fetch_add(chunks, std::memory_order_acq_rel);
+    for (size_t q = 0, chunk = 0; q < queues_.size() && chunk < chunks; ++q) {
+        std::lock_guard<std::mutex> lock(queues_[q]->mutex);
+        for (size_t n = 0; n < per_queue && chunk < chunks; ++n, ++chunk) {
+            queues_[q]->tasks.emplace_back(make_task(chunk));
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+    }
+    wake_.notify_all();
+
+    // Help until the group is done; once nothing is left to take, the
+    // remaining chunks are running elsewhere and we just wait for them
+    const size_t home = tl_pool == this ? tl_worker : 0;
+    while (group->remaining.load(std::memory_order_acquire) > 0) {
+        if (!run_one(home)) {
+            std::unique_lock<std::mutex> lock(group->mutex);
+            group->done.wait(lock, [&group]() { return group->remaining.load(std::memory_order_acquire) == 0; });
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(group->mutex);
+    if (group->error) {
+        std::rethrow_exception(group->error);
+    }
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed-size thread pool with one task deque per worker and stealing.
+//
+// parallel_for splits a range into chunks and deals contiguous runs of
+// chunks to the workers' deques. A worker pops its own deque from the back.
+// When its deque is empty it steals from the front of the others, so uneven
+// chunks even out without a shared queue. The calling thread runs chunks too
+// while it waits, so parallel_for can be called from inside a task. Results
+// must not depend on which thread ran a chunk; callers that need
+// reproducibility derive any randomness from the chunk index.
+class WorkStealingPool {
+public:
+    explicit WorkStealingPool(size_t threads = 0);   // 0 = one per hardware thread
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    size_t size() const { return threads_.size(); }
+
+    // Run body(chunk_begin, chunk_end) over [begin, end) in chunks of `grain`
+    // and block until every chunk is done. The first exception thrown by a
+    // chunk is rethrown here after the rest have finished.
+    void parallel_for(size_t begin, size_t end, size_t grain, const std::function<void(size_t, size_t)>& body);
+
+    uint64_t steals() const { return steals_.load(std::memory_order_relaxed); }
+
+private:
+    using Task = std::function<void()>;
+
+    struct alignas(64) Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues_;   // one per worker
+    std::vector<std::thread> threads_;
+
+    std::mutex sleep_mutex_;
+    std::condition_variable wake_;
+    std::atomic<size_t> pending_;   // queued, not yet taken
+    bool stopping_;                 // guarded by sleep_mutex_
+    std::atomic<uint64_t> steals_;
+
+    void worker_loop(size_t index);
+    // Pop from queue `home` (back), else steal from the others (front)
+    bool run_one(size_t home);
+};
@@ -1,7 +1,24 @@
 #include <iostream>
 #include <chrono>
 #include <thread>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <algorithm>
 #include "../src/models.h"  // Adjust path if needed
+#include "../src/orderbook.h"
+#include "../src/l2_parser.h"
+#include "../src/feed_capture.h"
+#include "../src/latency_histogram.h"
+#include "../src/volatility_estimator.h"
+#include "../src/slippage_quantiles.h"
+#include "../src/monte_carlo.h"
+#include "../src/work_stealing_pool.h"
+#include "../src/scenario_sweep.h"
+#include "../src/fee_schedule.h"
+#include "../src/model_evaluator.h"
+#include "../src/feed_compression.h"
+#include "../src/synthetic_feed.h"
 
 // Benchmark macros with unique IDs to avoid redefinition
 #define BENCHMARK_START(id) auto bench_start_##id = std::chrono::high_resolution_clock::now();
@@ -17,30 +34,331 @@ void benchmark_regression_model(Models& models, int iterations) {
     double quantity = 100.0;
     double volatility = 0.05;
 
-    // Optimized version benchmark
-    BENCHMARK_START(opt)
+    BENCHMARK_START(base)
     for (int i = 0; i < iterations; ++i) {
-        volatile double slippage = models.calculate_slippage_optimized(quantity, volatility);
+        volatile double slippage = models.calculate_slippage(quantity, volatility);
         (void)slippage;
     }
-    BENCHMARK_END(opt, "Regression model optimized slippage calculation")
+    BENCHMARK_END(base, "Regression model slippage calculation")
+}
 
-    // Baseline version benchmark
-    BENCHMARK_START(base)
+// Scoring many candidate child orders: per-order calls versus the batch kernels
+void benchmark_batch_models(Models& models, size_t orders, int rounds) {
+    std::vector<double> quantity(orders), volatility(orders), out(orders);
+    std::vector<int> tier(orders);
+    for (size_t i = 0; i < orders; ++i) {
+        quantity[i] = 10.0 + static_cast<double>(i % 1000);
+        volatility[i] = 0.01 + 0.001 * static_cast<double>(i % 100);
+        tier[i] = 1 + static_cast<int>(i % 3);
+    }
+
+    BENCHMARK_START(per_order)
+    for (int r = 0; r < rounds; ++r) {
+        for (size_t i = 0; i < orders; ++i) {
+            out[i] = models.calculate_net_cost(quantity[i], volatility[i], tier[i])
+                   + models.predict_maker_taker_proportion(quantity[i], volatility[i]);
+        }
+    }
+    BENCHMARK_END(per_order, "Per-order net cost + maker/taker")
+
+    std::vector<double> maker_taker(orders);
+    BENCHMARK_START(batch)
+    for (int r = 0; r < rounds; ++r) {
+        models.calculate_net_cost_batch(quantity.data(), volatility.data(), tier.data(), orders, out.data());
+        models.predict_maker_taker_proportion_batch(quantity.data(), volatility.data(), orders, maker_taker.data());
+    }
+    const char* label = Models::simd_enabled() ? "Batch net cost + maker/taker (AVX2)" : "Batch net cost + maker/taker (scalar)";
+    BENCHMARK_END(batch, label)
+}
+
+// Fee lookup across a 10-tier venue: per-order table load vs batch gather
+void benchmark_fee_schedules(size_t orders, int rounds) {
+    FeeScheduleRegistry schedules(1);
+    schedules.assign(0, venues::Binance::schedule.name);
+    Models models;
+    models.set_fee_schedules(&schedules);
+    std::vector<double> quantity(orders), out(orders);
+    std::vector<int> tier(orders);
+    for (size_t i = 0; i < orders; ++i) {
+        quantity[i] = 10.0 + static_cast<double>(i % 1000);
+        tier[i] = static_cast<int>(i % 12);   // includes out-of-range tiers
+    }
+
+    BENCHMARK_START(per_order)
+    for (int r = 0; r < rounds; ++r) {
+        for (size_t i = 0; i < orders; ++i) {
+            out[i] = models.calculate_fees(quantity[i], tier[i]);
+        }
+    }
+    BENCHMARK_END(per_order, "Per-order fees (10 tiers)")
+
+    BENCHMARK_START(batch)
+    for (int r = 0; r < rounds; ++r) {
+        models.calculate_fees_batch(quantity.data(), tier.data(), orders, out.data());
+    }
+    BENCHMARK_END(batch, "Batch fees (10 tiers)")
+}
+
+// UI-style evaluation: every frame recomputes vs memoized on unchanged inputs
+void benchmark_model_evaluator(Models& models, int frames) {
+    BENCHMARK_START(recompute)
+    double sink = 0.0;
+    for (int f = 0; f < frames; ++f) {
+        sink += models.calculate_slippage(100.0, 0.05) + models.calculate_fees(100.0, 1)
+              + models.calculate_market_impact(100.0, 0.05) + models.calculate_net_cost(100.0, 0.05, 1)
+              + models.predict_maker_taker_proportion(100.0, 0.05) + models.optimal_schedule(100.0, 0.05).expected_cost;
+    }
+    BENCHMARK_END(recompute, "Per-frame model recompute")
+
+    ModelEvaluator evaluator(models);
+    BENCHMARK_START(memoized)
+    for (int f = 0; f < frames; ++f) {
+        // A new book version every 10th frame
+        sink += evaluator.evaluate(100.0, 0.05, 1, static_cast<uint64_t>(f / 10)).net_cost;
+    }
+    BENCHMARK_END(memoized, "Memoized model evaluation (1 in 10 frames changes)")
+    std::cout << "  " << evaluator.hits() << " hits, " << evaluator.misses() << " misses (" << (sink > 0.0 ? "ok" : "") << ")"
+              << std::endl;
+}
+
+// Payloads in the shape recorded from the feed: a 400-level flat snapshot and a small OKX delta
+std::string make_snapshot_payload(int depth) {
+    std::string payload = R"({"timestamp":"2025-05-04T10:39:13Z","exchange":"OKX","symbol":"BTC-USDT-SWAP","asks":[)";
+    char level[64];
+    for (int i = 0; i < depth; ++i) {
+        std::snprintf(level, sizeof(level), "%s[\"%.1f\",\"%.2f\"]", i ? "," : "", 95445.5 + i * 0.1, 1.0 + (i % 17) * 0.37);
+        payload += level;
+    }
+    payload += R"(],"bids":[)";
+    for (int i = 0; i < depth; ++i) {
+        std::snprintf(level, sizeof(level), "%s[\"%.1f\",\"%.2f\"]", i ? "," : "", 95445.4 - i * 0.1, 2.0 + (i % 13) * 0.41);
+        payload += level;
+    }
+    payload += "]}";
+    return payload;
+}
+
+const char* kUpdatePayload =
+    R"({"arg":{"channel":"books","instId":"BTC-USDT-SWAP"},"action":"update","data":[{)"
+    R"("asks":[["95445.5","3.1","0","2"],["95446.1","0","0","0"],["95447.0","0.8","0","1"]],)"
+    R"("bids":[["95445.4","1.2","0","1"],["95444.9","0","0","0"]],"ts":"1714819153085","checksum":-855196043}]})";
+
+// Benchmark DOM (nlohmann + std::stod) against the streaming L2 parser
+void benchmark_l2_parsing(int iterations) {
+    const std::string snapshot = make_snapshot_payload(400);
+    const std::string update = kUpdatePayload;
+    OrderBook dom_book;
+    OrderBook fast_book;
+
+    BENCHMARK_START(dom_snap)
     for (int i = 0; i < iterations; ++i) {
-        volatile double slippage = models.calculate_slippage(quantity, volatility);
-        (void)slippage;
+        dom_book.update_from_json(nlohmann::json::parse(snapshot));
+    }
+    BENCHMARK_END(dom_snap, "DOM parser, 400-level snapshot")
+
+    BENCHMARK_START(fast_snap)
+    for (int i = 0; i < iterations; ++i) {
+        apply_l2_payload(fast_book, snapshot);
+    }
+    BENCHMARK_END(fast_snap, "Streaming parser, 400-level snapshot")
+
+    BENCHMARK_START(dom_upd)
+    for (int i = 0; i < iterations * 10; ++i) {
+        dom_book.update_from_json(nlohmann::json::parse(update));
+    }
+    BENCHMARK_END(dom_upd, "DOM parser, incremental update (x10)")
+
+    BENCHMARK_START(fast_upd)
+    for (int i = 0; i < iterations * 10; ++i) {
+        apply_l2_payload(fast_book, update);
+    }
+    BENCHMARK_END(fast_upd, "Streaming parser, incremental update (x10)")
+}
+
+// Inflating raw deflate frames: one reused context and buffer versus a fresh context per message
+void benchmark_inflate(size_t messages) {
+    SyntheticFeedConfig config;
+    config.depth = 400;
+    config.levels_per_update = 20;
+    config.snapshot_every = 1000;
+    SyntheticFeed feed(config, 0);
+    std::vector<std::string> frames;
+    size_t plain = 0;
+    FeedDeflater deflater;
+    for (size_t i = 0; i < messages; ++i) {
+        const std::string& payload = feed.next(1700000000000 + static_cast<int64_t>(i));
+        plain += payload.size();
+        deflater.deflate(payload.data(), payload.size());
+        frames.emplace_back(deflater.data(), deflater.size());
+    }
+
+    size_t inflated = 0;
+    FeedInflater reused;
+    BENCHMARK_START(reused)
+    for (const std::string& frame : frames) {
+        reused.inflate(frame.data(), frame.size());
+        inflated += reused.size();
+    }
+    BENCHMARK_END(reused, "Raw inflate, reused context (" + std::to_string(messages) + " messages)")
+
+    BENCHMARK_START(fresh)
+    for (const std::string& frame : frames) {
+        FeedInflater fresh;
+        fresh.inflate(frame.data(), frame.size());
+        inflated += fresh.size();
+    }
+    BENCHMARK_END(fresh, "Raw inflate, context per message (" + std::to_string(messages) + " messages)")
+    if (inflated != 2 * plain) {
+        std::cout << "Inflated size mismatch" << std::endl;
+    }
+}
+
+// Replay a recorded capture through the parse/apply pipeline as fast as possible
+void benchmark_capture_replay(const std::string& path) {
+    FeedReplay replay;
+    if (!replay.open(path)) {
+        std::cerr << "Could not open capture " << path << std::endl;
+        return;
+    }
+
+    OrderBook book;
+    size_t messages = 0;
+    BENCHMARK_START(replay)
+    messages = replay.replay_into(book);
+    BENCHMARK_END(replay, "Capture replay through parse/apply")
+
+    auto start = std::chrono::high_resolution_clock::now();
+    replay.replay_into(book);
+    std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+    std::cout << "Replayed " << messages << " messages: " << (messages / elapsed.count()) << " msgs/s, "
+              << (elapsed.count() * 1e9 / (messages ? messages : 1)) << " ns/msg" << std::endl;
+
+    // Per-message tails, not just the mean
+    for (LatencyStage stage : {LatencyStage::Parse, LatencyStage::Apply}) {
+        const LatencySummary s = LatencyMonitor::instance().summary(stage);
+        std::cout << "  " << latency_stage_name(stage) << ": p50 " << s.p50_ns << " ns, p99 " << s.p99_ns
+                  << " ns, p99.9 " << s.p999_ns << " ns, max " << s.max_ns << " ns" << std::endl;
+    }
+}
+
+// Per-tick cost of the realized-volatility estimator (EWMA + window + Parkinson bars)
+void benchmark_volatility_estimator(int ticks) {
+    VolatilityEstimator estimator;
+    OrderLevel bid{100.0, 1.0};
+    OrderLevel ask{100.1, 2.0};
+    BENCHMARK_START(vol)
+    for (int i = 0; i < ticks; ++i) {
+        bid.price = 100.0 + 0.1 * (i % 7);
+        ask.price = bid.price + 0.1;
+        estimator.on_top_of_book(static_cast<int64_t>(i) * 1000000, bid, ask);   // 1 ms apart
+    }
+    BENCHMARK_END(vol, "Volatility estimator, " << ticks << " ticks")
+    volatile double sigma = estimator.volatility();
+    (void)sigma;
+}
+
+// Insert and query cost of the bucketed slippage quantile model
+void benchmark_slippage_quantiles(int observations, int queries) {
+    SlippageQuantileModel model(1);
+    BENCHMARK_START(qadd)
+    for (int i = 0; i < observations; ++i) {
+        model.add(0, 1000.0 * (1 + i % 200), 1e-5 * (1 + i % 50), 1e-4 * (1 + i % 97));
+    }
+    model.publish();
+    BENCHMARK_END(qadd, "Quantile model, " << observations << " observations + publish")
+
+    double sink = 0.0;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < queries; ++i) {
+        sink += model.quantiles(0, 1000.0 * (1 + i % 200), 1e-5 * (1 + i % 50)).p99;
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::high_resolution_clock::now() - start;
+    std::cout << "Quantile model query: " << elapsed.count() / queries << " ns/query" << std::endl;
+    volatile double keep = sink;
+    (void)keep;
+}
+
+// Monte Carlo throughput per pool size: paths/s should scale with cores
+void benchmark_monte_carlo(size_t paths) {
+    BookSnapshot book;
+    book.version = 1;
+    book.ask_count = book.bid_count = 400;
+    for (size_t i = 0; i < 400; ++i) {
+        book.asks[i] = {100.05 + 0.1 * i, 5.0 + i % 7};
+        book.bids[i] = {99.95 - 0.1 * i, 5.0 + i % 5};
+    }
+    ExecutionPlan plan;
+    plan.slice_notional.assign(10, 10000.0);
+    MonteCarloParams params;
+    params.paths = paths;
+    params.volatility = 1e-3;
+
+    const size_t hardware = std::max(1u, std::thread::hardware_concurrency());
+    double single_rate = 0.0;
+    for (size_t threads = 1; threads <= hardware; threads *= 2) {
+        WorkStealingPool pool(threads);
+        MonteCarloCostEngine engine(pool);
+        engine.simulate(book, plan, params);   // warm-up
+        auto start = std::chrono::high_resolution_clock::now();
+        const CostDistribution result = engine.simulate(book, plan, params);
+        std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+        const double rate = paths / elapsed.count();
+        single_rate = threads == 1 ? rate : single_rate;
+        std::cout << "Monte Carlo, " << threads << " thread(s): " << rate << " paths/s (x" << rate / single_rate
+                  << "), mean " << result.mean << ", CVaR95 " << result.cvar << std::endl;
+    }
+}
+
+// Net-cost surface: cold sweep per thread count, then a warm sweep with one quantity edited
+void benchmark_scenario_sweep(Models& models, size_t steps) {
+    ScenarioGrid grid;
+    grid.quantities = ScenarioGrid::linspace(10.0, 100000.0, steps);
+    grid.volatilities = ScenarioGrid::linspace(1e-5, 1e-3, steps);
+    grid.fee_tiers = {1, 2, 3};
+
+    const size_t hardware = std::max(1u, std::thread::hardware_concurrency());
+    double single_rate = 0.0;
+    for (size_t threads = 1; threads <= hardware; threads *= 2) {
+        WorkStealingPool pool(threads);
+        ScenarioSweep sweep(pool);
+        auto start = std::chrono::high_resolution_clock::now();
+        sweep.run(models, grid);
+        std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+        const double rate = grid.size() / elapsed.count();
+        single_rate = threads == 1 ? rate : single_rate;
+        std::cout << "Scenario sweep (" << grid.size() << " cells), " << threads << " thread(s): " << rate
+                  << " cells/s (x" << rate / single_rate << ")" << std::endl;
+
+        ScenarioGrid edited = grid;
+        edited.quantities[steps / 2] += 1.0;
+        start = std::chrono::high_resolution_clock::now();
+        const ScenarioSurface& warm = sweep.run(models, edited);
+        elapsed = std::chrono::high_resolution_clock::now() - start;
+        std::cout << "  warm sweep: " << warm.cells_computed << " computed, " << warm.cells_reused << " reused in "
+                  << elapsed.count() * 1e6 << " us" << std::endl;
     }
-    BENCHMARK_END(base, "Regression model baseline slippage calculation")
 }
 
 // Main benchmark runner
-int main() {
+// Usage: benchmark_tests [capture.feed]
+int main(int argc, char** argv) {
     Models models;
 
     std::cout << "Starting benchmark tests..." << std::endl;
 
     benchmark_regression_model(models, 1000000);
+    benchmark_batch_models(models, 4096, 1000);
+    benchmark_fee_schedules(4096, 1000);
+    benchmark_model_evaluator(models, 100000);
+    benchmark_l2_parsing(1000);
+    benchmark_inflate(20000);
+    benchmark_volatility_estimator(1000000);
+    benchmark_slippage_quantiles(1000000, 1000000);
+    benchmark_monte_carlo(200000);
+    benchmark_scenario_sweep(models, 128);
+    if (argc > 1) {
+        benchmark_capture_replay(argv[1]);
+    }
 
     std::cout << "Benchmark tests completed." << std::endl;
     return 0;
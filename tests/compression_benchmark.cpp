@@ -0,0 +1,161 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "book_registry.h"
+#include "connection_manager.h"
+#include "feed_compression.h"
+#include "feed_server.h"
+#include "latency_histogram.h"
+#include "logger.h"
+#include "synthetic_feed.h"
+
+// End-to-end throughput with and without compression: local feed server ->
+// ConnectionManager -> book shards, once per mode over the same streams.
+//
+// compression_benchmark [--symbols n] [--messages n per symbol] [--rate msgs/s, 0 = unpaced]
+//                       [--depth n] [--levels n] [--deflate-level n]
+// Loopback has no bandwidth limit, so the msgs/s column shows the CPU cost
+// of compressing; the wire column shows what a real link would carry.
+namespace {
+
+struct RunResult {
+    bool complete = false;
+    bool books_match = false;
+    bool negotiated = false;
+    double seconds = 0.0;
+    uint64_t messages = 0;
+    uint64_t payload_bytes = 0;
+    uint64_t wire_bytes = 0;   // 0 when the WebSocket layer compressed and the size is not visible
+    LatencySummary receive;
+    LatencySummary apply;
+};
+
+RunResult run(const FeedServerConfig& base_config, FeedCompression compression) {
+    RunResult result;
+    FeedServerConfig server_config = base_config;
+    server_config.raw_deflate = compression == FeedCompression::RawDeflate;
+    SyntheticFeedServer server(server_config);
+    const uint16_t port = server.listen(0);
+    if (port == 0) {
+        return result;
+    }
+    server.start();
+    LatencyMonitor::instance().reset();
+
+    BookRegistry registry(server_config.symbols < 4 ? server_config.symbols : 4);
+    ConnectionManagerConfig feed_config;
+    feed_config.io_threads = server_config.symbols < 2 ? 1 : 2;
+    feed_config.backoff.initial_ms = 60000;   // streams end with a close; do not reconnect
+    ConnectionManager feeds(registry, feed_config);
+    const std::string base = "ws://127.0.0.1:" + std::to_string(port) + "/ws/l2-orderbook/okx/";
+    std::vector<SymbolId> ids;
+    for (size_t i = 0; i < server_config.symbols; ++i) {
+        const std::string symbol = synthetic_symbol_name(i);
+        ids.push_back(registry.add_symbol(symbol, server_config.feed.tick_size));
+        FeedSubscription subscription{base + symbol, ids.back(), ""};
+        subscription.compression = compression;
+        feeds.add_subscription(subscription);
+    }
+
+    registry.start();
+    const auto start = std::chrono::steady_clock::now();
+    feeds.start();
+    const auto deadline = start + std::chrono::seconds(120);
+    while (!result.complete && std::chrono::steady_clock::now() < deadline) {
+        result.complete = true;
+        for (size_t i = 0; i < feeds.size(); ++i) {
+            result.complete = result.complete && feeds.stats(i).messages >= server_config.max_messages;
+        }
+        if (!result.complete) {
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+    }
+    feeds.stop();
+    registry.stop();   // drains the shard rings, so every book is final
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    server.stop();
+
+    result.negotiated = true;
+    for (size_t i = 0; i < feeds.size(); ++i) {
+        const ConnectionStats stats = feeds.stats(i);
+        result.messages += stats.messages;
+        result.payload_bytes += stats.payload_bytes;
+        result.wire_bytes += stats.compressed_bytes;
+        result.negotiated = result.negotiated && stats.permessage_deflate;
+    }
+    if (compression == FeedCompression::None) {
+        result.wire_bytes = result.payload_bytes;
+    }
+
+    result.books_match = result.complete;
+    for (size_t i = 0; i < ids.size() && result.books_match; ++i) {
+        SyntheticFeed reference(server_config.feed, i);
+        for (uint64_t m = 0; m < server_config.max_messages; ++m) {
+            reference.next();
+        }
+        OrderLevel bid, ask;
+        result.books_match = registry.book(ids[i]).read_top(bid, ask) && bid.price == reference.best_bid()
+                             && ask.price == reference.best_ask();
+    }
+    result.receive = LatencyMonitor::instance().summary(LatencyStage::Receive);
+    result.apply = LatencyMonitor::instance().summary(LatencyStage::Apply);
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    FeedServerConfig server_config;
+    server_config.symbols = 2;
+    server_config.rate = 0.0;
+    server_config.max_messages = 50000;
+    server_config.feed.depth = 400;
+    server_config.feed.levels_per_update = 20;
+    server_config.feed.snapshot_every = 1000;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const std::string arg = argv[i];
+        if (arg == "--symbols") server_config.symbols = std::strtoull(argv[i + 1], nullptr, 10);
+        else if (arg == "--messages") server_config.max_messages = std::strtoull(argv[i + 1], nullptr, 10);
+        else if (arg == "--rate") server_config.rate = std::atof(argv[i + 1]);
+        else if (arg == "--depth") server_config.feed.depth = std::strtoull(argv[i + 1], nullptr, 10);
+        else if (arg == "--levels") server_config.feed.levels_per_update = std::strtoull(argv[i + 1], nullptr, 10);
+        else if (arg == "--deflate-level") server_config.deflate_level = std::atoi(argv[i + 1]);
+    }
+    if (server_config.symbols == 0 || server_config.max_messages == 0) {
+        std::cerr << "Need at least one symbol and one message." << std::endl;
+        return 1;
+    }
+
+    Logger::instance().start();
+    std::cout << "Compression benchmark: " << server_config.symbols << " symbol(s) x "
+              << server_config.max_messages << " messages, depth " << server_config.feed.depth << ", "
+              << server_config.feed.levels_per_update << " levels per delta" << std::endl;
+
+    bool ok = true;
+    for (FeedCompression compression :
+         {FeedCompression::None, FeedCompression::PerMessageDeflate, FeedCompression::RawDeflate}) {
+        const RunResult r = run(server_config, compression);
+        if (!r.complete || !r.books_match) {
+            std::cerr << feed_compression_name(compression) << ": "
+                      << (r.complete ? "books diverged" : "timed out") << std::endl;
+            ok = false;
+            continue;
+        }
+        std::cout << "  " << feed_compression_name(compression) << ": " << r.messages / r.seconds << " msgs/s, "
+                  << r.payload_bytes / 1e6 / r.seconds << " MB/s of JSON";
+        if (r.wire_bytes > 0) {
+            std::cout << ", wire " << r.wire_bytes / 1e6 << " MB ("
+                      << static_cast<double>(r.payload_bytes) / r.wire_bytes << "x)";
+        } else if (compression == FeedCompression::PerMessageDeflate) {
+            std::cout << (r.negotiated ? ", negotiated" : ", declined by the server");
+        }
+        std::cout << ", receive p50 " << r.receive.p50_ns / 1000.0 << " us p99 " << r.receive.p99_ns / 1000.0
+                  << " us, apply p50 " << r.apply.p50_ns / 1000.0 << " us" << std::endl;
+    }
+
+    Logger::instance().stop();
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,229 @@
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <future>
+#include <set>
+#include <string>
+#include <thread>
+#include "book_registry.h"
+#include "connection_manager.h"
+#include "logger.h"
+#include "test_util.h"
+#include <websocketpp/config/asio_no_tls.hpp>
+#include <websocketpp/server.hpp>
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/post.hpp>
+
+// Connection manager tests against a local stand-in for the venue: many
+// subscriptions on one io thread, reconnect with backoff, resubscribe and
+// snapshot resync after a drop
+using ws_server = websocketpp::server<websocketpp::config::asio>;
+using websocketpp::connection_hdl;
+
+// Accepts any path. On open it sends a stale delta that a resyncing client
+// must hold back. A subscribe request is answered with a snapshot whose
+// best ask moves with each connection: 101 + connection number. Only the
+// first two connections get a follow-up delta adding a 100.5 ask.
+class StandInServer {
+public:
+    StandInServer() : work_(boost::asio::make_work_guard(io_)) {
+        server_.clear_access_channels(websocketpp::log::alevel::all);
+        server_.clear_error_channels(websocketpp::log::elevel::all);
+        server_.init_asio(&io_);
+        server_.set_reuse_addr(true);
+        server_.set_open_handler([this](connection_hdl hdl) { on_open(hdl); });
+        server_.set_close_handler([this](connection_hdl hdl) { open_.erase(hdl); });
+        server_.set_message_handler([this](connection_hdl hdl, ws_server::message_ptr msg) {
+            on_subscribe(hdl, msg->get_payload());
+        });
+    }
+
+    ~StandInServer() { stop(); }
+
+    uint16_t listen(uint16_t port) {
+        server_.listen(boost::asio::ip::tcp::endpoint(boost::asio::ip::address_v4::loopback(), port));
+        server_.start_accept();
+        websocketpp::lib::asio::error_code ec;
+        return server_.get_local_endpoint(ec).port();
+    }
+
+    void start() {
+        thread_ = std::thread([this]() { io_.run(); });
+    }
+
+    // Close every client connection, as a venue restart would
+    void drop_all() {
+        run_on_io([this]() {
+            for (connection_hdl hdl : std::set<connection_hdl, std::owner_less<connection_hdl>>(open_)) {
+                websocketpp::lib::error_code ec;
+                server_.close(hdl, websocketpp::close::status::service_restart, "", ec);
+            }
+        });
+    }
+
+    void stop_listening() {
+        run_on_io([this]() {
+            websocketpp::lib::error_code ec;
+            server_.stop_listening(ec);
+        });
+    }
+
+    void resume_listening(uint16_t port) {
+        run_on_io([this, port]() { listen(port); });
+    }
+
+    void stop() {
+        if (!thread_.joinable()) {
+            return;
+        }
+        stop_listening();
+        drop_all();
+        boost::asio::post(io_, [this]() { work_.reset(); });
+        thread_.join();
+    }
+
+    uint64_t opens() const { return opens_.load(); }
+    uint64_t subscribes() const { return subscribes_.load(); }
+
+private:
+    boost::asio::io_context io_;
+    boost::asio::executor_work_guard<boost::asio::io_context::executor_type> work_;
+    ws_server server_;
+    std::thread thread_;
+    std::set<connection_hdl, std::owner_less<connection_hdl>> open_;   // io thread only
+    std::atomic<uint64_t> opens_{0};
+    std::atomic<uint64_t> subscribes_{0};
+
+    void run_on_io(std::function<void()> task) {
+        std::promise<void> done;
+        boost::asio::post(io_, [&task, &done]() {
+            task();
+            done.set_value();
+        });
+        done.get_future().wait();
+    }
+
+    void send(connection_hdl hdl, const std::string& payload) {
+        websocketpp::lib::error_code ec;
+        server_.send(hdl, payload, websocketpp::frame::opcode::text, ec);
+    }
+
+    void on_open(connection_hdl hdl) {
+        open_.insert(hdl);
+        opens_.fetch_add(1);
+        send(hdl, R"({"action":"update","asks":[["90.0","1.0"]],"bids":[]})");
+    }
+
+    void on_subscribe(connection_hdl hdl, const std::string& request) {
+        if (request.find("subscribe") == std::string::npos) {
+            return;
+        }
+        const uint64_t connection = subscribes_.fetch_add(1) + 1;
+        const std::string ask = std::to_string(101 + connection) + ".0";
+        send(hdl, R"({"asks":[[")" + ask + R"(","2.0"]],"bids":[["99.0","3.0"]]})");
+        if (connection <= 2) {
+            send(hdl, R"({"action":"update","asks":[["100.5","1.0"]],"bids":[]})");
+        }
+    }
+};
+
+bool wait_for(const std::function<bool()>& condition, int timeout_ms = 5000) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    while (!condition()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    return true;
+}
+
+double best_ask(const BookRegistry& registry, SymbolId id) {
+    OrderLevel bid, ask;
+    return registry.book(id).read_top(bid, ask) ? ask.price : 0.0;
+}
+
+void test_reconnect_and_resync() {
+    StandInServer server;
+    const uint16_t port = server.listen(0);
+    server.start();
+
+    BookRegistry registry(1);
+    const SymbolId a = registry.add_symbol("A", 0.1);
+    const SymbolId b = registry.add_symbol("B", 0.1);
+
+    ConnectionManagerConfig config;
+    config.io_threads = 1;   // both subscriptions share one io_context
+    config.backoff.initial_ms = 10;
+    config.backoff.max_ms = 80;
+    ConnectionManager manager(registry, config);
+    const std::string base = "ws://127.0.0.1:" + std::to_string(port);
+    const size_t sub_a = manager.add_subscription({base + "/a", a, R"({"op":"subscribe","args":["A"]})"});
+    const size_t sub_b = manager.add_subscription({base + "/b", b, R"({"op":"subscribe","args":["B"]})"});
+    registry.start();
+    manager.start();
+
+    // Snapshot then delta applied; the delta sent before the subscribe was held back
+    CHECK(wait_for([&]() { return best_ask(registry, a) == 100.5 && best_ask(registry, b) == 100.5; }),
+          "both books built over one io thread");
+    CHECK(manager.stats(sub_a).held_back == 1 && manager.stats(sub_b).held_back == 1, "pre-snapshot delta held back");
+    CHECK(manager.stats(sub_a).state == ConnectionState::Open && manager.stats(sub_a).connects == 1, "open");
+
+    // Venue restart: both reconnect on a timer, resubscribe and resync from a fresh snapshot
+    server.drop_all();
+    CHECK(wait_for([&]() { return server.subscribes() == 4; }), "resubscribed after drop");
+    CHECK(wait_for([&]() { return best_ask(registry, a) > 102.5 && best_ask(registry, b) > 102.5; }),
+          "books rebuilt from the new snapshot, stale levels gone");
+    CHECK(manager.stats(sub_a).drops == 1 && manager.stats(sub_a).connects == 2 && manager.stats(sub_a).held_back == 2,
+          "drop counted, stale delta held back again");
+
+    // Venue down: attempts fail and the delay grows to the cap, without blocking the other subscription
+    server.stop_listening();
+    server.drop_all();
+    CHECK(wait_for([&]() { return manager.stats(sub_a).failures >= 4 && manager.stats(sub_b).failures >= 4; }),
+          "failed attempts retried");
+    CHECK(manager.stats(sub_a).last_retry_delay_ms <= config.backoff.max_ms, "delay capped");
+    server.resume_listening(port);
+    CHECK(wait_for([&]() { return manager.stats(sub_a).state == ConnectionState::Open
+                                  && manager.stats(sub_b).state == ConnectionState::Open; }),
+          "reconnected once the venue is back");
+
+    const auto stop_start = std::chrono::steady_clock::now();
+    manager.stop();
+    const double stop_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - stop_start).count();
+    CHECK(stop_ms < 2000.0 && manager.stats(sub_a).state == ConnectionState::Stopped, "stop closes and joins promptly");
+    registry.stop();
+    server.stop();
+}
+
+void test_bad_uri() {
+    BookRegistry registry(1);
+    const SymbolId a = registry.add_symbol("A", 0.1);
+    ConnectionManager manager(registry);
+    const size_t sub = manager.add_subscription({"not a uri", a, ""});
+    registry.start();
+    manager.start();
+    CHECK(wait_for([&]() { return manager.stats(sub).state == ConnectionState::Stopped; }), "bad URI is not retried");
+    manager.stop();
+    registry.stop();
+}
+
+int main() {
+    std::cout << "Starting connection manager tests..." << std::endl;
+    Logger::instance().start();
+
+    test_reconnect_and_resync();
+    test_bad_uri();
+
+    Logger::instance().stop();
+    if (failures > 0) {
+        std::cerr << failures << " connection manager test(s) failed." << std::endl;
+        return 1;
+    }
+
+    std::cout << "Connection manager tests completed." << std::endl;
+    return 0;
+}
@@ -0,0 +1,471 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cmath>
+#include <algorithm>
+#include "orderbook.h"
+#include "l2_parser.h"
+#include "feed_capture.h"
+#include "spsc_ring.h"
+#include "book_builder.h"
+#include "logger.h"
+#include "reconnect_backoff.h"
+#include "synthetic_feed.h"
+#include "feed_compression.h"
+#include "feed_latency.h"
+#include "test_util.h"
+#include <cstring>
+#include <thread>
+#include <atomic>
+
+// Feed pipeline tests: capture, replay, network -> book builder handoff
+void test_capture_replay() {
+    const std::string path = "feed_tests_capture.feed";
+    std::remove(path.c_str());
+
+    const std::vector<std::string> payloads = {
+        R"({"action":"snapshot","data":[{"asks":[["100.0","1"],["100.5","2"]],"bids":[["99.5","1"]]}]})",
+        R"({"event":"subscribe","arg":{"channel":"books"}})",
+        R"({"action":"update","data":[{"asks":[["100.0","0"]],"bids":[["99.7","3"]]}]})"
+    };
+
+    {
+        FeedRecorder recorder;
+        CHECK(recorder.open(path), "capture file opens");
+        int64_t ts = 1000000000;
+        for (const auto& payload : payloads) {
+            recorder.append(payload.data(), payload.size(), ts);
+            ts += 1000000;   // 1 ms apart
+        }
+        CHECK(recorder.records() == payloads.size(), "all payloads recorded");
+    }
+
+    FeedReplay replay;
+    CHECK(replay.open(path), "capture file maps");
+
+    std::vector<std::string> seen;
+    std::vector<int64_t> stamps;
+    replay.replay([&](const FeedRecord& record) {
+        seen.emplace_back(record.data, record.size);
+        stamps.push_back(record.recv_ts_ns);
+    });
+    CHECK(seen == payloads, "payloads replay byte for byte");
+    CHECK(stamps.size() == 3 && stamps[2] - stamps[0] == 2000000, "receive timestamps preserved");
+
+    // Replaying into a book must match applying the payloads live
+    OrderBook live;
+    for (const auto& payload : payloads) {
+        apply_l2_payload(live, payload);
+    }
+    OrderBook replayed;
+    CHECK(replay.replay_into(replayed, FeedReplay::Pace::Recorded) == payloads.size(), "paced replay delivers everything");
+    CHECK(replayed.version() == live.version(), "same number of book updates");
+    CHECK(replayed.get_asks().size() == 1 && replayed.get_bids().size() == 2, "replayed book state");
+
+    replay.close();
+    std::remove(path.c_str());
+
+    FeedReplay missing;
+    CHECK(!missing.open(path), "missing capture is rejected");
+}
+
+void test_spsc_ring() {
+    SpscRing<uint64_t> ring(100);
+    CHECK(ring.capacity() == 128, "capacity rounds up to a power of two");
+    CHECK(ring.front() == nullptr, "new ring is empty");
+
+    const uint64_t count = 200000;
+    std::thread producer([&]() {
+        for (uint64_t i = 0; i < count; ++i) {
+            uint64_t* slot;
+            while ((slot = ring.claim()) == nullptr) {
+                std::this_thread::yield();
+            }
+            *slot = i;
+            ring.publish();
+        }
+    });
+
+    uint64_t expected = 0;
+    bool ordered = true;
+    while (expected < count) {
+        uint64_t* value = ring.front();
+        if (!value) {
+            std::this_thread::yield();
+            continue;
+        }
+        if (*value != expected) ordered = false;
+        ring.pop();
+        ++expected;
+    }
+    producer.join();
+
+    CHECK(ordered, "values arrive in order");
+    CHECK(ring.size() == 0, "ring drained");
+    CHECK(ring.high_water_mark() >= 1 && ring.high_water_mark() <= ring.capacity(), "high-water mark within capacity");
+}
+
+void test_book_builder() {
+    OrderBook book;
+    BookBuilder builder([&book](const FeedMessage& message) {
+        apply_l2_payload(book, message.payload);
+    }, 8);
+    builder.set_idle_handler([&book]() { book.serve_depth(); });
+    FeedRing& input = builder.add_input();
+    builder.start();
+
+    // Many more messages than ring slots: the producer must wait, never drop
+    for (int i = 0; i < 1000; ++i) {
+        const std::string payload = "{\"asks\":[[\"" + std::to_string(100 + i) + ".0\",\"1\"]],\"bids\":[[\"99.0\",\"1\"]]}";
+        BookBuilder::push(input, 0, payload.data(), payload.size(), i);
+    }
+    while (book.version() != 1000) {
+        std::this_thread::yield();
+    }
+    CHECK(book.get_asks().size() == 1 && book.get_asks()[0].price == 1099.0, "idle builder serves depth reads");
+    builder.stop();
+    book.flush_depth();
+
+    CHECK(book.version() == 1000, "every queued message applied");
+    auto asks = book.get_asks();
+    CHECK(asks.size() == 1 && std::abs(asks[0].price - 1099.0) < 1e-9, "messages applied in order");
+    FeedQueueStats stats = builder.stats();
+    CHECK(stats.depth == 0 && stats.high_water_mark <= 8, "queue stats");
+    CHECK(stats.full_events <= 1000 && stats.full_spins >= stats.full_events && stats.dropped == 0,
+          "one full event per push that waited");
+
+    // A stopped builder never drains: pushes past capacity drop instead of spinning
+    const std::string payload = "{\"asks\":[],\"bids\":[]}";
+    bool accepted = true;
+    for (int i = 0; i < 8; ++i) {
+        accepted = BookBuilder::push(input, 0, payload.data(), payload.size(), i) && accepted;
+    }
+    const bool overflow = BookBuilder::push(input, 0, payload.data(), payload.size(), 8);
+    stats = builder.stats();
+    CHECK(accepted && !overflow && stats.dropped == 1 && stats.depth == 8, "push after stop drops when full");
+
+    // A single stall of many retries is one event
+    SpscRing<int> ring(2);
+    *ring.claim() = 1;
+    ring.publish();
+    *ring.claim() = 2;
+    ring.publish();
+    for (int i = 0; i < 100; ++i) {
+        CHECK(ring.claim() == nullptr, "full ring refuses claims");
+    }
+    ring.pop();
+    CHECK(ring.claim() != nullptr && ring.full_events() == 1 && ring.full_claims() == 100, "stall counted once");
+    CHECK(ring.high_water_mark() == 2, "high-water mark is the true peak");
+}
+
+void test_logger() {
+    char line[512];
+    LogRecord record = {};
+    record.ts_ns = 0;
+    record.level = LogLevel::Warn;
+    record.format = "bytes {} ratio {} name {} sign {} tail";
+    record.arg_count = 4;
+    record.args[0].type = LogArg::Type::Uint;
+    record.args[0].u = 42;
+    record.args[1].type = LogArg::Type::Double;
+    record.args[1].d = 0.5;
+    record.args[2].type = LogArg::Type::Text;
+    std::strcpy(record.args[2].text, "BTC");
+    record.args[3].type = LogArg::Type::Int;
+    record.args[3].i = -7;
+    Logger::format_record(record, line, sizeof(line));
+    CHECK(std::string(line) == "00:00:00.000000 [WARN] bytes 42 ratio 0.5 name BTC sign -7 tail\n", "record formatting");
+
+    std::FILE* out = std::tmpfile();
+    Logger& logger = Logger::instance();
+    Logger::set_level(LogLevel::Info);
+    logger.start(out);
+    LOG_DEBUG("filtered {}", 1);
+    LOG_INFO("first {}", 1);
+    std::thread other([]() { LOG_ERROR("from thread {}", std::string(200, 'x')); });
+    other.join();
+    LOG_INFO("second {}", 2);
+    logger.stop();
+
+    std::rewind(out);
+    std::vector<std::string> lines;
+    while (std::fgets(line, sizeof(line), out)) {
+        lines.push_back(line);
+    }
+    std::fclose(out);
+
+    CHECK(lines.size() == 3, "disabled level is not written");
+    bool first = false, second = false, threaded = false;
+    for (const std::string& l : lines) {
+        first |= l.find("[INFO] first 1") != std::string::npos;
+        second |= l.find("[INFO] second 2") != std::string::npos;
+        threaded |= l.find("[ERROR] from thread " + std::string(LogArg::kTextBytes - 1, 'x') + "\n") != std::string::npos;
+    }
+    CHECK(first && second, "records from the calling thread written");
+    CHECK(threaded, "records from another thread written, long text truncated");
+    CHECK(logger.dropped() == 0, "no records dropped");
+}
+
+// Reconnect delays: exponential growth, jitter bounds, cap and reset
+void test_reconnect_backoff() {
+    BackoffConfig config;
+    config.initial_ms = 100;
+    config.max_ms = 3000;
+    config.multiplier = 2.0;
+    config.jitter = 0.0;
+    ReconnectBackoff exact(config, 1);
+    const int64_t expected[] = {100, 200, 400, 800, 1600, 3000, 3000};
+    bool doubling = true;
+    for (int64_t delay : expected) {
+        doubling = doubling && exact.next_delay_ms() == delay;
+    }
+    CHECK(doubling, "delays double up to the cap");
+    exact.reset();
+    CHECK(exact.next_delay_ms() == 100 && exact.attempts() == 1, "reset restarts from the initial delay");
+
+    config.jitter = 0.5;
+    ReconnectBackoff jittered(config, 7);
+    ReconnectBackoff other(config, 8);
+    bool bounded = true, spread = false;
+    for (int attempt = 0; attempt < 200; ++attempt) {
+        const double base = std::min(3000.0, 100.0 * std::pow(2.0, std::min(attempt, 40)));
+        const int64_t delay = jittered.next_delay_ms();
+        bounded = bounded && delay >= static_cast<int64_t>(base * 0.5) - 1 && delay <= static_cast<int64_t>(base);
+        spread = spread || delay != other.next_delay_ms();
+    }
+    CHECK(bounded, "jittered delay within [base/2, base], no overflow after many attempts");
+    CHECK(spread, "clients with different seeds spread out");
+}
+
+// Cheap snapshot/update classification used to gate deltas after a reconnect
+void test_classify_payload() {
+    const std::string flat = R"({"asks":[["100.0","1.0"]],"bids":[]})";
+    const std::string okx_snapshot = R"({"action":"snapshot","data":[{"asks":[],"bids":[]}]})";
+    const std::string okx_update = R"({"action" : "update","data":[{"asks":[["1","2"]],"bids":[]}]})";
+    const std::string ack = R"({"event":"subscribe","arg":{"channel":"books"}})";
+    CHECK(classify_l2_payload(flat.data(), flat.size()) == L2PayloadKind::Snapshot, "flat book is a snapshot");
+    CHECK(classify_l2_payload(okx_snapshot.data(), okx_snapshot.size()) == L2PayloadKind::Snapshot, "OKX snapshot");
+    CHECK(classify_l2_payload(okx_update.data(), okx_update.size()) == L2PayloadKind::Update, "OKX update");
+    CHECK(classify_l2_payload(ack.data(), ack.size()) == L2PayloadKind::Other, "ack carries no book");
+}
+
+// Synthetic feed: reproducible payloads the fast parser accepts, and a
+// consumer book that ends up where the generator's own book is
+void test_synthetic_feed() {
+    SyntheticFeedConfig config;
+    config.depth = 20;
+    config.levels_per_update = 3;
+    config.move_probability = 0.5;
+    config.snapshot_every = 100;
+    config.seed = 42;
+
+    for (SyntheticFeedFormat format : {SyntheticFeedFormat::Flat, SyntheticFeedFormat::Okx}) {
+        config.format = format;
+        SyntheticFeed feed(config, 2);
+        SyntheticFeed twin(config, 2);
+        SyntheticFeed other(config, 3);
+        CHECK(feed.symbol() == "SYN-2", "symbol name");
+
+        OrderBook book(config.tick_size);
+        L2Message message;
+        bool identical = true, distinct = false, parsed = true, kinds = true;
+        size_t snapshots = 0;
+        for (int i = 0; i < 1000; ++i) {
+            const std::string payload = feed.next(1700000000000 + i);
+            identical = identical && payload == twin.next(1700000000000 + i);
+            distinct = distinct || payload != other.next(1700000000000 + i);
+            parsed = parsed && parse_l2_message(payload.data(), payload.size(), message) == L2ParseResult::Ok;
+            const bool snapshot = message.action == L2Message::Action::Snapshot;
+            snapshots += snapshot ? 1 : 0;
+            kinds = kinds && classify_l2_payload(payload.data(), payload.size())
+                                 == (snapshot ? L2PayloadKind::Snapshot : L2PayloadKind::Update);
+            book.apply(message);
+        }
+        CHECK(identical, "same seed and symbol give byte-identical streams");
+        CHECK(distinct, "symbols get different streams");
+        CHECK(parsed, "every payload takes the fast parse path");
+        CHECK(kinds, "classification agrees with the parser");
+        CHECK(snapshots == 10, "snapshot every 100 deltas");
+        CHECK(feed.sequence() == 1000, "sequence counts payloads");
+
+        OrderLevel bid, ask;
+        CHECK(book.read_top(bid, ask) && bid.price == feed.best_bid() && ask.price == feed.best_ask(),
+              "consumer touch matches the generator");
+        CHECK(book.get_asks().size() == config.depth && book.get_bids().size() == config.depth,
+              "moves keep the book at full depth");
+        CHECK(ask.price > bid.price, "book not crossed");
+    }
+
+    config.format = SyntheticFeedFormat::Flat;
+    config.min_message_bytes = 4096;
+    SyntheticFeed padded(config, 0);
+    bool sized = true;
+    L2Message message;
+    for (int i = 0; i < 50; ++i) {
+        const std::string& payload = padded.next();
+        sized = sized && payload.size() >= 4096 && payload.size() <= 4096 + 9
+                && parse_l2_message(payload.data(), payload.size(), message) == L2ParseResult::Ok;
+    }
+    CHECK(sized, "padding reaches the minimum size and still parses");
+
+    // Prices print exactly for awkward tick sizes
+    config.min_message_bytes = 0;
+    config.tick_size = 0.0001;
+    config.start_price = 0.5;
+    SyntheticFeed fine(config, 0);
+    const std::string& first = fine.next();
+    CHECK(parse_l2_message(first.data(), first.size(), message) == L2ParseResult::Ok
+          && message.bids[0].price == fine.best_bid() && message.asks[0].price == fine.best_ask(),
+          "sub-cent ticks round-trip");
+}
+
+// Bursty pacing keeps the average rate
+void test_feed_pacer() {
+    FeedPacer pacer(10000.0, 10);   // bursts of 10 every millisecond
+    pacer.start(0);
+    CHECK(pacer.due(0) == 10, "first burst due at start");
+    CHECK(pacer.due(999999) == 10 && pacer.due(1000000) == 20, "next burst a millisecond later");
+    CHECK(pacer.due(1000000000) == 10010, "average rate held over a second");
+    CHECK(pacer.next_due_ns(10) == 1000000 && pacer.next_due_ns(15) == 1000000, "partial burst due with its burst");
+    CHECK(pacer.burst_interval_ns() == 1000000, "burst interval");
+    FeedPacer unpaced;
+    CHECK(unpaced.unpaced() && unpaced.due(0) == UINT64_MAX, "rate 0 is unpaced");
+}
+
+void test_feed_compression() {
+    SyntheticFeedConfig config;
+    config.depth = 400;
+    config.snapshot_every = 50;
+    SyntheticFeed feed(config, 0);
+    std::vector<std::string> messages;
+    for (int i = 0; i < 200; ++i) {
+        messages.push_back(feed.next(1700000000000 + i));
+    }
+
+    // One stream per message, as venues with raw deflate framing send it
+    FeedDeflater deflater;
+    FeedInflater inflater(false, 4096);
+    bool round_trip = true;
+    size_t compressed = 0, plain = 0;
+    for (const std::string& message : messages) {
+        round_trip = round_trip && deflater.deflate(message.data(), message.size());
+        compressed += deflater.size();
+        plain += message.size();
+        round_trip = round_trip && inflater.inflate(deflater.data(), deflater.size())
+                     && std::string(inflater.data(), inflater.size()) == message;
+    }
+    CHECK(round_trip, "per-message raw deflate round trip");
+    CHECK(compressed * 2 < plain, "book JSON compresses at least 2x");
+    CHECK(inflater.grows() > 0 && inflater.capacity() >= messages[0].size(), "buffer grows past a small initial size");
+
+    // Once sized, the buffer is reused
+    const uint64_t grows = inflater.grows();
+    for (const std::string& message : messages) {
+        deflater.deflate(message.data(), message.size());
+        inflater.inflate(deflater.data(), deflater.size());
+    }
+    CHECK(inflater.grows() == grows, "no growth once sized");
+
+    // One stream across messages, ending at sync flushes (permessage-deflate framing)
+    FeedDeflater stream_deflater(-1, true);
+    FeedInflater stream_inflater(true);
+    bool takeover_round_trip = true;
+    size_t takeover_compressed = 0;
+    for (const std::string& message : messages) {
+        takeover_round_trip = takeover_round_trip && stream_deflater.deflate(message.data(), message.size());
+        takeover_compressed += stream_deflater.size();
+        takeover_round_trip = takeover_round_trip
+                              && stream_inflater.inflate(stream_deflater.data(), stream_deflater.size())
+                              && std::string(stream_inflater.data(), stream_inflater.size()) == message;
+    }
+    CHECK(takeover_round_trip, "context takeover round trip");
+    CHECK(takeover_compressed < compressed, "context takeover compresses better than independent messages");
+
+    // A corrupt message fails alone; the next one inflates
+    const std::string garbage = "\xff\xff\xff\xff not deflate";
+    CHECK(!inflater.inflate(garbage.data(), garbage.size()) && inflater.size() == 0, "corrupt message rejected");
+    deflater.deflate(messages[1].data(), messages[1].size());
+    CHECK(inflater.inflate(deflater.data(), deflater.size())
+          && std::string(inflater.data(), inflater.size()) == messages[1], "recovers after a corrupt message");
+
+    // A frame cut short is a failure (and a resync), not a partial payload
+    deflater.deflate(messages[2].data(), messages[2].size());
+    const std::string whole(deflater.data(), deflater.size());
+    CHECK(!inflater.inflate(whole.data(), whole.size() / 2) && inflater.size() == 0, "truncated frame rejected");
+    CHECK(!inflater.inflate(whole.data(), whole.size() - 1), "frame missing its last byte rejected");
+    CHECK(inflater.inflate(whole.data(), whole.size())
+          && std::string(inflater.data(), inflater.size()) == messages[2], "recovers after a truncated frame");
+
+    FeedCompression compression = FeedCompression::None;
+    CHECK(parse_feed_compression("raw", compression) && compression == FeedCompression::RawDeflate, "parse raw");
+    CHECK(parse_feed_compression("permessage-deflate", compression)
+          && compression == FeedCompression::PerMessageDeflate, "parse permessage-deflate");
+    CHECK(!parse_feed_compression("gzip", compression), "unknown compression rejected");
+}
+
+void test_clock_offset() {
+    const int64_t s = 1000000000;
+    const int64_t ms = 1000000;
+    const int64_t t0 = 1700000000LL * s;
+
+    // 10 s window in 2 s intervals
+    ClockOffsetEstimator estimator(10 * s, 5);
+    CHECK(!estimator.valid(), "no estimate before a sample");
+    CHECK(estimator.add(7 * ms, t0) == 7 * ms && estimator.valid(), "first sample is the estimate");
+    CHECK(estimator.add(5 * ms, t0 + s) == 5 * ms, "lower sample lowers the estimate");
+    CHECK(estimator.add(50 * ms, t0 + 3 * s) == 5 * ms, "a slow message does not move the floor");
+
+    // The exchange clock drifts 3 ms later: the old floor ages out within the window
+    int64_t estimate = 0;
+    for (int64_t t = 4; t <= 14; ++t) {
+        estimate = estimator.add(8 * ms, t0 + t * s);
+    }
+    CHECK(estimate == 8 * ms && estimator.offset_ns() == 8 * ms, "floor follows a clock change after one window");
+
+    // Receive time stepping backwards stays in the current interval
+    CHECK(estimator.add(9 * ms, t0 + 2 * s) == 8 * ms, "backward wall clock step tolerated");
+
+    FeedLatencyTracker tracker;
+    for (int i = 0; i < 100; ++i) {
+        tracker.record(t0 + i * ms, t0 + i * ms + 2 * ms, 1000, 1000 + 20000);
+    }
+    FeedLatencySummary summary = tracker.summary();
+    CHECK(summary.exchange_to_receive.count == 100 && summary.exchange_to_receive.max_ns == 0,
+          "steady delay is all clock offset");
+    CHECK(summary.clock_offset_ns == 2 * ms && summary.recent_exchange_ns == 0, "offset estimated");
+    CHECK(summary.receive_to_apply.count == 100 && summary.receive_to_apply.p50_ns >= 19000
+          && summary.receive_to_apply.p50_ns <= 21000, "receive to applied");
+
+    // A degrading path shows within a few dozen messages
+    for (int i = 100; i < 132; ++i) {
+        tracker.record(t0 + i * ms, t0 + i * ms + 12 * ms, 1000, 2000);
+    }
+    summary = tracker.summary();
+    CHECK(summary.recent_exchange_ns > 8 * ms && summary.clock_offset_ns == 2 * ms, "recent delay rises, offset holds");
+    tracker.record(0, t0, 1000, 2000);
+    CHECK(tracker.summary().without_timestamp == 1, "payload without exchange time counted");
+}
+
+int main() {
+    std::cout << "Starting feed tests..." << std::endl;
+
+    test_capture_replay();
+    test_spsc_ring();
+    test_book_builder();
+    test_logger();
+    test_reconnect_backoff();
+    test_classify_payload();
+    test_synthetic_feed();
+    test_feed_pacer();
+    test_feed_compression();
+    test_clock_offset();
+
+    if (failures > 0) {
+        std::cerr << failures << " feed test(s) failed." << std::endl;
+        return 1;
+    }
+
+    std::cout << "Feed tests completed." << std::endl;
+    return 0;
+}
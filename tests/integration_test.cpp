@@ -1,43 +1,135 @@
 #include <iostream>
 #include <thread>
 #include <chrono>
-#include "websocket_client.h"
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "book_registry.h"
+#include "connection_manager.h"
+#include "feed_server.h"
+#include "latency_histogram.h"
+#include "logger.h"
 #include "orderbook.h"
 #include "models.h"
-
-// Simple integration test for real-time data flow with end-to-end latency benchmarking
-int main() {
+#include "synthetic_feed.h"
+
+// End-to-end integration test: local synthetic exchange -> WebSocket client ->
+// parser -> sharded books -> models, with throughput and per-stage latency.
+//
+// integration_test [--symbols n] [--rate msgs/s per symbol] [--messages n per symbol] [--burst n]
+// The defaults finish in about a second; raise --rate and --messages for load runs.
+int main(int argc, char** argv) {
     std::cout << "Starting integration test for trade simulator..." << std::endl;
 
-    OrderBook orderbook;
-    Models models;
+    FeedServerConfig server_config;
+    server_config.symbols = 2;
+    server_config.rate = 20000.0;
+    server_config.max_messages = 20000;
+    server_config.feed.depth = 50;
+    server_config.feed.snapshot_every = 5000;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const std::string arg = argv[i];
+        if (arg == "--symbols") server_config.symbols = std::strtoull(argv[i + 1], nullptr, 10);
+        else if (arg == "--rate") server_config.rate = std::atof(argv[i + 1]);
+        else if (arg == "--messages") server_config.max_messages = std::strtoull(argv[i + 1], nullptr, 10);
+        else if (arg == "--burst") server_config.burst = std::strtoull(argv[i + 1], nullptr, 10);
+    }
+    if (server_config.symbols == 0 || server_config.max_messages == 0) {
+        std::cerr << "Need at least one symbol and one message." << std::endl;
+        return 1;
+    }
 
-    // WebSocket endpoint for OKX BTC-USDT-SWAP
-    std::string ws_uri = "wss://ws.gomarket-cpp.goquant.io/ws/l2-orderbook/okx/BTC-USDT-SWAP";
+    Logger::instance().start();
 
-    WebSocketClient ws_client(ws_uri, orderbook);
+    SyntheticFeedServer server(server_config);
+    const uint16_t port = server.listen(0);
+    if (port == 0) {
+        std::cerr << "Local feed server failed to listen." << std::endl;
+        Logger::instance().stop();
+        return 1;
+    }
+    server.start();
+
+    BookRegistry registry(server_config.symbols < 4 ? server_config.symbols : 4);
+    ConnectionManagerConfig feed_config;
+    feed_config.io_threads = server_config.symbols < 2 ? 1 : 2;
+    // The server closes each stream after max_messages; do not reconnect during the run
+    feed_config.backoff.initial_ms = 60000;
+    ConnectionManager feeds(registry, feed_config);
+    const std::string base = "ws://127.0.0.1:" + std::to_string(port) + "/ws/l2-orderbook/okx/";
+    std::vector<SymbolId> ids;
+    for (size_t i = 0; i < server_config.symbols; ++i) {
+        const std::string symbol = synthetic_symbol_name(i);
+        ids.push_back(registry.add_symbol(symbol, server_config.feed.tick_size));
+        feeds.add_subscription({base + symbol, ids.back(), ""});
+    }
 
-    std::cout << "Connecting to WebSocket: " << ws_uri << std::endl;
+    std::cout << "Streaming " << server_config.symbols << " symbol(s) x " << server_config.max_messages
+              << " messages at " << server_config.rate << " msgs/s each from " << base << std::endl;
+
+    registry.start();
+    const auto stream_start = std::chrono::steady_clock::now();
+    feeds.start();
+
+    // Wait for every message instead of a fixed sleep
+    const double expected_s = server_config.rate > 0.0 ? server_config.max_messages / server_config.rate : 0.0;
+    const auto deadline = stream_start + std::chrono::milliseconds(static_cast<int64_t>(expected_s * 1000.0) + 15000);
+    bool complete = false;
+    while (!complete && std::chrono::steady_clock::now() < deadline) {
+        complete = true;
+        for (size_t i = 0; i < feeds.size(); ++i) {
+            complete = complete && feeds.stats(i).messages >= server_config.max_messages;
+        }
+        if (!complete) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    const double stream_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - stream_start).count();
+    feeds.stop();
+    registry.stop();   // drains the shard rings
+    server.stop();
+
+    if (!complete) {
+        std::cerr << "Timed out: " << server.stats().messages << " of "
+                  << server_config.symbols * server_config.max_messages << " messages sent." << std::endl;
+        Logger::instance().stop();
+        return 1;
+    }
 
-    // Run WebSocket client in a separate thread
-    std::thread ws_thread([&ws_client]() {
-        ws_client.run();
-    });
+    // Every book must end exactly where the generator's own copy did
+    bool books_match = true;
+    for (size_t i = 0; i < ids.size(); ++i) {
+        SyntheticFeed reference(server_config.feed, i);
+        for (uint64_t m = 0; m < server_config.max_messages; ++m) {
+            reference.next();
+        }
+        OrderLevel bid, ask;
+        const bool has_top = registry.book(ids[i]).read_top(bid, ask);
+        if (!has_top || bid.price != reference.best_bid() || ask.price != reference.best_ask()) {
+            std::cerr << reference.symbol() << " book diverged: " << bid.price << "/" << ask.price
+                      << " expected " << reference.best_bid() << "/" << reference.best_ask() << std::endl;
+            books_match = false;
+        }
+    }
+    if (!books_match) {
+        Logger::instance().stop();
+        return 1;
+    }
 
-    // Allow some time for data to be received and processed
-    std::this_thread::sleep_for(std::chrono::seconds(10));
+    const FeedServerStats sent = server.stats();
+    std::cout << "Received " << sent.messages << " messages (" << sent.bytes / 1e6 << " MB) in " << stream_s
+              << " s: " << sent.messages / stream_s << " msgs/s, throttled " << sent.throttled << std::endl;
+    for (LatencyStage stage : {LatencyStage::Receive, LatencyStage::Queue, LatencyStage::Parse, LatencyStage::Apply}) {
+        const LatencySummary summary = LatencyMonitor::instance().summary(stage);
+        std::cout << "  " << latency_stage_name(stage) << ": p50 " << summary.p50_ns / 1000.0
+                  << " us, p99 " << summary.p99_ns / 1000.0 << " us, max " << summary.max_ns / 1000.0
+                  << " us (" << summary.count << " samples)" << std::endl;
+    }
 
-    // Fetch current orderbook snapshot
+    OrderBook& orderbook = registry.book(ids[0]);
     auto asks = orderbook.get_asks();
     auto bids = orderbook.get_bids();
 
-    if (asks.empty() || bids.empty()) {
-        std::cerr << "Orderbook data not received or empty." << std::endl;
-        ws_client.stop();
-        ws_thread.join();
-        return 1;
-    }
-
     std::cout << "Orderbook data received:" << std::endl;
     std::cout << "Top ask: Price = " << asks[0].price << ", Quantity = " << asks[0].quantity << std::endl;
     std::cout << "Top bid: Price = " << bids[0].price << ", Quantity = " << bids[0].quantity << std::endl;
@@ -45,6 +137,8 @@ int main() {
     // Measure end-to-end latency: from message receipt to UI update simulation
     auto start = std::chrono::high_resolution_clock::now();
 
+    Models models;
+
     // Simulate processing and UI update
     double quantity = 100.0;
     double volatility = 0.05;
@@ -71,10 +165,7 @@ int main() {
 
     std::cout << "End-to-end simulation loop latency: " << end_to_end_latency.count() << " ms" << std::endl;
 
-    // Stop WebSocket client and join thread
-    ws_client.stop();
-    ws_thread.join();
-
+    Logger::instance().stop();
     std::cout << "Integration test completed successfully." << std::endl;
     return 0;
 }
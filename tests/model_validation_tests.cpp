@@ -1,7 +1,785 @@
 #include <iostream>
 #include <vector>
 #include <cmath>
+#include <random>
+#include <thread>
+#include <atomic>
+#include <chrono>
 #include "models.h"
+#include "model_coefficients.h"
+#include "coefficient_store.h"
+#include "almgren_chriss.h"
+#include <stdexcept>
+#include "execution_cost.h"
+#include "recursive_least_squares.h"
+#include "slippage_calibrator.h"
+#include "book_registry.h"
+#include "volatility_estimator.h"
+#include "quantile_sketch.h"
+#include "slippage_quantiles.h"
+#include "monte_carlo.h"
+#include "work_stealing_pool.h"
+#include "scenario_sweep.h"
+#include "fee_schedule.h"
+#include "model_evaluator.h"
+#include <algorithm>
+#include <cstdio>
+#include "latency_histogram.h"
+#include "test_util.h"
+#include <nlohmann/json.hpp>
+
+// Depth-walk engine against a hand-built book
+void validate_execution_cost() {
+    BookSnapshot book;
+    book.version = 1;
+    book.ask_count = 3;
+    book.asks[0] = {101.0, 1.0};   // 101 notional
+    book.asks[1] = {102.0, 2.0};   // 204 notional
+    book.asks[2] = {104.0, 1.0};   // 104 notional
+    book.bid_count = 2;
+    book.bids[0] = {99.0, 1.0};
+    book.bids[1] = {98.0, 5.0};
+
+    ExecutionCostEngine engine;
+    CHECK(engine.update(book), "first snapshot loads");
+    CHECK(!engine.update(book), "same version is skipped");
+    CHECK(std::abs(engine.mid() - 100.0) < 1e-12, "mid price");
+
+    // 50 USD fits in the first level
+    ExecutionEstimate small = engine.estimate(OrderSide::Buy, 50.0);
+    CHECK(std::abs(small.vwap - 101.0) < 1e-9 && small.levels_consumed == 1, "single-level fill");
+    CHECK(std::abs(small.slippage - 0.01) < 1e-9, "slippage versus mid");
+
+    // 203 USD: all of level 0 (101) plus 102 USD (1 unit) of level 1
+    ExecutionEstimate medium = engine.estimate(OrderSide::Buy, 203.0);
+    CHECK(std::abs(medium.vwap - 101.5) < 1e-9 && medium.levels_consumed == 2, "two-level interpolated fill");
+
+    // More than the visible depth
+    ExecutionEstimate large = engine.estimate(OrderSide::Buy, 1000.0);
+    CHECK(!large.fully_filled && std::abs(large.filled_notional - 409.0) < 1e-9, "insufficient depth reported");
+
+    ExecutionEstimate sell = engine.estimate(OrderSide::Sell, 99.0);
+    CHECK(std::abs(sell.vwap - 99.0) < 1e-9 && std::abs(sell.slippage - 0.01) < 1e-9, "sell walks the bids");
+
+    // Batch kernel matches single queries, sorted and unsorted
+    const double sizes[] = {10.0, 150.0, 203.0, 300.0, 1000.0};
+    const double shuffled[] = {300.0, 10.0, 1000.0, 203.0, 150.0};
+    double vwap[5], slippage[5];
+    engine.estimate_batch(OrderSide::Buy, sizes, 5, vwap, slippage);
+    for (int i = 0; i < 5; ++i) {
+        CHECK(std::abs(vwap[i] - engine.estimate(OrderSide::Buy, sizes[i]).vwap) < 1e-12, "sorted batch matches scalar");
+    }
+    engine.estimate_batch(OrderSide::Buy, shuffled, 5, vwap, slippage);
+    for (int i = 0; i < 5; ++i) {
+        CHECK(std::abs(vwap[i] - engine.estimate(OrderSide::Buy, shuffled[i]).vwap) < 1e-12, "unsorted batch matches scalar");
+    }
+
+    // Incremental rebuild after a deep level changes
+    book.version = 2;
+    book.asks[2] = {104.0, 3.0};
+    CHECK(engine.update(book), "new version reloads");
+    CHECK(std::abs(engine.depth_notional(OrderSide::Buy) - 617.0) < 1e-9, "prefix updated from changed level");
+}
+
+// Batch kernels against the per-order methods, on both the SIMD and scalar paths
+void validate_batch_models(Models& models) {
+    const size_t n = 1003;   // not a multiple of the vector width: exercises the tail
+    std::vector<double> quantity(n), volatility(n);
+    std::vector<int> tier(n);
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<double> qty(0.0, 100000.0);
+    std::uniform_real_distribution<double> vol(0.0, 2.0);
+    for (size_t i = 0; i < n; ++i) {
+        quantity[i] = qty(rng);
+        volatility[i] = vol(rng);
+        tier[i] = static_cast<int>(i % 5);   // includes out-of-range tiers 0 and 4
+    }
+
+    const bool simd = Models::simd_available();
+    std::cout << "Batch models: AVX2 " << (simd ? "available" : "not available") << std::endl;
+
+    for (bool use_simd : {true, false}) {
+        Models::set_simd_enabled(use_simd);
+        std::vector<double> impact(n), slippage(n), fees(n), net(n), maker_taker(n);
+        models.calculate_market_impact_batch(quantity.data(), volatility.data(), n, impact.data());
+        models.calculate_slippage_batch(quantity.data(), volatility.data(), n, slippage.data());
+        models.calculate_fees_batch(quantity.data(), tier.data(), n, fees.data());
+        models.calculate_net_cost_batch(quantity.data(), volatility.data(), tier.data(), n, net.data());
+        models.predict_maker_taker_proportion_batch(quantity.data(), volatility.data(), n, maker_taker.data());
+
+        size_t linear_mismatches = 0, logistic_mismatches = 0;
+        for (size_t i = 0; i < n; ++i) {
+            linear_mismatches += impact[i] != models.calculate_market_impact(quantity[i], volatility[i]);
+            linear_mismatches += slippage[i] != models.calculate_slippage(quantity[i], volatility[i]);
+            linear_mismatches += fees[i] != models.calculate_fees(quantity[i], tier[i]);
+            linear_mismatches += net[i] != models.calculate_net_cost(quantity[i], volatility[i], tier[i]);
+            const double expected = models.predict_maker_taker_proportion(quantity[i], volatility[i]);
+            logistic_mismatches += std::abs(maker_taker[i] - expected) > Models::kBatchTolerance * std::abs(expected);
+        }
+        const char* path = use_simd && simd ? "simd" : "scalar";
+        CHECK(linear_mismatches == 0, path << " batch linear models match per-order results exactly");
+        CHECK(logistic_mismatches == 0, path << " batch maker/taker within tolerance");
+    }
+    Models::set_simd_enabled(true);
+
+    // Logistic saturates instead of overflowing at the extremes
+    const double extreme_qty[] = {-1e7, -1e6, 0.0, 1e6};
+    const double extreme_vol[] = {0.0, 0.0, 0.0, 0.0};
+    double extreme[4];
+    models.predict_maker_taker_proportion_batch(extreme_qty, extreme_vol, 4, extreme);
+    CHECK(extreme[0] >= 0.0 && extreme[0] < 1e-300 && std::abs(extreme[3] - 1.0) < 1e-15, "maker/taker saturates");
+}
+
+// Versioned per-symbol coefficients: whole-block publication while readers run
+void validate_coefficient_store() {
+    CoefficientStore store(2);
+    CHECK(store.version(0) == 1 && store.version(1) == 1, "symbols start at the default model");
+    CHECK(store.read(1).slippage_quantity == ModelCoefficients::defaults().slippage_quantity, "defaults published");
+    CHECK(store.read(7).slippage_intercept == ModelCoefficients::defaults().slippage_intercept, "unknown symbol reads defaults");
+
+    ModelCoefficients calibrated = ModelCoefficients::defaults();
+    calibrated.slippage_intercept = 0.002;
+    CHECK(store.publish(1, calibrated) == 2, "publish bumps the version");
+    CHECK(store.read(1).slippage_intercept == 0.002 && store.read(1).version == 2, "new model visible");
+    CHECK(store.read(0).slippage_intercept == ModelCoefficients::defaults().slippage_intercept, "other symbols untouched");
+
+    Models models;
+    models.set_coefficient_store(&store);
+    models.select_symbol(1);
+    CHECK(std::abs(models.calculate_slippage_optimized(100.0, 0.05) - (0.002 + 0.00001 * 100.0 + 0.05 * 0.05)) < 1e-15,
+          "optimized slippage reads the selected symbol");
+    models.select_symbol(0);
+    CHECK(models.calculate_slippage_optimized(100.0, 0.05) == models.calculate_slippage(100.0, 0.05),
+          "default coefficients match the baseline model");
+
+    // Readers must never observe a block mixing two publications
+    ModelCoefficients uniform;
+    auto fill = [&uniform](double k) {
+        uniform.slippage_intercept = uniform.slippage_quantity = uniform.slippage_volatility = k;
+        uniform.impact_gamma = uniform.impact_eta = uniform.impact_horizon = k;
+        uniform.maker_taker_intercept = uniform.maker_taker_quantity = uniform.maker_taker_volatility = k;
+    };
+    fill(0.0);
+    store.publish(0, uniform);
+
+    std::atomic<bool> done(false);
+    std::atomic<int> torn(0);
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 3; ++r) {
+        readers.emplace_back([&]() {
+            ModelCoefficients c;
+            while (!done.load(std::memory_order_relaxed)) {
+                store.read(0, c);
+                const double k = c.slippage_intercept;
+                if (c.impact_gamma != k || c.maker_taker_volatility != k) {
+                    torn.fetch_add(1);
+                }
+            }
+        });
+    }
+    for (int i = 1; i <= 200000; ++i) {
+        fill(static_cast<double>(i));
+        store.publish(0, uniform);
+    }
+    done = true;
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    CHECK(torn.load() == 0, "no torn coefficient reads");
+    CHECK(store.version(0) == 200002 && store.read(0).slippage_intercept == 200000.0, "last publication wins");
+}
+
+// Almgren-Chriss trajectories against the closed forms
+void validate_almgren_chriss() {
+    AlmgrenChrissParams params;
+    params.quantity = 1000.0;
+    params.volatility = 0.3;
+    params.horizon = 2.0;
+    params.slices = 20;
+    params.gamma = 0.01;
+    params.eta = 0.05;
+    const double tau = params.horizon / params.slices;
+    const double eta_tilde = params.eta - 0.5 * params.gamma * tau;
+
+    // Risk neutral: straight-line schedule with E = gamma X^2 / 2 + eta~ X^2 / T
+    params.risk_aversion = 0.0;
+    AlmgrenChrissSchedule twap = solve_almgren_chriss(params);
+    bool linear = twap.holdings.size() == 21 && twap.holdings.front() == 1000.0 && twap.holdings.back() == 0.0;
+    for (double trade : twap.trades) {
+        linear = linear && std::abs(trade - 50.0) < 1e-9;
+    }
+    CHECK(linear, "zero risk aversion gives TWAP");
+    const double X = params.quantity;
+    CHECK(std::abs(twap.expected_cost - (0.5 * params.gamma * X * X + eta_tilde * X * X / params.horizon)) < 1e-6,
+          "TWAP expected cost");
+
+    // Risk averse: front-loaded and satisfies the discrete Euler-Lagrange equation
+    params.risk_aversion = 0.5;
+    AlmgrenChrissSchedule urgent = solve_almgren_chriss(params);
+    const double kappa_tilde_sq = params.risk_aversion * params.volatility * params.volatility / eta_tilde;
+    bool euler = true, decreasing = true;
+    for (size_t j = 1; j + 1 < urgent.holdings.size(); ++j) {
+        const double second_difference = (urgent.holdings[j - 1] - 2.0 * urgent.holdings[j] + urgent.holdings[j + 1]) / (tau * tau);
+        euler = euler && std::abs(second_difference - kappa_tilde_sq * urgent.holdings[j]) < 1e-6 * X;
+        decreasing = decreasing && urgent.holdings[j] < urgent.holdings[j - 1];
+    }
+    CHECK(euler && decreasing, "optimal trajectory satisfies x'' = kappa~^2 x");
+    CHECK(urgent.trades.front() > twap.trades.front() && urgent.trades.back() < twap.trades.back(), "risk aversion front-loads");
+    CHECK(urgent.expected_cost > twap.expected_cost && urgent.variance < twap.variance, "trades cost for variance");
+
+    // Efficient frontier: cost rises and variance falls with risk aversion
+    const double lambdas[] = {0.0, 0.01, 0.1, 1.0, 10.0};
+    std::vector<FrontierPoint> frontier = efficient_frontier(params, lambdas, 5);
+    bool monotone = frontier.size() == 5;
+    for (size_t i = 1; i < frontier.size(); ++i) {
+        monotone = monotone && frontier[i].expected_cost > frontier[i - 1].expected_cost
+                            && frontier[i].variance < frontier[i - 1].variance;
+    }
+    CHECK(monotone, "efficient frontier is monotone");
+
+    // Cache: order size is exact, other parameters binned to 0.1%
+    AlmgrenChrissCache cache;
+    AlmgrenChrissSchedule cached = cache.schedule(params);
+    CHECK(std::abs(cached.expected_cost - urgent.expected_cost) < 0.01 * urgent.expected_cost, "cached schedule close to solved");
+    CHECK(cached.holdings.front() == X && cached.holdings.back() == 0.0, "cached schedule scaled to the order");
+    params.quantity = 10.0;
+    params.volatility = 0.30001;
+    cache.expected_cost(params);
+    CHECK(cache.misses() == 1 && cache.hits() == 1 && cache.size() == 1, "same bin, any size, hits the cache");
+    const AlmgrenChrissSchedule repeated = cache.schedule(params);
+    CHECK(cache.misses() == 1 && cache.hits() == 2 && cache.trajectory_size() == 1,
+          "repeated schedule in the bin is not re-solved");
+    bool rescaled = repeated.holdings.size() == cached.holdings.size() && repeated.trades.size() == cached.trades.size();
+    for (size_t j = 0; rescaled && j < repeated.holdings.size(); ++j) {
+        rescaled = std::abs(repeated.holdings[j] * (X / 10.0) - cached.holdings[j]) <= 1e-12 * X;
+    }
+    CHECK(rescaled && repeated.holdings.front() == 10.0, "cached trajectory scaled to the new order");
+    AlmgrenChrissParams fine = params;
+    fine.slices = AlmgrenChrissCache::kMaxCachedSlices + 1;
+    cache.schedule(fine);
+    cache.schedule(fine);
+    CHECK(cache.misses() == 3 && cache.trajectory_size() == 1, "over-long trajectories are solved, not cached");
+
+    // More bins than slots: single entries are evicted, the table is never wiped
+    AlmgrenChrissCache small(8);
+    AlmgrenChrissParams swept = params;
+    for (int i = 0; i < 200; ++i) {
+        swept.volatility = 0.1 * (1.0 + 0.01 * i);
+        small.unit_cost(swept);
+    }
+    const uint64_t small_hits = small.hits();
+    small.unit_cost(swept);
+    CHECK(small.capacity() == 8 && small.size() == 8 && small.hits() == small_hits + 1,
+          "full cache evicts one entry per miss and keeps the newest");
+
+    // Concurrent readers and writers agree with a fresh solve
+    AlmgrenChrissCache shared(64, 16);
+    std::atomic<int> mismatches(0);
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; ++t) {
+        readers.emplace_back([&, t]() {
+            AlmgrenChrissParams p = params;
+            for (int i = 0; i < 2000; ++i) {
+                p.volatility = 0.2 * (1.0 + 0.01 * ((i * 7 + t) % 150));
+                const double cost = shared.unit_cost(p).expected_cost;
+                AlmgrenChrissCache reference(4, 4);
+                if (cost != reference.unit_cost(p).expected_cost
+                    || shared.schedule(p).holdings != reference.schedule(p).holdings) {
+                    ++mismatches;
+                }
+            }
+        });
+    }
+    for (std::thread& reader : readers) {
+        reader.join();
+    }
+    CHECK(mismatches.load() == 0 && shared.size() <= shared.capacity(), "lock-free cache reads are consistent");
+
+    bool threw = false;
+    params.gamma = 2.0 * params.eta / tau;   // eta~ < 0
+    try {
+        solve_almgren_chriss(params);
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    CHECK(threw, "invalid parameters rejected");
+
+    // The model now responds to volatility
+    Models models;
+    CHECK(models.calculate_market_impact(100.0, 0.5) > models.calculate_market_impact(100.0, 0.05),
+          "market impact increases with volatility");
+    CHECK(std::abs(models.optimal_schedule(100.0, 0.05).expected_cost / 100.0 - models.calculate_market_impact(100.0, 0.05)) < 1e-12,
+          "impact is expected cost per unit");
+}
+
+// RLS recovers known coefficients and follows a regime change
+void validate_recursive_least_squares() {
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> quantity(1e3, 1e5);
+    std::uniform_real_distribution<double> volatility(1e-4, 5e-3);
+    std::normal_distribution<double> noise(0.0, 1e-6);
+
+    RecursiveLeastSquares fit(3, 0.99, 1e4, {1.0, 1e4, 1e-3});
+    auto feed = [&](double b0, double b1, double b2, int count) {
+        for (int i = 0; i < count; ++i) {
+            const double x[3] = {1.0, quantity(rng), volatility(rng)};
+            fit.update(x, b0 + b1 * x[1] + b2 * x[2] + noise(rng));
+        }
+    };
+    double theta[3];
+
+    feed(2e-4, 3e-8, 0.5, 500);
+    fit.coefficients(theta);
+    CHECK(std::abs(theta[0] - 2e-4) < 2e-6 && std::abs(theta[1] - 3e-8) < 1e-10 && std::abs(theta[2] - 0.5) < 1e-3,
+          "RLS recovers regression coefficients");
+    CHECK(fit.observations() == 500, "observations counted");
+
+    // Regime switch: ~100-sample memory, so 1000 new samples replace the old fit
+    feed(5e-4, 8e-8, 0.2, 1000);
+    fit.coefficients(theta);
+    CHECK(std::abs(theta[0] - 5e-4) < 2e-6 && std::abs(theta[1] - 8e-8) < 1e-10 && std::abs(theta[2] - 0.2) < 1e-3,
+          "RLS with forgetting tracks a regime change");
+    const double x[3] = {1.0, 2e4, 1e-3};
+    CHECK(std::abs(fit.predict(x) - (5e-4 + 8e-8 * 2e4 + 0.2 * 1e-3)) < 1e-5, "prediction uses the current fit");
+
+    fit.reset();
+    fit.coefficients(theta);
+    CHECK(fit.observations() == 0 && theta[0] == 0.0 && theta[1] == 0.0, "reset clears the fit");
+}
+
+// Live volatility estimates recover the sigma of a simulated random walk
+void validate_volatility_estimator() {
+    const double sigma = 1e-3;   // per sqrt(second)
+    const int64_t step_ns = 10000000;   // 10 ms between ticks
+    std::mt19937 rng(11);
+    std::normal_distribution<double> shock(0.0, sigma * std::sqrt(step_ns * 1e-9));
+
+    VolatilityConfig config;
+    config.window = 4096;
+    VolatilityEstimator estimator(config);
+    CHECK(estimator.samples() == 0 && estimator.volatility() == 0.0, "no estimate before the first return");
+    CHECK(estimator.model_volatility() == model_coefficients::kDefaultVolatility
+          && model_coefficients::kDefaultVolatility < 1e-3, "fallback on the estimator's per-sqrt-second scale");
+
+    double log_price = std::log(100.0);
+    int64_t ts = 0;
+    for (int i = 0; i < 20000; ++i) {   // 200 seconds
+        log_price += shock(rng);
+        estimator.on_price(ts, std::exp(log_price));
+        ts += step_ns;
+    }
+    VolatilityEstimate estimate = estimator.estimate();
+    CHECK(estimate.samples == 19999, "one return per tick after the first");
+    CHECK(std::abs(estimate.realized - sigma) < 0.05 * sigma, "windowed realized volatility");
+    CHECK(std::abs(estimate.ewma - sigma) < 0.25 * sigma, "EWMA volatility");
+    CHECK(std::abs(estimate.parkinson - sigma) < 0.25 * sigma, "Parkinson range volatility");
+
+    // Regime change: the EWMA (30 s half-life) catches up after ten half-lives
+    std::normal_distribution<double> calm(0.0, 0.2 * sigma * std::sqrt(step_ns * 1e-9));
+    for (int i = 0; i < 30000; ++i) {   // 300 seconds
+        log_price += calm(rng);
+        estimator.on_price(ts, std::exp(log_price));
+        ts += step_ns;
+    }
+    estimate = estimator.estimate();
+    CHECK(std::abs(estimate.ewma - 0.2 * sigma) < 0.3 * 0.2 * sigma, "EWMA follows a volatility regime change");
+    CHECK(estimate.realized < 0.3 * sigma, "window forgets the old regime");
+
+    // Repeated timestamps extend the next return instead of dividing by zero
+    estimator.on_price(ts, 101.0);
+    estimator.on_price(ts, 102.0);
+    CHECK(std::isfinite(estimator.volatility()), "same-timestamp ticks handled");
+
+    const OrderLevel bid{100.0, 3.0};
+    const OrderLevel ask{101.0, 1.0};
+    CHECK(std::abs(VolatilityEstimator::microprice(bid, ask) - 100.75) < 1e-12, "microprice leans to the thin side");
+
+    // Models use the live estimate by default once a source is set
+    Models models;
+    CHECK(models.current_volatility() == model_coefficients::kDefaultVolatility, "default volatility without a source");
+}
+
+// t-digest accuracy, bounded size, merge and serialization
+void validate_quantile_sketch() {
+    std::mt19937 rng(5);
+    std::lognormal_distribution<double> slippage(std::log(2e-4), 0.8);
+    std::vector<double> values(200000);
+    for (double& v : values) {
+        v = slippage(rng);
+    }
+
+    QuantileSketch sketch(100.0);
+    QuantileSketch first_half(100.0), second_half(100.0);
+    for (size_t i = 0; i < values.size(); ++i) {
+        sketch.add(values[i]);
+        (i < values.size() / 2 ? first_half : second_half).add(values[i]);
+    }
+    std::vector<double> sorted = values;
+    std::sort(sorted.begin(), sorted.end());
+    // Accuracy is in rank: the estimate must fall between the exact quantiles a small rank distance away
+    auto within_rank = [&](double estimate, double q, double rank_error) {
+        const size_t lo = static_cast<size_t>(std::max(0.0, q - rank_error) * (sorted.size() - 1));
+        const size_t hi = static_cast<size_t>(std::min(1.0, q + rank_error) * (sorted.size() - 1));
+        return estimate >= sorted[lo] && estimate <= sorted[hi];
+    };
+    CHECK(within_rank(sketch.quantile(0.50), 0.50, 0.005), "t-digest p50");
+    CHECK(within_rank(sketch.quantile(0.90), 0.90, 0.002), "t-digest p90");
+    CHECK(within_rank(sketch.quantile(0.99), 0.99, 0.001), "t-digest p99");
+    CHECK(sketch.quantile(0.0) == sorted.front() && sketch.quantile(1.0) == sorted.back(), "t-digest extremes exact");
+    CHECK(sketch.count() == values.size(), "t-digest counts every value");
+    CHECK(sketch.centroid_count() <= 100, "t-digest size bounded by compression");
+
+    first_half.merge(second_half);
+    CHECK(within_rank(first_half.quantile(0.99), 0.99, 0.001) && first_half.count() == values.size(),
+          "merged halves match the whole stream");
+
+    std::string bytes;
+    sketch.serialize(bytes);
+    QuantileSketch restored;
+    const char* p = bytes.data();
+    CHECK(restored.deserialize(p, bytes.data() + bytes.size()) && p == bytes.data() + bytes.size(), "sketch round trip");
+    CHECK(restored.quantile(0.9) == sketch.quantile(0.9) && restored.count() == sketch.count(), "restored sketch identical");
+    p = bytes.data();
+    CHECK(!restored.deserialize(p, bytes.data() + bytes.size() / 2) && restored.empty(), "truncated sketch rejected");
+    CHECK(std::isnan(QuantileSketch().quantile(0.5)), "empty sketch has no quantiles");
+}
+
+// Bucketed quantile model: routing, lock-free published quantiles, snapshot/restore
+void validate_slippage_quantiles() {
+    SlippageQuantileModel model(2);
+    CHECK(model.size_buckets() == 5 && model.volatility_buckets() == 5, "default bucket grid");
+    CHECK(model.bucket(1000.0, 1e-5) == 0 && model.bucket(1e6, 1e-2) == 24, "bucket routing");
+    CHECK(model.quantiles(0, 1000.0, 1e-5).count == 0, "no estimate before data");
+
+    for (int i = 1; i <= 1000; ++i) {
+        model.add(0, 1000.0, 1e-5, i * 1e-6);    // small, calm: 1e-6 .. 1e-3
+        model.add(0, 50000.0, 1e-5, i * 1e-5);   // larger orders slip more
+    }
+    CHECK(model.quantiles(0, 1000.0, 1e-5).count == 0, "queries see nothing until publish");
+    CHECK(model.publish() == 2, "only changed buckets republished");
+    const SlippageQuantiles small = model.quantiles(0, 1200.0, 2e-5);
+    const SlippageQuantiles large = model.quantiles(0, 60000.0, 2e-5);
+    CHECK(small.count == 1000 && std::abs(small.p50 - 5e-4) < 1e-5 && std::abs(small.p99 - 9.9e-4) < 1e-5,
+          "bucket quantiles");
+    CHECK(small.p50 <= small.p90 && small.p90 <= small.p99, "quantiles ordered");
+    CHECK(large.p90 > small.p90, "conditioned on order size");
+    CHECK(model.quantiles(1, 1000.0, 1e-5).count == 0 && model.quantiles(7, 1000.0, 1e-5).count == 0,
+          "other and unknown symbols empty");
+    CHECK(std::abs(model.quantile(0, 1000.0, 1e-5, 0.75) - 7.5e-4) < 1e-5, "arbitrary quantile from the sketch");
+
+    const std::string path = "model_validation_quantiles.bin";
+    CHECK(model.save(path), "snapshot saved");
+    SlippageQuantileModel restored(2);
+    CHECK(restored.load(path), "snapshot loaded");
+    const SlippageQuantiles again = restored.quantiles(0, 1000.0, 1e-5);
+    CHECK(again.count == small.count && again.p99 == small.p99, "restored model answers identically");
+    SlippageQuantileModel other_grid(3);
+    CHECK(!other_grid.load(path), "snapshot with a different grid rejected");
+    CHECK(restored.merge(model) && restored.quantiles(0, 1000.0, 1e-5).count == 2000, "models merge bucket-wise");
+    std::remove(path.c_str());
+}
+
+// Monte Carlo shortfall: deterministic limit, reproducibility across thread counts, tail ordering
+void validate_monte_carlo() {
+    BookSnapshot book;
+    book.version = 1;
+    book.ask_count = book.bid_count = 200;
+    for (size_t i = 0; i < 200; ++i) {
+        book.asks[i] = {100.05 + 0.1 * i, 10.0};
+        book.bids[i] = {99.95 - 0.1 * i, 10.0};
+    }
+    ExecutionPlan plan;
+    plan.side = OrderSide::Buy;
+    plan.slice_notional = {20000.0, 15000.0, 10000.0, 5000.0};
+    plan.slice_seconds = 1.0;
+
+    // No randomness and no permanent impact: every path is the sum of the depth walks
+    WorkStealingPool pool(4);
+    MonteCarloCostEngine engine(pool);
+    MonteCarloParams params;
+    params.paths = 1000;
+    params.volatility = 0.0;
+    params.liquidity_volatility = 0.0;
+    ExecutionCostEngine walk;
+    walk.update(book);
+    double expected = 0.0;
+    for (double notional : plan.slice_notional) {
+        expected += notional * walk.estimate(OrderSide::Buy, notional).slippage;
+    }
+    CostDistribution flat = engine.simulate(book, plan, params);
+    CHECK(flat.paths == 1000 && std::abs(flat.mean - expected) < 1e-9 && flat.stddev < 1e-9, "deterministic limit");
+    CHECK(std::abs(flat.var - expected) < 1e-9 && std::abs(flat.cvar - expected) < 1e-9, "degenerate tail");
+
+    params.permanent_share = 0.5;
+    const double with_permanent = engine.simulate(book, plan, params).mean;
+    CHECK(with_permanent > flat.mean, "permanent impact raises later slices' cost");
+
+    // Random paths: reproducible from the seed, whatever the thread count
+    params.volatility = 1e-3;
+    params.liquidity_volatility = 0.3;
+    params.paths = 20000;
+    params.seed = 99;
+    const CostDistribution four = engine.simulate(book, plan, params);
+    const std::vector<double> four_paths = engine.path_costs();
+    WorkStealingPool single(1);
+    MonteCarloCostEngine single_engine(single);
+    const CostDistribution one = single_engine.simulate(book, plan, params);
+    CHECK(one.mean == four.mean && one.var == four.var && one.cvar == four.cvar
+          && single_engine.path_costs() == four_paths, "same seed, same paths on 1 and 4 threads");
+    params.seed = 100;
+    CHECK(engine.simulate(book, plan, params).mean != four.mean, "different seed, different paths");
+
+    CHECK(four.stddev > 0.0 && four.min <= four.mean && four.mean <= four.var && four.var <= four.cvar
+          && four.cvar <= four.max, "mean <= VaR <= CVaR <= max");
+    // Price risk is symmetric, so the mean stays near the deterministic cost plus the convexity of thinner books
+    CHECK(four.mean > 0.9 * with_permanent && four.mean < 2.0 * with_permanent, "mean shortfall plausible");
+
+    plan.slice_notional = {1e6};
+    CHECK(engine.simulate(book, plan, params).incomplete_paths > 0, "paths beyond visible depth flagged");
+    BookSnapshot empty;
+    CHECK(engine.simulate(empty, plan, params).paths == 0, "empty book gives no distribution");
+}
+
+// Venue fee schedules: compile-time tables, symbol -> venue registry, overrides, batch gather
+void validate_fee_schedules() {
+    static_assert(VenueFeeModel<venues::Binance>::table.tiers == 10, "Binance VIP 0-9");
+    constexpr double okx_vip3 = VenueFeeModel<venues::Okx>::taker_fee(1000.0, 3);
+    CHECK(okx_vip3 == 1000.0 * 0.0002, "constexpr venue fee");
+    CHECK(VenueFeeModel<venues::Okx>::maker_fee(1000.0, 3) < 0.0, "maker rebate");
+
+    Models defaults;
+    CHECK(defaults.calculate_fees(1000.0, 1) == 1000.0 * 0.001 && defaults.calculate_fees(1000.0, 2) == 1000.0 * 0.0005
+          && defaults.calculate_fees(1000.0, 3) == 1000.0 * 0.0002, "default OKX tiers unchanged");
+    CHECK(defaults.calculate_fees(1000.0, 0) == defaults.calculate_fees(1000.0, 1)
+          && defaults.calculate_fees(1000.0, 4) == defaults.calculate_fees(1000.0, 1)
+          && defaults.calculate_fees(1000.0, -7) == defaults.calculate_fees(1000.0, 1)
+          && defaults.calculate_fees(1000.0, 1 << 30) == defaults.calculate_fees(1000.0, 1), "other tiers charged tier 1");
+
+    FeeScheduleRegistry schedules(3);
+    CHECK(schedules.venue(0) == "OKX" && schedules.venue(99) == "OKX", "default venue");
+    CHECK(schedules.assign(1, "Binance") && schedules.venue(1) == "Binance", "assign venue");
+    CHECK(!schedules.assign(1, "Nowhere") && !schedules.assign(5, "OKX"), "unknown venue or symbol rejected");
+    CHECK(schedules.table(1).taker_rate(4) == venues::Binance::schedule.taker[3], "VIP tier lookup");
+
+    // A venue registered at runtime needs no change to Models
+    VenueFeeSchedule custom = {"Custom", 2, {0.0001, 0.0}, {0.0003, 0.0002}};
+    schedules.add_venue(custom.name, make_fee_table(custom));
+    CHECK(schedules.has_venue("Custom") && schedules.assign(2, "Custom"), "runtime venue");
+
+    Models models;
+    models.set_fee_schedules(&schedules);
+    models.select_symbol(2);
+    CHECK(models.calculate_fees(1000.0, 2) == 1000.0 * 0.0002, "selected symbol's venue");
+    CHECK(std::abs(models.calculate_fees(1000.0, 1, 0.25) - 1000.0 * (0.25 * 0.0001 + 0.75 * 0.0003)) < 1e-15,
+          "maker/taker blend");
+
+    // Per-instrument override of one tier; tier 1 also moves the fallback slots
+    CHECK(schedules.override_rates(2, 1, 0.0, 0.0) && models.calculate_fees(1000.0, 1) == 0.0
+          && models.calculate_fees(1000.0, 9) == 0.0, "zero-fee override");
+    CHECK(!schedules.override_rates(2, 3, 0.0, 0.0), "override outside the schedule rejected");
+    CHECK(schedules.assign(2, "Custom") && models.calculate_fees(1000.0, 1) == 1000.0 * 0.0003, "reassign drops overrides");
+
+    // The batch gather agrees with the scalar lookup on every tier, in range or not
+    models.select_symbol(1);
+    const int tiers[] = {-1, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 1 << 20, -(1 << 20)};
+    const size_t n = sizeof(tiers) / sizeof(tiers[0]);
+    std::vector<double> quantity(n, 12345.0), batch(n);
+    for (bool use_simd : {true, false}) {
+        Models::set_simd_enabled(use_simd);
+        models.calculate_fees_batch(quantity.data(), tiers, n, batch.data());
+        size_t mismatches = 0;
+        for (size_t i = 0; i < n; ++i) {
+            mismatches += batch[i] != models.calculate_fees(quantity[i], tiers[i]);
+        }
+        CHECK(mismatches == 0, (use_simd ? "simd" : "scalar") << " batch fees match per-order");
+    }
+    Models::set_simd_enabled(true);
+}
+
+// Memoized evaluation: same outputs as the models, recomputed only when a key input moves
+void validate_model_evaluator() {
+    CoefficientStore store(2);
+    Models models;
+    models.set_coefficient_store(&store);
+    ModelEvaluator evaluator(models);
+
+    const ModelResult& first = evaluator.evaluate(500.0, 0.05, 2, 7);
+    CHECK(evaluator.misses() == 1 && evaluator.hits() == 0, "first evaluation misses");
+    CHECK(first.slippage == models.calculate_slippage(500.0, 0.05) && first.fees == models.calculate_fees(500.0, 2)
+          && first.market_impact == models.calculate_market_impact(500.0, 0.05)
+          && first.net_cost == models.calculate_net_cost(500.0, 0.05, 2)
+          && first.maker_taker == models.predict_maker_taker_proportion(500.0, 0.05)
+          && first.schedule.expected_cost == models.optimal_schedule(500.0, 0.05).expected_cost, "results match the models");
+
+    for (int frame = 0; frame < 100; ++frame) {
+        evaluator.evaluate(500.0, 0.05, 2, 7);
+    }
+    CHECK(evaluator.hits() == 100 && evaluator.misses() == 1, "unchanged inputs hit");
+
+    evaluator.evaluate(501.0, 0.05, 2, 7);
+    evaluator.evaluate(501.0, 0.06, 2, 7);
+    evaluator.evaluate(501.0, 0.06, 3, 7);
+    evaluator.evaluate(501.0, 0.06, 3, 8);
+    CHECK(evaluator.misses() == 5, "each key input forces a recompute");
+
+    ModelCoefficients recalibrated = ModelCoefficients::defaults();
+    recalibrated.slippage_intercept = 0.02;
+    store.publish(0, recalibrated);
+    const ModelResult& after = evaluator.evaluate(501.0, 0.06, 3, 8);
+    CHECK(evaluator.misses() == 6 && after.slippage == models.calculate_slippage(501.0, 0.06), "new coefficients recompute");
+
+    models.select_symbol(1);
+    evaluator.evaluate(501.0, 0.06, 3, 8);
+    CHECK(evaluator.misses() == 7 && evaluator.result().inputs.symbol == 1, "symbol switch recomputes");
+    evaluator.invalidate();
+    evaluator.evaluate(501.0, 0.06, 3, 8);
+    CHECK(evaluator.misses() == 8, "invalidate forces a recompute");
+}
+
+// Scenario sweep: matches per-cell evaluation, reuses unchanged cells, same surface on any thread count
+void validate_scenario_sweep() {
+    CoefficientStore store(1);
+    Models models;
+    models.set_coefficient_store(&store);
+
+    ScenarioGrid grid;
+    grid.quantities = ScenarioGrid::linspace(10.0, 5000.0, 24);
+    grid.volatilities = ScenarioGrid::linspace(2.5e-5, 4e-4, 16);
+    grid.fee_tiers = {1, 2, 3};
+    CHECK(grid.quantities.front() == 10.0 && grid.quantities.back() == 5000.0, "linspace hits both ends");
+
+    WorkStealingPool pool(4);
+    ScenarioSweep sweep(pool, 37);
+    const ScenarioSurface& surface = sweep.run(models, grid);
+    CHECK(surface.cells_computed == grid.size() && surface.cells_reused == 0, "cold sweep computes every cell");
+    bool matches = surface.net_cost.size() == grid.size() && surface.maker_taker.size() == grid.size();
+    for (size_t t = 0; matches && t < grid.fee_tiers.size(); ++t) {
+        for (size_t v = 0; v < grid.volatilities.size(); ++v) {
+            for (size_t q = 0; q < grid.quantities.size(); ++q) {
+                const size_t cell = grid.index(q, v, t);
+                const double q_value = grid.quantities[q];
+                const double v_value = grid.volatilities[v];
+                const double cost = models.calculate_net_cost(q_value, v_value, grid.fee_tiers[t]);
+                const double proportion = models.predict_maker_taker_proportion(q_value, v_value);
+                matches = matches && std::abs(surface.net_cost[cell] - cost) <= 1e-12 * std::abs(cost)
+                          && std::abs(surface.maker_taker[cell] - proportion) <= Models::kBatchTolerance * proportion;
+            }
+        }
+    }
+    CHECK(matches, "sweep matches per-cell models");
+    CHECK(surface.min_net_cost <= surface.max_net_cost
+          && surface.min_net_cost == *std::min_element(surface.net_cost.begin(), surface.net_cost.end()), "cost range");
+
+    const std::vector<double> cold = surface.net_cost;
+    const double* storage = surface.net_cost.data();
+    sweep.run(models, grid);
+    CHECK(surface.cells_computed == 0 && surface.cells_reused == grid.size() && surface.net_cost == cold,
+          "warm sweep reuses every cell");
+    CHECK(surface.net_cost.data() == storage, "unchanged sweep leaves the surface in place");
+
+    // Editing one quantity recomputes that column in every volatility row and tier
+    grid.quantities[5] += 1.0;
+    sweep.run(models, grid);
+    CHECK(surface.cells_computed == grid.volatilities.size() * grid.fee_tiers.size(), "one quantity edit");
+    const size_t edited = grid.index(5, 3, 1);
+    const double edited_cost = models.calculate_net_cost(grid.quantities[5], grid.volatilities[3], 2);
+    CHECK(std::abs(surface.net_cost[edited] - edited_cost) <= 1e-12 * edited_cost, "edited column re-evaluated");
+
+    // A grown axis keeps the old cells; only the new tier is evaluated
+    grid.fee_tiers.push_back(4);
+    sweep.run(models, grid);
+    CHECK(surface.cells_computed == grid.quantities.size() * grid.volatilities.size(), "new tier only");
+
+    // A new model version invalidates everything
+    ModelCoefficients recalibrated = ModelCoefficients::defaults();
+    recalibrated.slippage_intercept = 0.01;
+    store.publish(0, recalibrated);
+    sweep.run(models, grid);
+    CHECK(surface.cells_computed == grid.size() && surface.coefficients_version == store.version(0),
+          "recalibration recomputes the surface");
+    CHECK(std::abs(surface.net_cost[0] - models.calculate_net_cost(grid.quantities[0], grid.volatilities[0], 1))
+          <= 1e-12 * surface.net_cost[0], "surface uses the new model");
+
+    WorkStealingPool single(1);
+    ScenarioSweep single_sweep(single, 37);
+    CHECK(single_sweep.run(models, grid).net_cost == surface.net_cost
+          && single_sweep.surface().maker_taker == surface.maker_taker, "same surface on 1 and 4 threads");
+
+    grid.volatilities.clear();
+    CHECK(sweep.run(models, grid).net_cost.empty() && surface.cells_computed == 0, "empty grid");
+}
+
+// End to end: live feed -> registry (book + volatility) -> depth-walk probes
+// -> RLS -> CoefficientStore -> Models
+void validate_slippage_calibrator() {
+    BookRegistry registry(1);
+    const SymbolId id = registry.add_symbol("TEST-USDT", 0.1);
+    const size_t producer = registry.register_producer();
+    registry.start();
+    CoefficientStore store(1);
+    CalibrationConfig config;
+    config.min_observations = 20;
+    SlippageCalibrator calibrator(registry, store, config);
+    SlippageQuantileModel quantiles(1);
+    calibrator.set_quantile_model(&quantiles);
+
+    // 200 levels of 10 units, 0.1 apart, around a drifting mid: ~200k notional per side
+    auto load_book = [&](double mid) {
+        nlohmann::json asks = nlohmann::json::array();
+        nlohmann::json bids = nlohmann::json::array();
+        for (int i = 0; i < 200; ++i) {
+            asks.push_back({std::to_string(mid + 0.05 + 0.1 * i), "10"});
+            bids.push_back({std::to_string(mid - 0.05 - 0.1 * i), "10"});
+        }
+        const std::string payload = nlohmann::json{{"asks", asks}, {"bids", bids}}.dump();
+        const uint64_t version = registry.book(id).version();
+        registry.submit(producer, id, payload.data(), payload.size(), LatencyMonitor::now_ns());
+        while (registry.book(id).version() == version) {
+            std::this_thread::yield();
+        }
+    };
+
+    CHECK(calibrator.poll() == 0, "empty book gives no observations");
+    CHECK(calibrator.publish() == 0 && store.version(id) == 1, "nothing published before enough observations");
+
+    size_t added = 0;
+    for (int i = 0; i < 10; ++i) {
+        load_book(100.0 + 0.1 * (i % 3));
+        added += calibrator.poll();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    CHECK(added == 100 && calibrator.observations(id) == 100, "both sides of every probe observed per book");
+    CHECK(calibrator.poll() == 0, "unchanged book is skipped");
+    const SlippageQuantiles probe = quantiles.quantiles(id, 50000.0, calibrator.volatility(id));
+    CHECK(probe.count > 0 && probe.p50 > 0.0, "depth-walk slippage feeds the quantile model");
+    CHECK(calibrator.volatility(id) > 0.0 && registry.volatility(id).samples() == 9,
+          "registry volatility fed from applied books");
+
+    CHECK(calibrator.publish() == 1 && store.version(id) == 2, "calibrated model published");
+    const ModelCoefficients fitted = store.read(id);
+    CHECK(fitted.slippage_quantity > 0.0, "slippage grows with order size");
+    CHECK(fitted.impact_gamma == ModelCoefficients::defaults().impact_gamma, "impact coefficients carried over");
+
+    // The published model reproduces the slippage the book actually shows,
+    // evaluated at the live volatility by default
+    ExecutionCostEngine engine;
+    BookSnapshot snapshot;
+    registry.book(id).read_snapshot(snapshot);
+    engine.update(snapshot);
+    Models models;
+    models.set_coefficient_store(&store);
+    models.set_volatility_source(&registry);
+    models.select_symbol(id);
+    CHECK(models.current_volatility() == registry.volatility(id).volatility(), "models default to the live volatility");
+    const double observed = engine.estimate(OrderSide::Buy, 50000.0).slippage;
+    const double predicted = models.calculate_slippage(50000.0);
+    CHECK(std::abs(predicted - observed) < 0.2 * observed, "calibrated slippage close to depth-walk slippage");
+
+    // Externally observed fills feed the same regression
+    calibrator.observe(id, 10000.0, 1e-3, 5e-4);
+    CHECK(calibrator.observations(id) == 101, "external observation added");
+    registry.stop();
+}
 
 // Simple model validation test with simulated data
 int main() {
@@ -46,6 +824,25 @@ int main() {
         }
     }
 
+    validate_execution_cost();
+    validate_batch_models(models);
+    validate_coefficient_store();
+    validate_almgren_chriss();
+    validate_recursive_least_squares();
+    validate_volatility_estimator();
+    validate_quantile_sketch();
+    validate_slippage_quantiles();
+    validate_monte_carlo();
+    validate_scenario_sweep();
+    validate_fee_schedules();
+    validate_model_evaluator();
+    validate_slippage_calibrator();
+
+    if (failures > 0) {
+        std::cerr << failures << " model validation check(s) failed." << std::endl;
+        return 1;
+    }
+
     std::cout << "Model validation tests completed." << std::endl;
     return 0;
 }
@@ -0,0 +1,303 @@
+#include <iostream>
+#include <string>
+#include <cmath>
+#include <thread>
+#include <atomic>
+#include "orderbook.h"
+#include "price_ladder.h"
+#include "l2_parser.h"
+#include "book_registry.h"
+#include "latency_histogram.h"
+#include "test_util.h"
+
+// Orderbook correctness tests: snapshot load, incremental inserts/modifies/deletes
+static bool approx(double a, double b) {
+    return std::abs(a - b) < 1e-9;
+}
+
+void test_flat_snapshot() {
+    OrderBook orderbook;
+    orderbook.update_from_json(nlohmann::json::parse(R"({
+        "exchange": "OKX", "symbol": "BTC-USDT-SWAP",
+        "asks": [["95446.0", "1.5"], ["95445.5", "9.06"]],
+        "bids": [["95445.4", "0.2"], ["95445.3", "3.0"]]
+    })"));
+
+    auto asks = orderbook.get_asks();
+    auto bids = orderbook.get_bids();
+    CHECK(asks.size() == 2 && bids.size() == 2, "flat snapshot level count");
+    CHECK(approx(asks[0].price, 95445.5), "asks sorted ascending");
+    CHECK(approx(bids[0].price, 95445.4), "bids sorted descending");
+}
+
+void test_incremental_update() {
+    OrderBook orderbook;
+    orderbook.update_from_json(nlohmann::json::parse(R"({
+        "action": "snapshot",
+        "data": [{
+            "asks": [["100.0", "1", "0", "1"], ["100.5", "2", "0", "1"], ["101.0", "3", "0", "1"]],
+            "bids": [["99.5", "1", "0", "1"], ["99.0", "2", "0", "1"]]
+        }]
+    })"));
+
+    orderbook.update_from_json(nlohmann::json::parse(R"({
+        "action": "update",
+        "data": [{
+            "asks": [["100.5", "0", "0", "0"], ["100.2", "4", "0", "1"], ["101.0", "7", "0", "2"]],
+            "bids": [["99.7", "5", "0", "1"], ["99.0", "0", "0", "0"], ["98.0", "0", "0", "0"]]
+        }]
+    })"));
+
+    auto asks = orderbook.get_asks();
+    auto bids = orderbook.get_bids();
+    CHECK(asks.size() == 3, "ask delete + insert keeps 3 levels");
+    CHECK(asks.size() == 3 && approx(asks[1].price, 100.2) && asks[1].quantity == 4.0, "ask inserted in order");
+    CHECK(asks.size() == 3 && asks[2].quantity == 7.0, "ask quantity modified");
+    CHECK(bids.size() == 2, "bid delete + insert keeps 2 levels (unknown delete ignored)");
+    CHECK(bids.size() == 2 && approx(bids[0].price, 99.7) && approx(bids[1].price, 99.5), "bid inserted at top");
+
+    // A new snapshot replaces the book entirely
+    orderbook.update_from_json(nlohmann::json::parse(R"({
+        "action": "snapshot",
+        "data": [{"asks": [["105.0", "1", "0", "1"]], "bids": []}]
+    })"));
+    CHECK(orderbook.get_asks().size() == 1 && orderbook.get_bids().empty(), "snapshot resets book");
+}
+
+void test_price_ladder() {
+    PriceLadder asks(PriceLadder::Side::Ask, 0.1, 256);
+    PriceLadder bids(PriceLadder::Side::Bid, 0.1, 256);
+
+    // 0.1 + 0.2 != 0.3 in binary floating point, but both map to the same tick
+    CHECK(asks.to_tick(0.1 + 0.2) == asks.to_tick(0.3), "tick conversion absorbs float error");
+
+    asks.set(1000, 1.0);
+    asks.set(1005, 2.0);
+    asks.set(1100, 3.0);
+    CHECK(asks.best_tick() == 1000, "ask best is lowest tick");
+    CHECK(asks.next_tick(1000) == 1005 && asks.next_tick(1005) == 1100, "ask next level walk");
+    CHECK(asks.next_tick(1100) == PriceLadder::kNoTick, "ask walk ends");
+    asks.set(1000, 0.0);
+    CHECK(asks.best_tick() == 1005 && asks.depth() == 2, "ask best after delete");
+
+    bids.set(990, 1.0);
+    bids.set(900, 2.0);
+    CHECK(bids.best_tick() == 990 && bids.next_tick(990) == 900, "bid best is highest tick");
+
+    // A new best far outside the window re-centres it and drops levels that no longer fit
+    asks.set(600, 4.0);
+    CHECK(asks.best_tick() == 600, "ask re-centred on new best");
+    CHECK(asks.quantity_at(1005) == 0.0 && asks.dropped_levels() == 2, "deep ask levels dropped");
+
+    // Levels deeper than the window are dropped rather than moving the touch away
+    bids.set(0, 5.0);
+    CHECK(bids.best_tick() == 990 && bids.quantity_at(0) == 0.0, "deep bid dropped");
+}
+
+void test_snapshot_consistency() {
+    OrderBook orderbook;
+    std::atomic<bool> done(false);
+    const int iterations = 2000;
+
+    // Writer publishes books whose every level carries the iteration number as quantity
+    std::thread writer([&]() {
+        for (int i = 1; i <= iterations; ++i) {
+            nlohmann::json asks = nlohmann::json::array();
+            nlohmann::json bids = nlohmann::json::array();
+            for (int k = 0; k < 50; ++k) {
+                asks.push_back({std::to_string(100.0 + k * 0.1), std::to_string(i)});
+                bids.push_back({std::to_string(99.9 - k * 0.1), std::to_string(i)});
+            }
+            orderbook.apply_snapshot(asks, bids);
+        }
+        // A stopping writer leaves the depth copy current for later readers
+        orderbook.flush_depth();
+        done = true;
+    });
+
+    BookSnapshot snapshot;
+    uint64_t last_version = 0;
+    bool torn = false, regressed = false;
+    while (!done) {
+        orderbook.read_snapshot(snapshot);
+        if (snapshot.version < last_version) regressed = true;
+        last_version = snapshot.version;
+        for (size_t k = 1; k < snapshot.ask_count; ++k) {
+            if (snapshot.asks[k].quantity != snapshot.asks[0].quantity) torn = true;
+        }
+        for (size_t k = 0; k < snapshot.bid_count; ++k) {
+            if (snapshot.ask_count > 0 && snapshot.bids[k].quantity != snapshot.asks[0].quantity) torn = true;
+        }
+    }
+    writer.join();
+
+    CHECK(!torn, "reader never observes a torn snapshot");
+    CHECK(!regressed, "snapshot versions are monotonic");
+    CHECK(orderbook.version() == static_cast<uint64_t>(iterations), "one version per applied message");
+
+    orderbook.read_snapshot(snapshot);
+    CHECK(snapshot.version == static_cast<uint64_t>(iterations) && snapshot.ask_count == 50
+          && snapshot.asks[0].quantity == iterations, "flushed book read after the writer stopped");
+    nlohmann::json one_ask = nlohmann::json::array();
+    one_ask.push_back({"100.0", "7"});
+    orderbook.apply_update(one_ask, nlohmann::json::array());
+    OrderLevel bid, ask;
+    CHECK(orderbook.read_top(bid, ask) && ask.price == 100.0 && ask.quantity == 7.0 && bid.price == 99.9,
+          "top of book published with every message");
+    orderbook.read_snapshot(snapshot);
+    CHECK(snapshot.version == orderbook.version() && snapshot.ask_count == 50 && snapshot.asks[0].quantity == 7.0,
+          "writer thread serves its own read");
+
+    // Another thread's read is served by the idle writer, never by the reader
+    std::atomic<bool> stop(false);
+    std::thread idle_writer([&]() {
+        nlohmann::json ask = nlohmann::json::array();
+        ask.push_back({"100.0", "9"});
+        orderbook.apply_update(ask, nlohmann::json::array());
+        while (!stop) {
+            orderbook.serve_depth();
+            std::this_thread::yield();
+        }
+    });
+    while (orderbook.version() != static_cast<uint64_t>(iterations) + 2) {
+        std::this_thread::yield();
+    }
+    orderbook.read_snapshot(snapshot);
+    stop = true;
+    idle_writer.join();
+    CHECK(snapshot.version == orderbook.version() && snapshot.asks[0].quantity == 9.0,
+          "idle writer serves a depth request");
+}
+
+void test_streaming_parser() {
+    double value = 0.0;
+    CHECK(parse_decimal("95445.5", "95445.5" + 7, value) && value == 95445.5, "decimal fast path");
+    CHECK(parse_decimal("0.00012", "0.00012" + 7, value) && value == 0.00012, "decimal leading zeros");
+    CHECK(parse_decimal("-1.5e3", "-1.5e3" + 6, value) && value == -1500.0, "decimal exponent");
+    CHECK(!parse_decimal("abc", "abc" + 3, value), "decimal rejects garbage");
+
+    // Both paths must build the same book from the same payloads
+    const std::string payloads[] = {
+        R"({"arg":{"channel":"books","instId":"BTC-USDT-SWAP"},"action":"snapshot","data":[{"asks":[["100.5","2","0","1"],["100.0","1","0","1"]],"bids":[["99.5","1","0","1"],["99.0","2","0","1"]],"ts":"1597026383085","checksum":-855196043}]})",
+        R"({"arg":{"channel":"books","instId":"BTC-USDT-SWAP"},"action":"update","data":[{"asks":[["100.5","0","0","0"],["100.2","4","0","1"]],"bids":[["99.7","5","0","1"]],"ts":"1597026383185","checksum":12}]})",
+        R"({"timestamp":"2025-05-04T10:39:13Z","exchange":"OKX","symbol":"BTC-USDT-SWAP","asks":[["95445.5","9.06"],["95446.0","1.5"]],"bids":[["95445.4","0.2"]]})"
+    };
+
+    OrderBook fast_book;
+    OrderBook dom_book;
+    L2Message message;
+    for (const auto& payload : payloads) {
+        CHECK(parse_l2_message(payload.data(), payload.size(), message) == L2ParseResult::Ok, "fast path accepts payload");
+        apply_l2_payload(fast_book, payload);
+        dom_book.update_from_json(nlohmann::json::parse(payload));
+
+        auto fa = fast_book.get_asks(), da = dom_book.get_asks();
+        auto fb = fast_book.get_bids(), db = dom_book.get_bids();
+        bool same = fa.size() == da.size() && fb.size() == db.size();
+        for (size_t i = 0; same && i < fa.size(); ++i) same = fa[i].price == da[i].price && fa[i].quantity == da[i].quantity;
+        for (size_t i = 0; same && i < fb.size(); ++i) same = fb[i].price == db[i].price && fb[i].quantity == db[i].quantity;
+        CHECK(same, "fast path and DOM path agree");
+    }
+
+    const std::string ack = R"({"event":"subscribe","arg":{"channel":"books","instId":"BTC-USDT-SWAP"}})";
+    CHECK(parse_l2_message(ack.data(), ack.size(), message) == L2ParseResult::NoBook, "subscription ack has no book");
+    apply_l2_payload(fast_book, ack);
+    CHECK(!fast_book.get_asks().empty(), "ack does not clear the book");
+
+    const std::string multi = R"({"action":"update","data":[{"asks":[]},{"asks":[]}]})";
+    CHECK(parse_l2_message(multi.data(), multi.size(), message) == L2ParseResult::Unsupported, "multi-book message falls back");
+
+    const std::string broken = R"({"asks":[["1.0","2.0"]],"bids":[)";
+    CHECK(parse_l2_message(broken.data(), broken.size(), message) == L2ParseResult::Malformed, "truncated payload rejected");
+}
+
+void test_exchange_timestamps() {
+    int64_t ts = 0;
+    const std::string ms = "1597026383085";
+    CHECK(parse_exchange_timestamp(ms.data(), ms.data() + ms.size(), ts) && ts == 1597026383085000000LL, "epoch ms");
+    const std::string us = "1597026383085123";
+    CHECK(parse_exchange_timestamp(us.data(), us.data() + us.size(), ts) && ts == 1597026383085123000LL, "epoch us");
+    const std::string iso = "2025-05-04T10:39:13Z";
+    CHECK(parse_exchange_timestamp(iso.data(), iso.data() + iso.size(), ts) && ts == 1746355153000000000LL, "ISO 8601 UTC");
+    const std::string fraction = "2025-05-04T10:39:13.250Z";
+    CHECK(parse_exchange_timestamp(fraction.data(), fraction.data() + fraction.size(), ts)
+          && ts == 1746355153250000000LL, "ISO 8601 fraction");
+    const std::string offset = "2025-05-04T10:39:13+01:00";
+    CHECK(parse_exchange_timestamp(offset.data(), offset.data() + offset.size(), ts) && ts == 1746351553000000000LL,
+          "ISO 8601 offset");
+    const std::string bad_month = "2025-13-04T10:39:13Z";
+    CHECK(!parse_exchange_timestamp(bad_month.data(), bad_month.data() + bad_month.size(), ts), "bad month rejected");
+    const std::string garbage = "yesterday";
+    CHECK(!parse_exchange_timestamp(garbage.data(), garbage.data() + garbage.size(), ts), "garbage rejected");
+
+    // The fast path picks the field up wherever the venue puts it
+    L2Message message;
+    const std::string okx = R"({"action":"update","data":[{"asks":[["100.2","4"]],"bids":[],"ts":"1597026383185"}]})";
+    CHECK(parse_l2_message(okx.data(), okx.size(), message) == L2ParseResult::Ok
+          && message.exchange_ts_ns == 1597026383185000000LL, "OKX data ts");
+    const std::string flat = R"({"timestamp":"2025-05-04T10:39:13Z","asks":[["95445.5","9.06"]],"bids":[]})";
+    CHECK(parse_l2_message(flat.data(), flat.size(), message) == L2ParseResult::Ok
+          && message.exchange_ts_ns == 1746355153000000000LL, "flat timestamp");
+    const std::string none = R"({"asks":[["95445.5","9.06"]],"bids":[]})";
+    CHECK(parse_l2_message(none.data(), none.size(), message) == L2ParseResult::Ok && message.exchange_ts_ns == 0,
+          "no timestamp");
+
+    OrderBook book;
+    CHECK(apply_l2_payload(book, okx) == 1597026383185000000LL, "apply returns the exchange time");
+    const std::string multi = R"({"action":"snapshot","ts":1597026383999,"data":[{"asks":[["1","1"]]},{"bids":[["0.5","1"]]}]})";
+    CHECK(apply_l2_payload(book, multi) == 1597026383999000000LL, "DOM fallback finds the exchange time");
+}
+
+void test_book_registry() {
+    BookRegistry registry(2);
+    const SymbolId btc = registry.add_symbol("BTC-USDT-SWAP", 0.1);
+    const SymbolId eth = registry.add_symbol("ETH-USDT-SWAP", 0.01);
+    CHECK(registry.add_symbol("BTC-USDT-SWAP", 0.1) == btc, "symbols are interned once");
+    CHECK(registry.find("ETH-USDT-SWAP") == eth, "lookup by name");
+    CHECK(registry.find("DOGE-USDT-SWAP") == BookRegistry::kInvalidSymbol, "unknown symbol");
+    CHECK(registry.shard_of(btc) < registry.shard_count(), "symbol mapped to a shard");
+
+    const size_t producer = registry.register_producer();
+    registry.start();
+    const std::string payloads[] = {
+        R"({"asks":[["95445.5","1.0"]],"bids":[["95445.4","2.0"]]})",
+        R"({"asks":[["1800.01","3.0"]],"bids":[["1799.99","4.0"]]})",
+        R"({"action":"update","data":[{"asks":[["1800.02","5.0"]]}]})"
+    };
+    const std::string stamped = R"({"ts":"1597026383085","asks":[["95445.6","1.0"]],"bids":[]})";
+    registry.submit(producer, btc, payloads[0].data(), payloads[0].size());
+    registry.submit(producer, eth, payloads[1].data(), payloads[1].size());
+    registry.submit(producer, eth, payloads[2].data(), payloads[2].size());
+    registry.submit(producer, btc, stamped.data(), stamped.size(), LatencyMonitor::now_ns(), 1597026383090000000LL);
+    registry.stop();   // drains queued payloads before joining
+
+    const FeedLatencySummary btc_latency = registry.feed_latency(btc).summary();
+    CHECK(btc_latency.receive_to_apply.count == 1 && btc_latency.exchange_to_receive.count == 1,
+          "stamped payload recorded for its symbol");
+    CHECK(btc_latency.offset_valid && btc_latency.clock_offset_ns == 5000000, "5 ms one-way sample");
+    CHECK(registry.feed_latency(eth).summary().exchange_to_receive.count == 0, "unstamped payloads skip exchange latency");
+
+    CHECK(registry.book(btc).version() == 2 && registry.book(eth).version() == 2, "each book applied its own payloads");
+    auto eth_asks = registry.book(eth).get_asks();
+    CHECK(eth_asks.size() == 2 && approx(eth_asks[0].price, 1800.01), "ETH book uses its own tick size");
+}
+
+int main() {
+    std::cout << "Starting orderbook tests..." << std::endl;
+
+    test_flat_snapshot();
+    test_incremental_update();
+    test_price_ladder();
+    test_snapshot_consistency();
+    test_streaming_parser();
+    test_exchange_timestamps();
+    test_book_registry();
+
+    if (failures > 0) {
+        std::cerr << failures << " orderbook test(s) failed." << std::endl;
+        return 1;
+    }
+
+    std::cout << "Orderbook tests completed." << std::endl;
+    return 0;
+}
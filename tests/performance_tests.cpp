@@ -2,18 +2,129 @@
 #include <chrono>
 #include <thread>
 #include <vector>
+#include <algorithm>
+#include <cmath>
+#include <random>
 #include "orderbook.h"
 #include "models.h"
+#include "latency_histogram.h"
+#include "work_stealing_pool.h"
+#include "test_util.h"
+#include <atomic>
+#include <stdexcept>
+
+static void print_summary(const char* label, const LatencySummary& s) {
+    std::cout << label << ": n=" << s.count << " p50=" << s.p50_ns << " ns p99=" << s.p99_ns
+              << " ns p99.9=" << s.p999_ns << " ns max=" << s.max_ns << " ns" << std::endl;
+}
+
+// Percentiles within the histogram's ~3% bucket precision, and lock-free merge across threads
+void test_latency_histogram() {
+    LatencyHistogram histogram;
+    std::vector<int64_t> samples;
+    std::mt19937_64 rng(7);
+    std::lognormal_distribution<double> latency(9.0, 1.0);   // ~8 us median, long right tail
+    for (int i = 0; i < 200000; ++i) {
+        const int64_t value = static_cast<int64_t>(latency(rng));
+        samples.push_back(value);
+        histogram.record(value);
+    }
+    std::sort(samples.begin(), samples.end());
+
+    for (double percentile : {50.0, 99.0, 99.9}) {
+        const size_t rank = static_cast<size_t>(std::ceil(percentile / 100.0 * samples.size())) - 1;
+        const double exact = static_cast<double>(samples[rank]);
+        const double reported = static_cast<double>(histogram.value_at_percentile(percentile));
+        CHECK(std::abs(reported - exact) <= exact * 0.035, "p" << percentile << " within bucket precision");
+    }
+    CHECK(histogram.max() == samples.back(), "max is exact");
+    CHECK(histogram.count() == samples.size(), "count");
+    for (int64_t value : {0LL, 1LL, 63LL, 64LL, 1000LL, 123456789LL, static_cast<long long>(INT64_MAX)}) {
+        const size_t index = LatencyHistogram::bucket_index(value);
+        CHECK(index < LatencyHistogram::kBucketCount && LatencyHistogram::bucket_upper_bound(index) >= value,
+              "bucket bounds for " << value);
+    }
+
+    // Each thread records into its own histograms; the monitor merges on read
+    LatencyMonitor& monitor = LatencyMonitor::instance();
+    monitor.reset();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&monitor, t]() {
+            for (int i = 0; i < 10000; ++i) {
+                monitor.record(LatencyStage::Apply, (t + 1) * 1000);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    const LatencySummary merged = monitor.summary(LatencyStage::Apply);
+    CHECK(merged.count == 40000, "merged count across threads");
+    CHECK(merged.max_ns == 4000, "merged max");
+    CHECK(merged.p50_ns >= 2000 && merged.p50_ns <= 2000 * 1.035, "merged median");
+    monitor.reset();
+}
 
 // Simulate realistic load by feeding synthetic orderbook updates and measuring performance and memory usage
+// Every index runs exactly once, nested loops and exceptions are handled
+void test_work_stealing_pool() {
+    WorkStealingPool pool(4);
+    CHECK(pool.size() == 4, "pool size");
+
+    std::vector<std::atomic<int>> visits(100000);
+    // Skewed chunk costs: the first chunks are slow, so idle workers have to steal
+    pool.parallel_for(0, visits.size(), 1000, [&visits](size_t lo, size_t hi) {
+        if (lo < 4000) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        for (size_t i = lo; i < hi; ++i) {
+            visits[i].fetch_add(1, std::memory_order_relaxed);
+        }
+    });
+    bool once = true;
+    for (const auto& v : visits) {
+        once = once && v.load() == 1;
+    }
+    CHECK(once, "parallel_for visits every index exactly once");
+    std::cout << "Work-stealing pool: " << pool.steals() << " steals" << std::endl;
+
+    std::atomic<size_t> inner{0};
+    pool.parallel_for(0, 8, 1, [&pool, &inner](size_t, size_t) {
+        pool.parallel_for(0, 100, 10, [&inner](size_t lo, size_t hi) { inner.fetch_add(hi - lo); });
+    });
+    CHECK(inner.load() == 800, "nested parallel_for completes");
+
+    bool threw = false;
+    try {
+        pool.parallel_for(0, 64, 1, [](size_t lo, size_t) {
+            if (lo == 17) {
+                throw std::runtime_error("chunk failed");
+            }
+        });
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    CHECK(threw, "chunk exception rethrown to the caller");
+
+    size_t calls = 0;
+    pool.parallel_for(5, 5, 1, [&calls](size_t, size_t) { ++calls; });
+    pool.parallel_for(0, 3, 10, [&calls](size_t lo, size_t hi) { calls += hi - lo; });
+    CHECK(calls == 3, "empty and single-chunk ranges");
+}
+
 int main() {
     std::cout << "Starting performance and memory usage test..." << std::endl;
 
+    test_latency_histogram();
+    test_work_stealing_pool();
+
     OrderBook orderbook;
     Models models;
 
     const int num_updates = 100000;
     const int batch_size = 1000;
+    LatencyHistogram update_latency;
 
     // Synthetic orderbook update simulation
     for (int batch = 0; batch < num_updates / batch_size; ++batch) {
@@ -23,7 +134,9 @@ int main() {
             // Simulate an orderbook update JSON string (simplified)
             // In real test, use realistic JSON or parsed data
             // Here we just simulate update calls
+            const int64_t update_start = LatencyMonitor::now_ns();
             orderbook.simulate_update();
+            update_latency.record(LatencyMonitor::now_ns() - update_start);
         }
 
         auto batch_end = std::chrono::high_resolution_clock::now();
@@ -36,10 +149,18 @@ int main() {
         std::this_thread::sleep_for(std::chrono::milliseconds(10));
     }
 
+    // Tail latency per update rather than a single batch figure
+    print_summary("Update latency", update_latency.summary());
+
     // Memory usage measurement would require platform-specific code or external tools
     // Here we just print a placeholder
     std::cout << "Memory usage measurement not implemented - please use external tools." << std::endl;
 
+    if (failures > 0) {
+        std::cerr << failures << " performance test check(s) failed." << std::endl;
+        return 1;
+    }
+
     std::cout << "Performance and memory usage test completed." << std::endl;
     return 0;
 }
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <iostream>
+
+// Shared check harness for the standalone test executables. A failed CHECK
+// prints its message and bumps `failures`; main() turns a non-zero count into
+// a failing exit code.
+inline int failures = 0;
+
+#define CHECK(cond, msg) \
+    do { \
+        if (!(cond)) { \
+            std::cerr << "FAILED: " << msg << std::endl; \
+            ++failures; \
+        } \
+    } while (0)
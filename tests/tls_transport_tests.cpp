@@ -0,0 +1,385 @@
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <future>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+#include "book_registry.h"
+#include "connection_manager.h"
+#include "latency_histogram.h"
+#include "logger.h"
+#include "tls_transport.h"
+#include "test_util.h"
+#include <websocketpp/config/asio.hpp>
+#include <websocketpp/server.hpp>
+#include <boost/asio/connect.hpp>
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/asio/ssl.hpp>
+#include <boost/asio/write.hpp>
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <openssl/x509v3.h>
+
+// TLS transport tests against local stand-in servers with self-signed
+// certificates: session resumption, host verification, socket options, and
+// the connection manager reconnecting over wss://
+namespace ssl = boost::asio::ssl;
+using boost::asio::ip::tcp;
+
+struct TestCertificate {
+    std::string cert_path;
+    std::string key_path;
+};
+
+// Self-signed P-256 certificate for localhost and 127.0.0.1, written as PEM
+bool make_self_signed(const std::string& prefix, TestCertificate& out) {
+    out.cert_path = prefix + "_cert.pem";
+    out.key_path = prefix + "_key.pem";
+
+    EVP_PKEY* key = nullptr;
+    EVP_PKEY_CTX* key_ctx = EVP_PKEY_CTX_new_id(EVP_PKEY_EC, nullptr);
+    bool ok = key_ctx != nullptr && EVP_PKEY_keygen_init(key_ctx) == 1
+              && EVP_PKEY_CTX_set_ec_paramgen_curve_nid(key_ctx, NID_X9_62_prime256v1) == 1
+              && EVP_PKEY_keygen(key_ctx, &key) == 1;
+    EVP_PKEY_CTX_free(key_ctx);
+
+    X509* cert = ok ? X509_new() : nullptr;
+    if (cert != nullptr) {
+        X509_set_version(cert, 2);
+        ASN1_INTEGER_set(X509_get_serialNumber(cert), 1);
+        X509_gmtime_adj(X509_getm_notBefore(cert), -60);
+        X509_gmtime_adj(X509_getm_notAfter(cert), 24 * 3600);
+        X509_set_pubkey(cert, key);
+        X509_NAME* name = X509_get_subject_name(cert);
+        X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, reinterpret_cast<const unsigned char*>("localhost"), -1, -1, 0);
+        X509_set_issuer_name(cert, name);
+        X509_EXTENSION* san = X509V3_EXT_conf_nid(nullptr, nullptr, NID_subject_alt_name,
+                                                  const_cast<char*>("DNS:localhost,IP:127.0.0.1"));
+        ok = san != nullptr && X509_add_ext(cert, san, -1) == 1 && X509_sign(cert, key, EVP_sha256()) > 0;
+        X509_EXTENSION_free(san);
+    }
+
+    if (ok) {
+        std::FILE* cert_file = std::fopen(out.cert_path.c_str(), "wb");
+        std::FILE* key_file = std::fopen(out.key_path.c_str(), "wb");
+        ok = cert_file != nullptr && key_file != nullptr && PEM_write_X509(cert_file, cert) == 1
+             && PEM_write_PrivateKey(key_file, key, nullptr, nullptr, 0, nullptr, nullptr) == 1;
+        if (cert_file) std::fclose(cert_file);
+        if (key_file) std::fclose(key_file);
+    }
+    X509_free(cert);
+    EVP_PKEY_free(key);
+    return ok;
+}
+
+void remove_certificate(const TestCertificate& cert) {
+    std::remove(cert.cert_path.c_str());
+    std::remove(cert.key_path.c_str());
+}
+
+std::shared_ptr<ssl::context> make_server_context(const TestCertificate& cert) {
+    auto context = std::make_shared<ssl::context>(ssl::context::tls_server);
+    context->use_certificate_chain_file(cert.cert_path);
+    context->use_private_key_file(cert.key_path, ssl::context::pem);
+    return context;   // OpenSSL issues session tickets by default
+}
+
+// Plain TLS server: handshake, send one line, close
+class RawTlsServer {
+public:
+    explicit RawTlsServer(const TestCertificate& cert)
+        : context_(make_server_context(cert)), acceptor_(io_, tcp::endpoint(boost::asio::ip::address_v4::loopback(), 0)) {
+        accept();
+        thread_ = std::thread([this]() { io_.run(); });
+    }
+
+    ~RawTlsServer() {
+        io_.stop();
+        thread_.join();
+    }
+
+    uint16_t port() const { return acceptor_.local_endpoint().port(); }
+
+private:
+    using Stream = ssl::stream<tcp::socket>;
+
+    boost::asio::io_context io_;
+    std::shared_ptr<ssl::context> context_;
+    tcp::acceptor acceptor_;
+    std::thread thread_;
+
+    void accept() {
+        auto stream = std::make_shared<Stream>(io_, *context_);
+        acceptor_.async_accept(stream->lowest_layer(), [this, stream](const boost::system::error_code& ec) {
+            if (ec) {
+                return;
+            }
+            accept();
+            stream->async_handshake(ssl::stream_base::server, [stream](const boost::system::error_code& handshake_ec) {
+                if (handshake_ec) {
+                    return;
+                }
+                static const std::string line = "hello\n";
+                boost::asio::async_write(*stream, boost::asio::buffer(line),
+                                         [stream](const boost::system::error_code&, size_t) {
+                    stream->async_shutdown([stream](const boost::system::error_code&) {});
+                });
+            });
+        });
+    }
+};
+
+struct ClientResult {
+    bool handshake = false;
+    bool resumed = false;
+    std::string line;
+    bool no_delay = false;      // socket options read back after tuning
+    int receive_buffer = 0;
+};
+
+// Blocking client: connect, tune, handshake and read until the server closes
+ClientResult connect_raw(uint16_t port, ssl::context& context, const std::string& host, TlsSessionSlot* slot,
+                         const TlsConfig& config, const SocketTuning* tuning = nullptr) {
+    ClientResult result;
+    boost::asio::io_context io;
+    ssl::stream<tcp::socket> stream(io, context);
+    boost::system::error_code ec;
+    stream.lowest_layer().connect(tcp::endpoint(boost::asio::ip::address_v4::loopback(), port), ec);
+    if (ec) {
+        return result;
+    }
+    if (tuning != nullptr) {
+        apply_socket_tuning(stream.lowest_layer(), *tuning);
+        boost::asio::ip::tcp::no_delay no_delay;
+        boost::asio::socket_base::receive_buffer_size receive_buffer;
+        stream.lowest_layer().get_option(no_delay, ec);
+        stream.lowest_layer().get_option(receive_buffer, ec);
+        result.no_delay = no_delay.value();
+        result.receive_buffer = receive_buffer.value();
+    }
+    if (!prepare_tls_session(stream.native_handle(), host, slot, config)) {
+        return result;
+    }
+    stream.handshake(ssl::stream_base::client, ec);
+    if (ec) {
+        return result;
+    }
+    result.handshake = true;
+    // Reading drives the post-handshake messages, TLS 1.3 session tickets included
+    std::string data;
+    boost::asio::read(stream, boost::asio::dynamic_buffer(data), ec);
+    result.resumed = tls_session_resumed(stream.native_handle());
+    result.line = data;
+    return result;
+}
+
+void test_session_resumption(const TestCertificate& cert) {
+    RawTlsServer server(cert);
+    TlsConfig config;
+    config.ca_file = cert.cert_path;
+    auto context = make_tls_client_context(config);
+
+    TlsSessionSlot slot;
+    const ClientResult first = connect_raw(server.port(), *context, "localhost", &slot, config);
+    CHECK(first.handshake && first.line == "hello\n", "verified handshake with the self-signed CA");
+    CHECK(!first.resumed && slot.has_session(), "full handshake, ticket stored in the slot");
+
+    const ClientResult second = connect_raw(server.port(), *context, "localhost", &slot, config);
+    CHECK(second.handshake && second.resumed, "reconnect resumes the session");
+
+    TlsSessionSlot fresh;
+    CHECK(!connect_raw(server.port(), *context, "localhost", &fresh, config).resumed, "other slots start cold");
+
+    TlsConfig no_resume = config;
+    no_resume.session_resumption = false;
+    auto cold_context = make_tls_client_context(no_resume);
+    TlsSessionSlot unused;
+    connect_raw(server.port(), *cold_context, "localhost", &unused, no_resume);
+    const ClientResult cold = connect_raw(server.port(), *cold_context, "localhost", &unused, no_resume);
+    CHECK(cold.handshake && !cold.resumed && !unused.has_session(), "resumption can be turned off");
+}
+
+void test_verification(const TestCertificate& cert, const TestCertificate& other) {
+    RawTlsServer server(cert);
+    TlsConfig config;
+    config.ca_file = cert.cert_path;
+    auto context = make_tls_client_context(config);
+    TlsSessionSlot slot;
+    CHECK(connect_raw(server.port(), *context, "127.0.0.1", &slot, config).handshake, "IP address matched against the SAN");
+    TlsSessionSlot wrong_host;
+    CHECK(!connect_raw(server.port(), *context, "example.com", &wrong_host, config).handshake, "wrong host name rejected");
+
+    TlsConfig untrusted = config;
+    untrusted.ca_file = other.cert_path;
+    auto untrusted_context = make_tls_client_context(untrusted);
+    TlsSessionSlot untrusted_slot;
+    CHECK(!connect_raw(server.port(), *untrusted_context, "localhost", &untrusted_slot, untrusted).handshake,
+          "certificate from an unknown CA rejected");
+
+    untrusted.verify_peer = false;
+    auto insecure_context = make_tls_client_context(untrusted);
+    TlsSessionSlot insecure_slot;
+    CHECK(connect_raw(server.port(), *insecure_context, "localhost", &insecure_slot, untrusted).handshake,
+          "verification can be turned off");
+}
+
+void test_socket_tuning(const TestCertificate& cert) {
+    RawTlsServer server(cert);
+    TlsConfig config;
+    config.ca_file = cert.cert_path;
+    auto context = make_tls_client_context(config);
+    SocketTuning tuning;
+    tuning.receive_buffer_bytes = 100000;
+    TlsSessionSlot slot;
+    const ClientResult result = connect_raw(server.port(), *context, "localhost", &slot, config, &tuning);
+    CHECK(result.handshake && result.line == "hello\n", "tuned socket still handshakes");
+    CHECK(result.no_delay, "TCP_NODELAY set");
+    CHECK(result.receive_buffer >= tuning.receive_buffer_bytes, "receive buffer enlarged");
+}
+
+using wss_server = websocketpp::server<websocketpp::config::asio_tls>;
+using websocketpp::connection_hdl;
+
+// WebSocket stand-in over TLS: a snapshot on every open, and drop_all() to
+// force reconnects
+class TlsStandInServer {
+public:
+    explicit TlsStandInServer(const TestCertificate& cert)
+        : context_(make_server_context(cert)), work_(boost::asio::make_work_guard(io_)) {
+        server_.clear_access_channels(websocketpp::log::alevel::all);
+        server_.clear_error_channels(websocketpp::log::elevel::all);
+        server_.init_asio(&io_);
+        server_.set_reuse_addr(true);
+        server_.set_tls_init_handler([this](connection_hdl) { return context_; });
+        server_.set_open_handler([this](connection_hdl hdl) {
+            open_.insert(hdl);
+            websocketpp::lib::error_code ec;
+            server_.send(hdl, R"({"asks":[["101.0","1.0"]],"bids":[["99.0","1.0"]]})", websocketpp::frame::opcode::text, ec);
+        });
+        server_.set_close_handler([this](connection_hdl hdl) { open_.erase(hdl); });
+        server_.listen(tcp::endpoint(boost::asio::ip::address_v4::loopback(), 0));
+        server_.start_accept();
+        thread_ = std::thread([this]() { io_.run(); });
+    }
+
+    ~TlsStandInServer() {
+        run_on_io([this]() {
+            websocketpp::lib::error_code ec;
+            server_.stop_listening(ec);
+        });
+        drop_all();
+        boost::asio::post(io_, [this]() { work_.reset(); });
+        thread_.join();
+    }
+
+    uint16_t port() {
+        websocketpp::lib::asio::error_code ec;
+        return server_.get_local_endpoint(ec).port();
+    }
+
+    void drop_all() {
+        run_on_io([this]() {
+            for (connection_hdl hdl : std::set<connection_hdl, std::owner_less<connection_hdl>>(open_)) {
+                websocketpp::lib::error_code ec;
+                server_.close(hdl, websocketpp::close::status::service_restart, "", ec);
+            }
+        });
+    }
+
+private:
+    boost::asio::io_context io_;
+    std::shared_ptr<ssl::context> context_;
+    boost::asio::executor_work_guard<boost::asio::io_context::executor_type> work_;
+    wss_server server_;
+    std::thread thread_;
+    std::set<connection_hdl, std::owner_less<connection_hdl>> open_;   // io thread only
+
+    void run_on_io(std::function<void()> task) {
+        std::promise<void> done;
+        boost::asio::post(io_, [&task, &done]() {
+            task();
+            done.set_value();
+        });
+        done.get_future().wait();
+    }
+};
+
+bool wait_for(const std::function<bool()>& condition, int timeout_ms = 5000) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    while (!condition()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    return true;
+}
+
+void test_connection_manager_over_tls(const TestCertificate& cert) {
+    TlsStandInServer server(cert);
+    BookRegistry registry(1);
+    const SymbolId a = registry.add_symbol("A", 0.1);
+
+    ConnectionManagerConfig config;
+    config.backoff.initial_ms = 10;
+    config.backoff.max_ms = 50;
+    config.tls.ca_file = cert.cert_path;
+    ConnectionManager manager(registry, config);
+    const size_t sub = manager.add_subscription({"wss://127.0.0.1:" + std::to_string(server.port()) + "/feed", a, ""});
+    LatencyMonitor::instance().reset();
+    registry.start();
+    manager.start();
+
+    OrderLevel bid, ask;
+    CHECK(wait_for([&]() { return registry.book(a).read_top(bid, ask) && ask.price == 101.0; }), "book built over wss://");
+    ConnectionStats stats = manager.stats(sub);
+    CHECK(stats.tls_handshakes == 1 && stats.tls_resumed == 0 && stats.last_handshake_ns > 0, "first handshake is a full one");
+
+    server.drop_all();
+    CHECK(wait_for([&]() { return manager.stats(sub).connects == 2; }), "reconnected after a drop");
+    stats = manager.stats(sub);
+    CHECK(stats.tls_handshakes == 2 && stats.tls_resumed == 1, "reconnect resumed the TLS session");
+    CHECK(stats.last_reconnect_ns > 0, "reconnect time measured");
+    CHECK(LatencyMonitor::instance().summary(LatencyStage::Handshake).count == 2
+          && LatencyMonitor::instance().summary(LatencyStage::Reconnect).count == 1,
+          "handshake and reconnect latency recorded");
+
+    manager.stop();
+    registry.stop();
+}
+
+int main() {
+    std::cout << "Starting TLS transport tests..." << std::endl;
+    Logger::instance().start();
+
+    TestCertificate cert, other;
+    if (!make_self_signed("tls_transport_tests", cert) || !make_self_signed("tls_transport_tests_other", other)) {
+        std::cerr << "Cannot create test certificates." << std::endl;
+        Logger::instance().stop();
+        return 1;
+    }
+
+    test_session_resumption(cert);
+    test_verification(cert, other);
+    test_socket_tuning(cert);
+    test_connection_manager_over_tls(cert);
+
+    remove_certificate(cert);
+    remove_certificate(other);
+    Logger::instance().stop();
+    if (failures > 0) {
+        std::cerr << failures << " TLS transport test(s) failed." << std::endl;
+        return 1;
+    }
+
+    std::cout << "TLS transport tests completed." << std::endl;
+    return 0;
+}